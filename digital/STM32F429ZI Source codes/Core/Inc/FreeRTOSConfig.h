@@ -0,0 +1,94 @@
+/**
+  ******************************************************************************
+  * @file           : FreeRTOSConfig.h
+  * @brief          : FreeRTOS configuration, only used when RTOS_SUPPORT is 1
+  *                   (see rtos.c)
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* Includes ------------------------------------------------------------------*/
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+#include <stdint.h>
+extern uint32_t SystemCoreClock;
+#endif
+
+/* Kernel --------------------------------------------------------------------*/
+
+#define configUSE_PREEMPTION                     1
+#define configCPU_CLOCK_HZ                       (SystemCoreClock)
+#define configTICK_RATE_HZ                       ((TickType_t)1000)   // Same tick as HAL
+#define configMAX_PRIORITIES                     (7)
+#define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
+#define configMAX_TASK_NAME_LEN                  (16)
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_TASK_NOTIFICATIONS             1
+#define configUSE_MUTEXES                        0
+#define configUSE_TIMERS                         0
+#define configUSE_CO_ROUTINES                    0
+#define configQUEUE_REGISTRY_SIZE                0
+
+// Every object is static (see rtos.c): no heap
+#define configSUPPORT_STATIC_ALLOCATION          1
+#define configSUPPORT_DYNAMIC_ALLOCATION         0
+
+// The idle task sleeps (WFI) until the next interrupt or task wake-up
+#define configUSE_IDLE_HOOK                      0
+#define configUSE_TICK_HOOK                      0
+#define configUSE_TICKLESS_IDLE                  1
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP    2
+
+#define configCHECK_FOR_STACK_OVERFLOW           0
+#define configUSE_TRACE_FACILITY                 0
+
+/* API functions included ----------------------------------------------------*/
+
+#define INCLUDE_vTaskDelayUntil                  1
+#define INCLUDE_xTaskGetSchedulerState           1
+#define INCLUDE_uxTaskGetStackHighWaterMark      1
+#define INCLUDE_vTaskDelay                       1
+#define INCLUDE_vTaskSuspend                     1
+
+/* Interrupt priorities ------------------------------------------------------*/
+
+#define configPRIO_BITS                          4   // __NVIC_PRIO_BITS
+
+// PendSV and SysTick: the lowest priority
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY  15
+
+/*
+ * Interrupts calling FreeRTOS functions should have this priority or a lower
+ * one. MicroW interrupts (see config.h) are above it: kernel critical sections
+ * never mask them, and they never call FreeRTOS functions.
+ */
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY 5
+
+#define configKERNEL_INTERRUPT_PRIORITY          (configLIBRARY_LOWEST_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY     (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+
+#define configASSERT(x) if ((x) == 0) { taskDISABLE_INTERRUPTS(); while (1); }
+
+/* Handlers ------------------------------------------------------------------*/
+
+/*
+ * SVC and PendSV are FreeRTOS handlers (stm32f4xx_it.c doesn't define them when
+ * RTOS_SUPPORT is 1). SysTick_Handler keeps incrementing the HAL tick and
+ * calls xPortSysTickHandler.
+ */
+#define vPortSVCHandler    SVC_Handler
+#define xPortPendSVHandler PendSV_Handler
+
+#endif /* FREERTOS_CONFIG_H */
@@ -29,15 +29,10 @@ extern "C" {
 
 /* Exported functions prototypes ---------------------------------------------*/
 
-/*
- * Known issue: functions in this file only handle one ADC.
- * This is not a real issue since MicroW doesn't need to record stereo sound.
- */
-
-HAL_StatusTypeDef ADC_streamStart(struct sampleStream_Info * sampleStream);
-HAL_StatusTypeDef ADC_streamRestart();
-HAL_StatusTypeDef ADC_streamUpdate();
-HAL_StatusTypeDef ADC_streamStop();
+HAL_StatusTypeDef ADC_streamStart(struct sampleStream_Info * ADC_stream);
+HAL_StatusTypeDef ADC_streamRestart(struct sampleStream_Info * ADC_stream);
+HAL_StatusTypeDef ADC_streamUpdate(struct sampleStream_Info * ADC_stream);
+HAL_StatusTypeDef ADC_streamStop(struct sampleStream_Info * ADC_stream);
 
 #ifdef __cplusplus
 }
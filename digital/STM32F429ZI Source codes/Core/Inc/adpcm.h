@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file           : adpcm.h
+  * @brief          : Header for adpcm.c file.
+  *                   IMA-ADPCM codec, 4 bits per sample
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_ADPCM_H_
+#define INC_ADPCM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define ADPCM_CODE_BITS 4
+#define ADPCM_HEADER_SIZE 4   // Predictor (3 bytes of 7 bits at most) and step index
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief state of an IMA-ADPCM encoder or decoder
+ */
+struct adpcm_State
+{
+	int16_t predictor;   /** Last reconstructed sample, scaled to 16 bits */
+	uint8_t index;       /** Position in the step table (0 to 88) */
+	uint8_t previous;    /** Last code, if it is the high nibble of the byte being formed (encoder only) */
+	uint8_t low;         /** 1 if the next code is the low nibble of a byte (encoder only) */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void adpcm_reset(void * state);
+uint32_t adpcm_encode(void * state, const uint16_t * samples);
+void adpcm_decode(void * state, uint32_t code, uint16_t * samples);
+void adpcm_getHeader(void * state, uint8_t * header);
+void adpcm_setHeader(void * state, const uint8_t * header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_ADPCM_H_ */
@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @file           : agc.h
+  * @brief          : Header for agc.c file.
+  *                   Automatic gain control and look-ahead limiter, emitter pipeline stage
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_AGC_H_
+#define INC_AGC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define AGC_GAIN_ONE 4096         // AGC gain of 1 (Q12)
+#define AGC_LIMIT_ONE 32768       // Limiter gain of 1 (Q15)
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief state of an automatic gain control (pipeline stage)
+ */
+struct agc_State
+{
+	int32_t pending[AGC_LOOKAHEAD];   /** Last block, AGC gain applied (scaled to 16 bits), waiting for the limiter */
+	uint32_t noise;                   /** Noise floor (mean square, scaled to 16 bits): quieter frames don't move the gain */
+	uint32_t level;                   /** Speech level (mean square of speech frames, scaled to 16 bits) */
+	uint32_t gain;                    /** AGC gain at the end of the last frame (Q12) */
+	uint32_t limitedBlocks;           /** Blocks attenuated by the limiter since the stage started */
+	uint16_t limit;                   /** Limiter gain at the beginning of the pending block (Q15) */
+	uint16_t pendingLimit;            /** Largest limiter gain keeping the pending block under AGC_LIMIT (Q15) */
+	uint8_t started;                  /** 0 until the first frame gave the initial noise floor */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+HAL_StatusTypeDef agc_Start(void * state);
+HAL_StatusTypeDef agc_Process(void * state, int16_t * frame, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_AGC_H_ */
@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file           : biquad.h
+  * @brief          : Header for biquad.c file.
+  *                   Cascades of second-order IIR filters (direct form I)
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_BIQUAD_H_
+#define INC_BIQUAD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define BIQUAD_MAX_SECTIONS 4        // Largest cascade
+#define BIQUAD_COEFFICIENTS 5        // Coefficients of a section: b0, b1, b2, -a1, -a2
+#define BIQUAD_ONE (1 << 30)         // Coefficient of 1 (Q30: coefficients range from -2 to 2)
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief state of a cascade of biquads. Coefficients aren't copied: they can
+ * be constant (in FLASH) or changed between two calls of biquad_Process
+ */
+struct biquad_Info
+{
+	const int32_t * coefficients;              /** BIQUAD_COEFFICIENTS per section (Q30), same layout as CMSIS-DSP biquad cascades */
+	int32_t state[4 * BIQUAD_MAX_SECTIONS];    /** x[n-1], x[n-2], y[n-1], y[n-2] of each section (samples scaled to 24 bits) */
+	uint8_t sections;                          /** Number of sections */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+HAL_StatusTypeDef biquad_Init(struct biquad_Info * biquad, const int32_t * coefficients, uint8_t sections);
+void biquad_Process(struct biquad_Info * biquad, int16_t * samples, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BIQUAD_H_ */
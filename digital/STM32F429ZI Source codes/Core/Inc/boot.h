@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : boot.h
+  * @brief          : Header for boot.c file.
+  *                   Boot steps timing, from main() to the first sample
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_BOOT_H_
+#define INC_BOOT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief steps of the boot, in the order they are reached
+ */
+enum bootStep
+{
+	BOOT_MAIN,           /** (0) Beginning of main() */
+	BOOT_CLOCK,          /** (1) System clock configured for the role */
+	BOOT_PERIPHERALS,    /** (2) Peripherals of the role initialized */
+	BOOT_STARTED,        /** (3) emitter_start or receiver_start returned */
+	BOOT_FIRST_SAMPLE,   /** (4) First sample captured (emitter) or output (receiver) */
+	BOOT_READY,          /** (5) Deferred setup done, main loop reached (never reached if RTOS_SUPPORT is 1) */
+	BOOT_STEPS
+};
+
+/**
+ * @brief time at which each step was reached
+ */
+struct boot_Info
+{
+	uint32_t time[BOOT_STEPS];   /** Microseconds since the beginning of main() */
+	uint8_t reached;             /** Bit n is set once step n was reached */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void Boot_Init();
+void Boot_Mark(enum bootStep step);
+const struct boot_Info * Boot_GetTimes();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BOOT_H_ */
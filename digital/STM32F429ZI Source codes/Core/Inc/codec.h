@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file           : codec.h
+  * @brief          : Header for codec.c file.
+  *                   Sample codecs, selected in-band after every synchronization signal
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_CODEC_H_
+#define INC_CODEC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define CODEC_STATE_SIZE 164     // Largest state of a codec (bytes)
+#define CODEC_STATE_WORDS ((CODEC_STATE_SIZE + 3) / 4)
+#define CODEC_HEADER_SIZE 6      // Largest header sent after the codec id (bytes)
+#define CODEC_MAX_SAMPLES 2      // Largest number of samples encoded by a code
+#define CODEC_MAX_CODE_BITS 24   // Largest code of a variable-length codec (bits)
+#define CODEC_SILENCE 0x7F       // Id of silence descriptors (see vad.c), not a codec
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief describes a codec. Codecs are constant (in FLASH), their state is
+ * stored in the encoder_Info or decoder_Info structure running them.
+ * Samples are unsigned (SAMPLE_SIZE LSBs), like in sample rings.
+ */
+struct codec_Info
+{
+	const char * name;        /** Name of the codec, for debuggers */
+	uint8_t id;               /** Sent after every synchronization signal (CODEC_PCM, CODEC_ADPCM...) */
+	uint8_t codeBits;         /** Width of a code (bits), 0 for variable-length codes (up to CODEC_MAX_CODE_BITS) */
+	uint8_t samplesPerCode;   /** Samples encoded by a code */
+	uint8_t headerSize;       /** State bytes sent after the id (0 if none), each one below 0x80 */
+	uint16_t stateSize;       /** Size of the state (bytes, 0 if none) */
+
+	void (* reset)(void * state);
+	/** Resets the state before the first code (NULL if nothing to do) */
+
+	uint32_t (* encode)(void * state, const uint16_t * samples);
+	/** Gives the code (codeBits LSBs) of samplesPerCode samples. A byte made of
+	codes only is never SYNC_SIGNAL if the codec has a state. Variable-length
+	codes have a marker bit above their MSB */
+
+	void (* decode)(void * state, uint32_t code, uint16_t * samples);
+	/** Gives the samplesPerCode samples of a code (with its marker bit if it has a variable length) */
+
+	void (* getHeader)(void * state, uint8_t * header);
+	/** Gives the state of the encoder, sent after the id (NULL if headerSize is 0) */
+
+	void (* setHeader)(void * state, const uint8_t * header);
+	/** Sets the state of the decoder from a received header (NULL if headerSize is 0) */
+
+	uint8_t (* measure)(void * state, uint32_t bits, uint8_t count);
+	/** Gives the width of the next code, starting at the MSB of the count LSBs
+	of bits, 0 if it isn't complete (NULL if codeBits isn't 0) */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+const struct codec_Info * codec_Find(uint8_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_CODEC_H_ */
@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file           : comfort.h
+  * @brief          : Header for comfort.c file.
+  *                   Silence descriptors and comfort noise
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_COMFORT_H_
+#define INC_COMFORT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define COMFORT_DESCRIPTOR_SIZE 2   // Level and spectral tilt of the background noise, each one below 0x80
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief state of a comfort noise generator
+ */
+struct comfort_Info
+{
+	int32_t gain;         /** Gain of the white noise */
+	int16_t pole;         /** Pole of the shaping filter (Q15, positive for a low-pass tilt) */
+	int32_t last;         /** Last generated sample (centered on 0) */
+	uint32_t seed;        /** State of the random generator */
+	uint32_t remaining;   /** Samples that can still be generated (0 if stopped) */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void comfort_Describe(uint32_t energy, int32_t correlation, uint8_t * descriptor);
+void comfort_Start(struct comfort_Info * comfort);
+void comfort_Set(struct comfort_Info * comfort, const uint8_t * descriptor);
+void comfort_Stop(struct comfort_Info * comfort);
+uint16_t comfort_Generate(struct comfort_Info * comfort, uint16_t * samples, uint16_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_COMFORT_H_ */
@@ -21,23 +21,156 @@
 
 #define MICROW_EMITTER 0
 #define MICROW_RECEIVER 1
+#define MICROW_RUNTIME 2
 
 // Emitter / Receiver config
-#define MODULE_TYPE MICROW_EMITTER
+// MICROW_RUNTIME builds a single image reading its role at boot on the strap pin (see role.c)
+#define MODULE_TYPE MICROW_RUNTIME
+// Strap pin (MICROW_RUNTIME only): left open on emitters, tied to ground on receivers
+#define ROLE_STRAP_PORT GPIOE
+#define ROLE_STRAP_PIN GPIO_PIN_2
+#define ROLE_STRAP_CLK_ENABLE() __HAL_RCC_GPIOE_CLK_ENABLE()
+// Maximum number of emitters (or receivers) running at the same time, each one with its own peripherals
+#define MAX_LINKS 1
 
 // UART config
 #define RX_BUFFER_SIZE 32
-#define TX_BUFFER_SIZE 32
+// The emitter writes a whole encoded frame at once: room for two of them
+#define TX_BUFFER_SIZE 512
 
 // ADC/DAC config
-#define SAMPLE_BUFFER_SIZE 32
 #define SAMPLE_SIZE 12
+// 12000 by default, 16000 for wideband audio with CODEC_SUBBAND (the stages follow, see README)
+#define SAMPLING_FREQUENCY 12000
+// The receiver writes a whole frame at once: room for two of them, in a power of two (256 at 12kHz, 512 at 16kHz)
+#define SAMPLE_BUFFER_SIZE ((2 * FRAME_SIZE <= 256) ? 256 : 512)
+
+// DAC interpolation config (receiver only)
+// Set DAC_INTERPOLATION to 1 to refresh the DAC once per sample, without filtering
+#define DAC_INTERPOLATION 4
+#define INTERPOLATION_TAPS_PER_PHASE 8
+#define DAC_DMA_BLOCK_SIZE 8
+
+// Frame pipeline config (see pipeline.c)
+// Samples processed at once by pipeline stages: SAMPLING_FREQUENCY / 100 gives 10ms frames
+#define FRAME_SIZE (SAMPLING_FREQUENCY / 100)
+// Maximum number of stages in a stage table, and memory shared by their states (bytes)
+#define PIPELINE_MAX_STAGES 8
+#define PIPELINE_STATE_SIZE 2560
+
+// Speech filter config (emitter and receiver stages, see filter.c)
+// Set SPEECH_FILTER to 1 to remove the DC offset of the analog front end on both ends (high-pass at 60Hz)
+// Its sections are designed for SAMPLING_FREQUENCY = 12000 and 16000: by default, it is only on at these frequencies
+#define SPEECH_FILTER ((SAMPLING_FREQUENCY == 12000) || (SAMPLING_FREQUENCY == 16000))
+// Set SPEECH_EMPHASIS to 1 to boost frequencies above 2kHz before encoding and cut them back, with codec noise, after decoding: both ends should use the same setting
+#define SPEECH_EMPHASIS 1
+
+// Howling suppression config (emitter stage, see howl.c)
+// Set HOWL_SUPPRESSION to 1 to detect acoustic feedback (a tone building up between a speaker and the microphone) and notch it out
+// Its cosine tables are designed for 120 and 160-sample frames: by default, it is only on at SAMPLING_FREQUENCY = 12000 and 16000
+#define HOWL_SUPPRESSION ((FRAME_SIZE == 120) || (FRAME_SIZE == 160))
+// Notches deployed at the same time (4 at most)
+#define HOWL_NOTCHES 4
+// A local peak of the spectrum is howling when its power is HOWL_PEAK_RATIO times the mean (20 is 13dB) for HOWL_PERSISTENCE checks in a row (40ms each)
+#define HOWL_PEAK_RATIO 20
+#define HOWL_PERSISTENCE 12
+// Checks (40ms each) without its peak before a notch is released (750 is 30s). When every notch is used, the one cleared for the longest is moved
+#define HOWL_RELEASE 750
+
+// Noise suppression config (emitter stage, see denoise.c)
+// Set NOISE_SUPPRESSION to 1 to attenuate stationary noise (wind, water) before encoding, at the cost of one frame of latency
+// Its window and FFT are designed for 120-sample frames: by default, it is only on at SAMPLING_FREQUENCY = 12000
+#define NOISE_SUPPRESSION (FRAME_SIZE == 120)
+// Smallest gain of a bin, Q15 (6554 is -14dB): lower values remove more noise, but make the rest sound more artificial
+#define DENOISE_GAIN_FLOOR 6554
+// Factor applied to the noise floor before it is subtracted: higher values remove more noise, and more of weak speech
+#define DENOISE_OVERSUBTRACTION 3
+
+// Automatic gain control config (emitter stage, see agc.c)
+// Set AGC to 1 to bring whispering and shouting speakers to the same level before encoding, at the cost of AGC_LOOKAHEAD samples of latency
+#define AGC 1
+// RMS level of speech once amplified, Q15 of full scale (4096 is -18dBFS)
+#define AGC_TARGET 4096
+// Largest gain, given to the quietest speakers (8 is +18dB, 15 at most): background noise is amplified as much
+#define AGC_MAX_GAIN 8
+// Peak level the limiter never lets through, Q15 of full scale (29491 is -0.9dBFS)
+#define AGC_LIMIT 29491
+// Samples the limiter looks ahead, dividing FRAME_SIZE (20 samples is 1.7ms)
+#define AGC_LOOKAHEAD 20
+
+// Memory placement
+// Set FAST_MEMORY to 0 to leave MicroW code in FLASH and buffers in SRAM (see sections.h)
+#define FAST_MEMORY 1
+
+// Interrupt config
+// Set DEFERRED_PROCESSING to 0 to encode, decode and interpolate inside the interrupts posting the data (see scheduler.c)
+#define DEFERRED_PROCESSING 1
+// Interrupt priorities, from 0 (highest) to 14: PendSV, running deferred work, is always the lowest (see priority.c)
+// The sample clock (TIM2) should preempt every other interrupt: its latency is the sampling jitter
+#define SAMPLE_CLOCK_PRIORITY 0
+// USART1, its DMA streams and SysTick (a byte lasts 43us at 230400 baud)
+#define SERIAL_PRIORITY 1
+// ADC, DAC DMA and DAC underrun (a sample lasts 83us at 12kHz)
+#define CONVERTER_PRIORITY 2
+
+// RTOS config
+// Set RTOS_SUPPORT to 1 to run deferred work in a FreeRTOS task instead of PendSV (FreeRTOS sources should be added to the build, see rtos.c)
+#define RTOS_SUPPORT 0
+// Period of the telemetry task (ms)
+#define TELEMETRY_PERIOD 1000
+
+// Power config
+enum powerModeEnum
+{
+	FULL_SPEED,
+	LOW_POWER
+};
+
+// LOW_POWER runs SYSCLK from the cycle budgets below: only select it once they are measured on your build
+#define POWER_MODE FULL_SPEED
+
+// Worst-case CPU cycles spent per sample, all interrupts included (LOW_POWER mode only)
+// Not measured: 3000 is an estimate. Measure with the *_getCycles() functions in FULL_SPEED mode, then set them with some margin
+#define EMITTER_CYCLES_PER_SAMPLE 3000
+#define RECEIVER_CYCLES_PER_SAMPLE 3000
+// Maximum CPU load in percent, the remaining time absorbs interrupt jitter (LOW_POWER mode only)
+#define CPU_LOAD_MAX 50
 
 // Encode/decode config
 #define WORD_LENGTH SAMPLE_SIZE
+// Codec of the emitter (see codec.c): the receiver decodes every codec, its id is sent after each synchronization signal
+#define CODEC_PCM 0     // WORD_LENGTH bits per sample
+#define CODEC_ADPCM 1   // IMA-ADPCM, 4 bits per sample
+#define CODEC_MULAW 2   // G.711 mu-law, 8 bits per sample
+#define CODEC_ALAW 3    // G.711 A-law, 8 bits per sample
+#define CODEC_SUBBAND 4 // Two-band ADPCM (G.722), 8 bits per two samples: meant for SAMPLING_FREQUENCY 16000
+#define CODEC_LOSSLESS 5 // Linear prediction and Rice codes, variable length: decoded samples are exactly the captured ones
+#define CODEC_PCM10 6   // 10 MSBs of each sample (congestion step of CODEC_PCM)
+#define CODEC_PCM8 7    // 8 MSBs of each sample (congestion step of CODEC_PCM)
+#define CODEC CODEC_PCM
 #define SYNC_SIGNAL 0xFF
 #define SYNC_PERIOD 64
 
+// Congestion config (emitter only, see encoder.c)
+// Set CONGESTION_ADAPTATION to 1 to send fewer bits per sample (CODEC_PCM only) while the UART buffer fills up, instead of dropping frames
+#define CONGESTION_ADAPTATION 1
+// Bytes waiting in the UART buffer from which a growing backlog removes 2 bits per sample, down to 8
+#define CONGESTION_HIGH (TX_BUFFER_SIZE / 2)
+// Bytes waiting in the UART buffer up to which the link is clear
+#define CONGESTION_LOW (TX_BUFFER_SIZE / 8)
+// Frames the link should stay clear before 2 bits per sample are given back
+#define CONGESTION_RECOVERY 50
+
+// Discontinuous transmission config (emitter only, see vad.c)
+// Set DTX to 0 to send every frame, silent ones included
+#define DTX 1
+// A frame is speech when its energy is VAD_THRESHOLD times the noise floor (4 is 6dB above it)
+#define VAD_THRESHOLD 4
+// Frames still sent after the last speech frame (30 frames of 10ms)
+#define VAD_HANGOVER 30
+// During silences, a silence descriptor is sent every DTX_KEEPALIVE_PERIOD frames
+#define DTX_KEEPALIVE_PERIOD 5
+
 // Error handling
 enum errorHandlingEnum
 {
@@ -55,4 +188,20 @@ enum errorHandlingEnum
 // ERROR_DELAY is the time to wait when an error occurs
 #define ERROR_DELAY 0
 
+// Boot config (see boot.c)
+// Set FAST_BOOT to 1 to start the link before the watchdog and clock gating, 0 to start it last
+#define FAST_BOOT 1
+// Set BOOT_PROBE to 1 to turn the LED at PG13 on at the first sample (reset-to-first-sample time on an oscilloscope)
+#define BOOT_PROBE 1
+
+// Health monitor config (see health.c)
+// Set HEALTH_MONITOR to 0 to disable stall detection and the independent watchdog
+#define HEALTH_MONITOR 1
+// Time between two progress checks (ms)
+#define HEALTH_PERIOD 100
+// Checks a stage may stay stalled, recovered after each one, before the watchdog resets the module
+#define HEALTH_ATTEMPTS 3
+// The watchdog resets the module if progress isn't checked for this long (ms, up to 8190)
+#define HEALTH_WATCHDOG_TIMEOUT 500
+
 #endif /* INC_CONFIG_H_ */
@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file           : cycles.h
+  * @brief          : Header for cycles.c file.
+  *                   CPU cycle counting, used to measure the cost of MicroW APIs
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_CYCLES_H_
+#define INC_CYCLES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief contains the result of successive measurements of a piece of code
+ */
+struct cycles_Info
+{
+	uint32_t start;   /** DWT cycle counter value when the measurement started */
+	uint32_t last;    /** Duration of the last measurement (CPU cycles) */
+	uint32_t max;     /** Longest measurement since the last reset (CPU cycles) */
+	uint32_t count;   /** Number of measurements since the last reset */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void Cycles_Init();
+void Cycles_Reset(struct cycles_Info * cycles);
+void Cycles_Start(struct cycles_Info * cycles);
+void Cycles_Stop(struct cycles_Info * cycles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_CYCLES_H_ */
@@ -26,13 +26,50 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_hal.h"
 #include "types.h"
+#include "cycles.h"
+#include "interpolator.h"
+#include "comfort.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#if (DAC_INTERPOLATION > 1)
+// Halves of the DMA buffer (see DAC_streamFill)
+#define DAC_FIRST_HALF 0x01
+#define DAC_SECOND_HALF 0x02
+#define DAC_HALVES (DAC_FIRST_HALF | DAC_SECOND_HALF)
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief contains the state of a DAC output, used as a handle by DAC functions
+ * Several outputs can run at the same time, each one with its own structure
+ * @warning DMA_buffer is read by DMA: this structure must not be placed in CCM RAM
+ */
+struct DAC_Info
+{
+	struct sampleStream_Info * DAC_stream;  /** Samples to convert */
+	struct comfort_Info comfort;            /** Noise played when no sample arrives during a silence (see decoder.c) */
+#if (DAC_INTERPOLATION > 1)
+	struct interpolator_Info interpolator;  /** State of the interpolation filter */
+	uint16_t DMA_buffer[2 * DAC_DMA_BLOCK_SIZE * DAC_INTERPOLATION];
+	/** Circular buffer read by DMA, one half is filled while the other is played */
+	uint16_t lastValue;                     /** Last sample given to the interpolator */
+	struct cycles_Info cycles;              /** Cost of each half of the DMA buffer filled */
+#endif
+};
 
 /* Exported functions prototypes ---------------------------------------------*/
 
-HAL_StatusTypeDef DAC_streamStart(struct sampleStream_Info * sampleStream);
-HAL_StatusTypeDef DAC_streamRestart();
-HAL_StatusTypeDef DAC_streamUpdate();
-HAL_StatusTypeDef DAC_streamStop();
+HAL_StatusTypeDef DAC_streamStart(struct DAC_Info * DAC_output, struct sampleStream_Info * sampleStream);
+HAL_StatusTypeDef DAC_streamRestart(struct DAC_Info * DAC_output);
+HAL_StatusTypeDef DAC_streamUpdate(struct DAC_Info * DAC_output);
+HAL_StatusTypeDef DAC_streamStop(struct DAC_Info * DAC_output);
+
+#if (DAC_INTERPOLATION > 1)
+HAL_StatusTypeDef DAC_streamFill(struct DAC_Info * DAC_output, uint8_t halves);
+const struct cycles_Info * DAC_getCycles(struct DAC_Info * DAC_output);
+#endif
 
 #ifdef __cplusplus
 }
@@ -26,13 +26,42 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_hal.h"
 #include "types.h"
+#include "cycles.h"
+#include "pipeline.h"
+#include "codec.h"
+#include "comfort.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief contains the state of a decoder, used as a handle by decoder functions
+ * Several decoders can run at the same time, each one with its own structure
+ */
+struct decoder_Info
+{
+	struct bitStream_Info * UART_stream;    /** Received bytes to decode */
+	struct sampleStream_Info * DAC_stream;  /** Buffer receiving the decoded samples */
+	const struct codec_Info * codec;        /** Codec selected by the last received id (NULL before the first one) */
+	uint32_t codecState[CODEC_STATE_WORDS]; /** State of the codec */
+	uint8_t header[CODEC_HEADER_SIZE];      /** Header being received */
+	uint8_t headerLength;                   /** Bytes received since the synchronization signal, id included, up to the end of the header */
+	uint32_t accumulator;                   /** Bits received but not decoded yet (LSBs) */
+	uint8_t bits;                           /** Number of bits in accumulator (below the code width between two calls) */
+	uint8_t synchronized;                   /** Tells if a synchronization signal was received */
+	uint8_t silence;                        /** 1 if a silence descriptor is being received instead of a header */
+	struct comfort_Info * comfort;          /** Comfort noise played during silences (NULL if none) */
+	struct cycles_Info cycles;              /** Cost of each decoder_streamUpdate call */
+	struct pipeline_Info pipeline;          /** Frame being gathered, receiver stages */
+};
 
 /* Exported functions prototypes ---------------------------------------------*/
 
-HAL_StatusTypeDef decoder_streamStart(struct bitStream_Info * bitStream, struct sampleStream_Info * sampleStream);
-HAL_StatusTypeDef decoder_streamRestart();
-HAL_StatusTypeDef decoder_streamUpdate();
-HAL_StatusTypeDef decoder_streamStop();
+HAL_StatusTypeDef decoder_streamStart(struct decoder_Info * decoder, struct bitStream_Info * bitStream, struct sampleStream_Info * sampleStream);
+HAL_StatusTypeDef decoder_streamRestart(struct decoder_Info * decoder);
+HAL_StatusTypeDef decoder_streamUpdate(struct decoder_Info * decoder);
+void decoder_streamResync(struct decoder_Info * decoder);
+HAL_StatusTypeDef decoder_streamStop(struct decoder_Info * decoder);
+const struct cycles_Info * decoder_getCycles(struct decoder_Info * decoder);
 
 #ifdef __cplusplus
 }
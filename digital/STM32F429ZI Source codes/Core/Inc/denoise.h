@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file           : denoise.h
+  * @brief          : Header for denoise.c file.
+  *                   Spectral noise suppression, emitter pipeline stage
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_DENOISE_H_
+#define INC_DENOISE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define DENOISE_FFT_SIZE 256                          // Real FFT: two frames of 120 samples, zero-padded
+#define DENOISE_BINS (DENOISE_FFT_SIZE / 2 + 1)       // From 0Hz to SAMPLING_FREQUENCY / 2
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief state of a noise suppressor (pipeline stage)
+ */
+struct denoise_State
+{
+	int16_t history[FRAME_SIZE];        /** Previous frame, scaled to 16 bits */
+	int16_t overlap[FRAME_SIZE];        /** Second half of the previous output, added to the next one */
+	uint32_t power[DENOISE_BINS];       /** Smoothed power of each bin */
+	uint32_t noise[DENOISE_BINS];       /** Noise floor of each bin */
+	uint16_t gain[DENOISE_BINS];        /** Smoothed gain of each bin (Q15) */
+	uint8_t started;                    /** 0 until the first frame gave the initial noise floor */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+HAL_StatusTypeDef denoise_Start(void * state);
+HAL_StatusTypeDef denoise_Process(void * state, int16_t * frame, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_DENOISE_H_ */
@@ -26,13 +26,43 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_hal.h"
 #include "types.h"
+#include "cycles.h"
+#include "pipeline.h"
+#include "codec.h"
+#include "vad.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief contains the state of an encoder, used as a handle by encoder functions
+ * Several encoders can run at the same time, each one with its own structure
+ */
+struct encoder_Info
+{
+	struct sampleStream_Info * ADC_stream;  /** Samples to encode */
+	struct bitStream_Info * UART_stream;    /** Buffer receiving the encoded bytes */
+	const struct codec_Info * codec;        /** Codec selected by CODEC */
+	uint32_t codecState[CODEC_STATE_WORDS]; /** State of the codec */
+	uint32_t accumulator;                   /** Codes not sent yet (LSBs) */
+	uint8_t bits;                           /** Number of bits in accumulator (below 8 between two calls) */
+	uint16_t bytesSinceLastSyncSignal;      /** Number of bytes sent since the last sync. signal */
+	uint8_t dropping;                       /** 1 if bytes are dropped until the next frame (UART buffer overrun) */
+	uint16_t silentFrames;                  /** Silent frames since the last silence descriptor (0 while speech is sent) */
+	uint8_t congestion;                     /** Congestion steps (2 bits per sample each) removed from CODEC_PCM, 0 if none */
+	uint16_t clearFrames;                   /** Frames since the UART buffer is clear (CONGESTION_LOW bytes at most) */
+	uint16_t lastWaiting;                   /** Bytes waiting in the UART buffer before the last frame */
+	struct vad_Info vad;                    /** Voice activity detector (DTX only) */
+	struct cycles_Info cycles;              /** Cost of each encoder_streamUpdate call */
+	struct pipeline_Info pipeline;          /** Frame being gathered, emitter stages */
+};
 
 /* Exported functions prototypes ---------------------------------------------*/
 
-HAL_StatusTypeDef encoder_streamStart(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream);
-HAL_StatusTypeDef encoder_streamRestart();
-HAL_StatusTypeDef encoder_streamUpdate();
-HAL_StatusTypeDef encoder_streamStop();
+HAL_StatusTypeDef encoder_streamStart(struct encoder_Info * encoder, struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream);
+HAL_StatusTypeDef encoder_streamRestart(struct encoder_Info * encoder);
+HAL_StatusTypeDef encoder_streamUpdate(struct encoder_Info * encoder);
+HAL_StatusTypeDef encoder_streamStop(struct encoder_Info * encoder);
+const struct cycles_Info * encoder_getCycles(struct encoder_Info * encoder);
 
 /* Private defines -----------------------------------------------------------*/
 
@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file           : filter.h
+  * @brief          : Header for filter.c file.
+  *                   DC blocking and speech emphasis, emitter and receiver pipeline stages
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_FILTER_H_
+#define INC_FILTER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "biquad.h"
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+HAL_StatusTypeDef filter_StartEmitter(void * state);
+HAL_StatusTypeDef filter_StartReceiver(void * state);
+HAL_StatusTypeDef filter_Process(void * state, int16_t * frame, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FILTER_H_ */
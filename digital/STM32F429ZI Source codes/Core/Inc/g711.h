@@ -0,0 +1,46 @@
+/**
+  ******************************************************************************
+  * @file           : g711.h
+  * @brief          : Header for g711.c file.
+  *                   G.711 mu-law and A-law codecs, one byte per sample
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_G711_H_
+#define INC_G711_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define G711_CODE_BITS 8
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+uint32_t g711_encodeMuLaw(void * state, const uint16_t * samples);
+void g711_decodeMuLaw(void * state, uint32_t code, uint16_t * samples);
+uint32_t g711_encodeALaw(void * state, const uint16_t * samples);
+void g711_decodeALaw(void * state, uint32_t code, uint16_t * samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_G711_H_ */
@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file           : health.h
+  * @brief          : Header for health.c file.
+  *                   Stall detection, recovery and independent watchdog
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_HEALTH_H_
+#define INC_HEALTH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief stages of the audio path whose progress is checked
+ */
+enum healthStage
+{
+	STAGE_CAPTURE,   /** (0) Samples captured by the ADC (emitter) */
+	STAGE_SEND,      /** (1) Bytes sent by the UART (emitter) */
+	STAGE_RECEIVE,   /** (2) Bytes received by the UART (receiver) */
+	STAGE_PLAY,      /** (3) Samples played by the DAC (receiver) */
+	HEALTH_STAGES    /** Number of stages */
+};
+
+/**
+ * @brief causes of the last reset, recorded across resets
+ */
+enum resetCause
+{
+	RESET_POWER,           /** (0) Power-on, brown-out, pin or software reset */
+	RESET_CAPTURE_STALL,   /** (1) Watchdog reset: STAGE_CAPTURE stayed stalled after recovery */
+	RESET_SEND_STALL,      /** (2) Watchdog reset: STAGE_SEND stayed stalled after recovery */
+	RESET_RECEIVE_STALL,   /** (3) Unused: reception may stop because the emitter is off */
+	RESET_PLAY_STALL,      /** (4) Watchdog reset: STAGE_PLAY stayed stalled after recovery */
+	RESET_STARVED          /** (5) Watchdog reset: progress wasn't checked (an interrupt or deferred work never ended) */
+};
+
+/**
+ * @brief contains the progress of every stage of a link at the last check
+ */
+struct health_Info
+{
+	uint32_t progress[HEALTH_STAGES];     /** Progress counter of each stage at the last check */
+	uint8_t stalls[HEALTH_STAGES];        /** Consecutive checks without progress */
+	uint32_t recoveries[HEALTH_STAGES];   /** Recoveries of each stage since the link started */
+	uint32_t lastCheck;                   /** HAL tick of the last check */
+	uint8_t enabled;                      /** 1 between Health_Start and Health_Stop */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+struct link_Info;
+
+#if (HEALTH_MONITOR == 1)
+void Health_Init();
+void Health_Start(struct link_Info * link);
+void Health_Stop(struct link_Info * link);
+void Health_Check(struct link_Info * link);
+enum resetCause Health_GetResetCause();
+uint32_t Health_GetWatchdogResets();
+#else
+/* No monitor: the watchdog isn't started */
+#define Health_Init()
+#define Health_Start(link)
+#define Health_Stop(link)
+#define Health_Check(link)
+#define Health_GetResetCause() (RESET_POWER)
+#define Health_GetWatchdogResets() (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_HEALTH_H_ */
@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : howl.h
+  * @brief          : Header for howl.c file.
+  *                   Acoustic feedback detection and notch suppression, emitter pipeline stage
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_HOWL_H_
+#define INC_HOWL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "biquad.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+// Bins of a frame (SAMPLING_FREQUENCY / FRAME_SIZE apart, 100Hz by default) watched for howling
+#define HOWL_FIRST_BIN 4                                    // 400Hz
+#define HOWL_LAST_BIN 55                                    // 5.5kHz
+#define HOWL_BINS (HOWL_LAST_BIN - HOWL_FIRST_BIN + 1)
+#define HOWL_GROUPS 4                                       // A quarter of the bins is checked on each frame
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief state of a howling suppressor (pipeline stage)
+ */
+struct howl_State
+{
+	struct biquad_Info notches;                                    /** Cascade of the deployed notches */
+	int32_t coefficients[BIQUAD_COEFFICIENTS * HOWL_NOTCHES];     /** Coefficients of each notch */
+	uint16_t position[HOWL_NOTCHES];                               /** Frequency of each notch (1/256 of a bin) */
+	uint16_t clear[HOWL_NOTCHES];                                  /** Checks since the peak of each notch was last seen */
+	uint32_t power[HOWL_BINS];                                     /** Last power of each bin */
+	uint8_t persistence[HOWL_BINS];                                /** Checks each bin has been a howling peak for */
+	uint8_t group;                                                 /** Group of bins checked on the next frame */
+	uint32_t deployed;                                             /** Notches deployed since the stage started */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+HAL_StatusTypeDef howl_Start(void * state);
+HAL_StatusTypeDef howl_Process(void * state, int16_t * frame, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_HOWL_H_ */
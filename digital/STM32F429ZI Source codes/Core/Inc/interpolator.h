@@ -0,0 +1,53 @@
+/**
+  ******************************************************************************
+  * @file           : interpolator.h
+  * @brief          : Header for interpolator.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_INTERPOLATOR_H_
+#define INC_INTERPOLATOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief contains the state of a polyphase interpolation filter
+ */
+struct interpolator_Info
+{
+	int16_t history[2 * INTERPOLATION_TAPS_PER_PHASE];
+	/** Last input samples (signed, most recent first). Every sample is
+	stored twice so that the filter always reads a contiguous window. */
+
+	uint8_t position;         /** Position of the most recent sample in history */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void interpolator_init(struct interpolator_Info * interpolator);
+void interpolator_process(struct interpolator_Info * interpolator, uint16_t sample, uint16_t * output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_INTERPOLATOR_H_ */
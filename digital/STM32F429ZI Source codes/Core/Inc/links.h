@@ -29,7 +29,53 @@ extern "C" {
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_hal.h"
+#include "config.h"
 #include "types.h"
+#include "role.h"
+#include "encoder.h"
+#include "decoder.h"
+#include "dac.h"
+#include "health.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief contains everything an emitter or a receiver needs: peripherals, streams
+ * and the state of lower level APIs. It is used as a handle by main API functions.
+ * Up to MAX_LINKS emitters or receivers can run at the same time, each one with
+ * its own structure and its own peripherals.
+ * In a MICROW_RUNTIME image, emitter and receiver states share the same memory:
+ * the structure is not larger than in a receiver image.
+ * @warning bitStream and DAC_output are accessed by DMA: this structure must not be placed in CCM RAM
+ */
+struct link_Info
+{
+	UART_HandleTypeDef * huart;   /** UART sending or receiving the bit stream */
+	ADC_HandleTypeDef * hadc;     /** ADC sampling the input (emitter only) */
+	DAC_HandleTypeDef * hdac;     /** DAC playing the output (receiver only) */
+	uint32_t DAC_Channel;         /** DAC_CHANNEL_1 or DAC_CHANNEL_2 (receiver only) */
+	TIM_HandleTypeDef * htim;     /** Timer setting the sampling frequency */
+	volatile uint32_t events;     /** Events posted by interrupts, processed in PendSV (see scheduler.h) */
+	uint32_t errors[ERROR_KINDS]; /** Number of errors of each kind since the link started (see errorKind) */
+	struct health_Info health;    /** Progress of each stage at the last check (see health.h) */
+
+	struct sampleStream_Info sampleStream;
+	struct bitStream_Info bitStream;
+#if (MODULE_TYPE == MICROW_EMITTER)
+	struct encoder_Info encoder;
+#elif (MODULE_TYPE == MICROW_RECEIVER)
+	struct decoder_Info decoder;
+	struct DAC_Info DAC_output;
+#else
+	union {
+		struct encoder_Info encoder;          /** Emitter state (hadc != NULL) */
+		struct {
+			struct decoder_Info decoder;      /** Receiver state (hdac != NULL) */
+			struct DAC_Info DAC_output;
+		};
+	};
+#endif
+};
 
 /* Exported functions prototypes ---------------------------------------------*/
 
@@ -44,24 +90,31 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef * huart);
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef * huart);
 void HAL_UART_ErrorCallback(UART_HandleTypeDef * huart);
 
+void HAL_DAC_ConvHalfCpltCallbackCh1(DAC_HandleTypeDef * hdac);
+void HAL_DAC_ConvCpltCallbackCh1(DAC_HandleTypeDef * hdac);
+void HAL_DAC_DMAUnderrunCallbackCh1(DAC_HandleTypeDef * hdac);
+
 /*=============================================================================
                       ##### Event functions #####
 =============================================================================*/
 
-void ADC_FinishedHandle();
-void Timer_RisingEdgeHandle();
-void encode_FinishedHandle();
-void UARTRx_FinishedHandle();
+void ADC_FinishedHandle(struct sampleStream_Info * sampleStream);
+void Timer_RisingEdgeHandle(TIM_HandleTypeDef * htim);
+void encode_FinishedHandle(struct bitStream_Info * bitStream);
+void UARTRx_FinishedHandle(struct bitStream_Info * bitStream);
+void Stream_ErrorHandle(const void * stream, enum errorKind kind);
+void Health_StallHandle(struct link_Info * link, enum healthStage stage);
+void Scheduler_PendingHandle();
 
 /*=============================================================================
                     ##### Main API functions #####
 =============================================================================*/
 
-HAL_StatusTypeDef emitter_start(UART_HandleTypeDef * huart, ADC_HandleTypeDef * hadc, TIM_HandleTypeDef * htim);
-HAL_StatusTypeDef emitter_stop();
+HAL_StatusTypeDef emitter_start(struct link_Info * link, UART_HandleTypeDef * huart, ADC_HandleTypeDef * hadc, TIM_HandleTypeDef * htim);
+HAL_StatusTypeDef emitter_stop(struct link_Info * link);
 
-HAL_StatusTypeDef receiver_start(UART_HandleTypeDef * huart, DAC_HandleTypeDef * hdac, uint32_t DAC_Channel, TIM_HandleTypeDef * htim);
-HAL_StatusTypeDef receiver_stop();
+HAL_StatusTypeDef receiver_start(struct link_Info * link, UART_HandleTypeDef * huart, DAC_HandleTypeDef * hdac, uint32_t DAC_Channel, TIM_HandleTypeDef * htim);
+HAL_StatusTypeDef receiver_stop(struct link_Info * link);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file           : lossless.h
+  * @brief          : Header for lossless.c file.
+  *                   Lossless codec: fixed linear prediction and Rice codes
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_LOSSLESS_H_
+#define INC_LOSSLESS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define LOSSLESS_CODE_BITS 0     // Variable-length codes
+#define LOSSLESS_HEADER_SIZE 6   // Last two samples, predictor order and Rice parameter (38 bits in 6 bytes of 7 bits)
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief state of a lossless encoder or decoder (both have the same one)
+ */
+struct lossless_State
+{
+	uint16_t history[2];   /** Last two samples, the last one first */
+	uint32_t sum;          /** Sum of the recent mapped residuals */
+	uint16_t count;        /** Number of residuals in sum */
+	uint8_t k;             /** Rice parameter of the next code */
+	uint8_t order;         /** Order of the predictor (1 or 2) up to the next header */
+	uint32_t cost[2];      /** Sum of the mapped residuals of each order since the last header (encoder only) */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void lossless_reset(void * state);
+uint32_t lossless_encode(void * state, const uint16_t * samples);
+uint8_t lossless_measure(void * state, uint32_t bits, uint8_t count);
+void lossless_decode(void * state, uint32_t code, uint16_t * samples);
+void lossless_getHeader(void * state, uint8_t * header);
+void lossless_setHeader(void * state, const uint8_t * header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_LOSSLESS_H_ */
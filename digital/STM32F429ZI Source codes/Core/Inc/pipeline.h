@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file           : pipeline.h
+  * @brief          : Header for pipeline.c file.
+  *                   Frame processing by a chain of stages fixed at compile time
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_PIPELINE_H_
+#define INC_PIPELINE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "cycles.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define PIPELINE_END { NULL, NULL, NULL, 0 }   // Last entry of every stage table
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief describes a processing stage. Stage tables are constant (in FLASH),
+ * the state of each stage is stored in the pipeline_Info structure running it.
+ */
+struct stage_Info
+{
+	const char * name;   /** Name of the stage, for debuggers */
+
+	HAL_StatusTypeDef (* start)(void * state);
+	/** Resets the state of the stage before the first frame (NULL if nothing to do) */
+
+	HAL_StatusTypeDef (* process)(void * state, int16_t * frame, uint16_t length);
+	/** Processes a frame in place. Samples are signed (SAMPLE_SIZE bits, centered on 0) */
+
+	uint16_t stateSize;  /** Size of the state of the stage (bytes, 0 if none) */
+};
+
+/**
+ * @brief contains a frame being gathered and the state of the stages processing it.
+ * Several pipelines can run at the same time, each one with its own structure
+ */
+struct pipeline_Info
+{
+	const struct stage_Info * stages;   /** Stage table, terminated by PIPELINE_END */
+	uint8_t stageCount;                 /** Number of stages in the table */
+	uint16_t length;                    /** Number of samples gathered in frame */
+	uint16_t frame[FRAME_SIZE];         /** Samples (SAMPLE_SIZE LSBs), processed in place */
+	void * states[PIPELINE_MAX_STAGES]; /** State of each stage, in stateMemory (NULL if none) */
+	struct cycles_Info cycles[PIPELINE_MAX_STAGES];   /** Cost of each stage, per frame */
+	uint32_t stateMemory[(PIPELINE_STATE_SIZE + 3) / 4];  /** Memory shared by the states of the stages */
+};
+
+/* Exported variables --------------------------------------------------------*/
+
+extern const struct stage_Info pipeline_emitterStages[];
+extern const struct stage_Info pipeline_receiverStages[];
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+HAL_StatusTypeDef pipeline_Start(struct pipeline_Info * pipeline, const struct stage_Info * stages);
+HAL_StatusTypeDef pipeline_Process(struct pipeline_Info * pipeline);
+const struct cycles_Info * pipeline_getCycles(struct pipeline_Info * pipeline, uint8_t stage);
+void * pipeline_findState(struct pipeline_Info * pipeline, HAL_StatusTypeDef (* process)(void * state, int16_t * frame, uint16_t length));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PIPELINE_H_ */
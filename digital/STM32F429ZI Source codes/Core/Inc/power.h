@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************
+  * @file           : power.h
+  * @brief          : Header for power.c file.
+  *                   Clock selection, peripheral gating and sleep
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_POWER_H_
+#define INC_POWER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+uint32_t Power_GetMinSysclk();
+HAL_StatusTypeDef Power_ClockConfig();
+HAL_StatusTypeDef Power_GateUnused();
+void Power_Sleep();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_POWER_H_ */
@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file           : priority.h
+  * @brief          : Header for priority.c file.
+  *                   Interrupt priority plan and critical sections
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_PRIORITY_H_
+#define INC_PRIORITY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define TICK_PRIORITY SERIAL_PRIORITY   // SysTick: below the sample clock, above the converters (HAL timeouts)
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+HAL_StatusTypeDef Priority_Init();
+uint32_t Priority_EnterCritical();
+void Priority_ExitCritical(uint32_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PRIORITY_H_ */
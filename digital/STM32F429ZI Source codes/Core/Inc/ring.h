@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : ring.h
+  * @brief          : Header for ring.c file.
+  *                   Lock-free single producer / single consumer ring buffer
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_RING_H_
+#define INC_RING_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define RING_SIZE_MAX 0x8000   // Counters are 16 bits wide: size can't exceed half their range
+
+/* Exported macros -----------------------------------------------------------*/
+
+/**
+ * @brief 1 if size is a valid ring size (a power of two between 1 and RING_SIZE_MAX), 0 else
+ * Usable in #if directives
+ */
+#define RING_VALID_SIZE(size) (((size) >= 1) && ((size) <= RING_SIZE_MAX) && (((size) & ((size) - 1)) == 0))
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief contains a ring buffer shared by one producer and one consumer
+ *
+ * head is only written by the producer, tail only by the consumer: they can
+ * run in different interrupts without disabling interrupts.
+ * Both are free-running counters, positions in the buffer are obtained by masking.
+ */
+struct ring_Info
+{
+	uint8_t * buffer;             /** Storage: size elements of elementSize bytes */
+	uint16_t mask;                /** size - 1 (size is a power of two) */
+	uint8_t elementSize;          /** Size of one element (bytes) */
+	volatile uint16_t head;       /** Number of elements written since ring_Init (modulo 2^16) */
+	volatile uint16_t tail;       /** Number of elements read since ring_Init (modulo 2^16) */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+HAL_StatusTypeDef ring_Init(struct ring_Info * ring, void * buffer, uint16_t size, uint8_t elementSize);
+void ring_Reset(struct ring_Info * ring);
+uint16_t ring_Count(const struct ring_Info * ring);
+uint16_t ring_Space(const struct ring_Info * ring);
+
+/* Producer side */
+uint16_t ring_Write(struct ring_Info * ring, const void * data, uint16_t count);
+void * ring_WriteSpan(struct ring_Info * ring, uint16_t * length);
+void ring_Commit(struct ring_Info * ring, uint16_t count);
+
+/* Consumer side */
+uint16_t ring_Read(struct ring_Info * ring, void * data, uint16_t count);
+void * ring_ReadSpan(struct ring_Info * ring, uint16_t * length);
+void ring_Release(struct ring_Info * ring, uint16_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_RING_H_ */
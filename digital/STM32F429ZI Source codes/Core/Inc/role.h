@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file           : role.h
+  * @brief          : Header for role.c file.
+  *                   Emitter or receiver role, fixed at build time or read at boot
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_ROLE_H_
+#define INC_ROLE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+// 1 if the image contains the emitter (or receiver) code paths, 0 else. Usable in #if directives
+#define EMITTER_SUPPORT ((MODULE_TYPE == MICROW_EMITTER) || (MODULE_TYPE == MICROW_RUNTIME))
+#define RECEIVER_SUPPORT ((MODULE_TYPE == MICROW_RECEIVER) || (MODULE_TYPE == MICROW_RUNTIME))
+
+#if !EMITTER_SUPPORT && !RECEIVER_SUPPORT
+#error "MODULE_TYPE should be MICROW_EMITTER, MICROW_RECEIVER or MICROW_RUNTIME"
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+#if (MODULE_TYPE == MICROW_RUNTIME)
+void Role_Init();
+uint8_t Role_Get();
+#else
+/* Role-specific image: the role is a constant, tests on it are removed by the compiler */
+#define Role_Init()
+#define Role_Get() (MODULE_TYPE)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_ROLE_H_ */
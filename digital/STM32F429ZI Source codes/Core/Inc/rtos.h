@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : rtos.h
+  * @brief          : Header for rtos.c file.
+  *                   Optional FreeRTOS tasks running deferred work, telemetry and control
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_RTOS_H_
+#define INC_RTOS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "links.h"
+
+#if (RTOS_SUPPORT == 1)
+
+/* Exported constants --------------------------------------------------------*/
+
+/*
+ * Interrupt of a peripheral MicroW doesn't use (SPI6), only triggered by software:
+ * MicroW interrupts can't call FreeRTOS functions, they pend this one which wakes the audio task.
+ */
+#define RTOS_WAKE_IRQn SPI6_IRQn
+#define RTOS_WAKE_IRQHandler SPI6_IRQHandler
+#define RTOS_WAKE_PRIORITY 14   // Under every MicroW interrupt, above the kernel (15)
+
+// Control task commands (bits, several commands can be pending)
+#define RTOS_START 0x01   // Start the link
+#define RTOS_STOP 0x02    // Stop the link
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief snapshot of the link health, updated by the telemetry task every TELEMETRY_PERIOD ms
+ */
+struct telemetry_Info
+{
+	uint32_t errors[ERROR_KINDS];   /** Errors of the link since it started (see link_Info) */
+	uint32_t sampleLatency;         /** Longest sampling interrupt latency (CPU cycles, see Timer_GetLatency) */
+	uint32_t audioLatency;          /** Longest time between an event and the audio task (CPU cycles, see Scheduler_GetLatency) */
+	uint32_t audioStackFree;        /** Lowest free stack of the audio task (words) */
+	uint32_t agcGain;               /** Gain of the automatic gain control (Q12, see agc.h), 0 if the link doesn't run it */
+	uint32_t limitedBlocks;         /** Blocks attenuated by the limiter since the link started (see agc.h) */
+	uint32_t howlNotches;           /** Notches of the howling suppressor in use (see howl.h) */
+	uint32_t howlDeployed;          /** Notches deployed by the howling suppressor since the link started */
+	uint32_t count;                 /** Number of snapshots */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void Rtos_Start(struct link_Info * link);
+void Rtos_Control(uint32_t command);
+const struct telemetry_Info * Rtos_GetTelemetry();
+
+/* Handle functions, implemented by the application */
+void Rtos_ControlHandle(uint32_t command);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_RTOS_H_ */
@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  * @file           : scheduler.h
+  * @brief          : Header for scheduler.c file.
+  *                   Deferred processing of events posted by interrupts
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_SCHEDULER_H_
+#define INC_SCHEDULER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "cycles.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define SCHEDULER_PRIORITY ((1 << __NVIC_PRIO_BITS) - 1)   // PendSV priority: the lowest one, every interrupt preempts deferred work
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void Scheduler_Init();
+void Scheduler_Post(volatile uint32_t * events, uint32_t event);
+uint32_t Scheduler_Take(volatile uint32_t * events);
+void Scheduler_MeasureLatency();
+const struct cycles_Info * Scheduler_GetLatency();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_SCHEDULER_H_ */
@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file           : sections.h
+  * @brief          : Memory placement of MicroW code and data
+  *
+  * Sections are defined in the linker script (STM32F429ZITX_FLASH.ld) and
+  * initialized by the startup code (startup_stm32f429zitx.s).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_SECTIONS_H_
+#define INC_SECTIONS_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported macros -----------------------------------------------------------*/
+
+#if (FAST_MEMORY == 1)
+
+/*
+ * RAMFUNC: code copied to SRAM by the startup, executed without flash wait states.
+ * CCMDATA: data in CCM RAM, initialized by the startup like .data.
+ * STREAM_ARENA: stream buffers in CCM RAM, not initialized by the startup.
+ *
+ * CCM RAM can't be reached by DMA: never place a DMA buffer in CCM RAM.
+ */
+#define RAMFUNC __RAM_FUNC
+#define CCMDATA __attribute__((section(".ccmram")))
+#define STREAM_ARENA __attribute__((section(".stream_arena")))
+
+#else
+
+#define RAMFUNC
+#define CCMDATA
+#define STREAM_ARENA
+
+#endif
+
+/*
+ * BIT_ARENA: bit stream buffers in SRAM (read and written by UART DMA), not
+ * initialized by the startup. The linker script checks that they fit in
+ * _Bit_Arena_Size bytes.
+ */
+#define BIT_ARENA __attribute__((section(".bit_arena")))
+
+/*
+ * NOINIT: data in CCM RAM, neither initialized nor cleared by the startup:
+ * it keeps its value across resets (not across power cycles).
+ */
+#define NOINIT __attribute__((section(".noinit")))
+
+#endif /* INC_SECTIONS_H_ */
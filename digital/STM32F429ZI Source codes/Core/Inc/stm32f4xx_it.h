@@ -63,7 +63,7 @@ void TIM6_DAC_IRQHandler(void);
 void DMA2_Stream2_IRQHandler(void);
 void DMA2_Stream7_IRQHandler(void);
 /* USER CODE BEGIN EFP */
-
+void DMA1_Stream5_IRQHandler(void);
 /* USER CODE END EFP */
 
 #ifdef __cplusplus
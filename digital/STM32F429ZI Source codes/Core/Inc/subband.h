@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file           : subband.h
+  * @brief          : Header for subband.c file.
+  *                   Two-band ADPCM codec (G.722 algorithm), one byte per two samples
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_SUBBAND_H_
+#define INC_SUBBAND_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#define SUBBAND_CODE_BITS 8      // 6 bits for the low band, 2 bits for the high band
+#define SUBBAND_SAMPLES 2        // Samples encoded by a code (one per band)
+#define SUBBAND_HEADER_SIZE 6    // Step scale factors of both bands (3 bytes of 7 bits each)
+#define SUBBAND_QMF_TAPS 24
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief ADPCM state of one band
+ */
+struct subband_Band
+{
+	int16_t s;        /** Prediction of the next band sample */
+	int16_t sp;       /** Contribution of the poles to the prediction */
+	int16_t sz;       /** Contribution of the zeros to the prediction */
+	int16_t r[3];     /** Last reconstructed band samples */
+	int16_t a[3];     /** Pole coefficients (a[1], a[2]) */
+	int16_t p[3];     /** Last partially reconstructed band samples */
+	int16_t d[7];     /** Last quantized differences */
+	int16_t b[7];     /** Zero coefficients (b[1] to b[6]) */
+	int16_t nb;       /** Logarithmic step scale factor */
+	int16_t det;      /** Step scale factor */
+};
+
+/**
+ * @brief state of a sub-band encoder or decoder
+ */
+struct subband_State
+{
+	int16_t qmf[SUBBAND_QMF_TAPS];   /** Delay line of the analysis (encoder) or synthesis (decoder) filter */
+	struct subband_Band low;         /** Band from 0 to SAMPLING_FREQUENCY / 4 */
+	struct subband_Band high;        /** Band from SAMPLING_FREQUENCY / 4 to SAMPLING_FREQUENCY / 2 */
+	uint8_t headers;                 /** Headers sent since the predictors were reset (encoder only) */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void subband_reset(void * state);
+uint32_t subband_encode(void * state, const uint16_t * samples);
+void subband_decode(void * state, uint32_t code, uint16_t * samples);
+void subband_getHeader(void * state, uint8_t * header);
+void subband_setHeader(void * state, const uint8_t * header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_SUBBAND_H_ */
@@ -25,11 +25,16 @@ extern "C" {
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_hal.h"
+#include "cycles.h"
 
 /* Exported functions prototypes ---------------------------------------------*/
 
 HAL_StatusTypeDef Timer_Start(TIM_HandleTypeDef * htim);
+HAL_StatusTypeDef Timer_StartTrigger(TIM_HandleTypeDef * htim);
 HAL_StatusTypeDef Timer_Stop(TIM_HandleTypeDef * htim);
+uint32_t Timer_GetClock(TIM_HandleTypeDef * htim);
+void Timer_MeasureLatency(TIM_HandleTypeDef * htim);
+const struct cycles_Info * Timer_GetLatency();
 
 #ifdef __cplusplus
 }
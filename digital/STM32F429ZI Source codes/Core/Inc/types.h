@@ -23,6 +23,13 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_hal.h"
 #include "config.h"
+#include "ring.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#if (SAMPLE_SIZE > 16) || (WORD_LENGTH > 16)
+#error "Samples are stored in uint16_t buffers, SAMPLE_SIZE and WORD_LENGTH should not be above 16"
+#endif
 
 /* Exported types ------------------------------------------------------------*/
 
@@ -36,9 +43,26 @@ enum streamState
 	BUSY        /** (2) Data is being transfered with a peripheral or another API */
 };
 
+/**
+ * @brief kinds of errors, from the cheapest to recover to the most expensive
+ * (see Stream_ErrorHandle in links.c)
+ */
+enum errorKind
+{
+	LINE_OVERRUN,        /** (0) UART ORE: a byte arrived before the previous one was read */
+	LINE_FRAMING,        /** (1) UART FE: stop bit not found */
+	LINE_NOISE,          /** (2) UART NE: noise detected on a bit */
+	LINE_PARITY,         /** (3) UART PE: wrong parity bit */
+	BUFFER_OVERRUN,      /** (4) A ring was full: data dropped up to the next synchronization point */
+	SAMPLE_RANGE,        /** (5) A sample exceeded SAMPLE_SIZE bits and was replaced */
+	PERIPHERAL_FAILURE,  /** (6) ADC overrun, DAC DMA underrun or UART DMA error: the peripheral was restarted */
+	FATAL_ERROR,         /** (7) Any other error: handled according to ERROR_HANDLING */
+	ERROR_KINDS          /** Number of kinds */
+};
+
 /**
  * @brief contains useful data to continuously send or receive data through UART
- * Basically, it's a uint8_t buffer with a lot of metadata
+ * Basically, it's a ring of bytes with a little metadata
  */
 struct bitStream_Info
 {
@@ -47,22 +71,14 @@ struct bitStream_Info
 	the configuration information for the specified USART module. */
 	
 	enum streamState state;   /** Current state of the stream (active or not) */
-	uint8_t * stream;         /** uint8_t buffer containing raw data flow */
-	uint8_t byte;             /** The byte to send or receive. Acts as a uint8_t buffer when
-	calling HAL drivers to receive or send one byte. For more explanations on why MicroW sends
-	and receives one byte at a time, please refer to USART detailed explanations docs section. */
-	
-	uint8_t lastBitOut;       /** Position of the last bit successfully treated (in last byte out) */
-	uint8_t synchronized;     /** Tells if a synchronization signal was received */
-	uint16_t length;          /** Buffer's size */
-	uint16_t lastByteIn;      /** Position of the last new byte in the buffer */
-	uint16_t lastByteOut;     /** Position of the last byte successfully treated */
-	uint16_t bytesSinceLastSyncSignal;  /** Number of bytes sent/received since the last sync. signal */
+	struct ring_Info ring;    /** uint8_t ring containing raw data flow. UART DMA reads
+	(emitter) or writes (receiver) directly in it: its buffer must not be in CCM RAM */
+	uint16_t transferLength;  /** Number of bytes being sent by DMA (emitter only) */
 };
 
 /**
  * @brief contains useful data to continuously receive data from ADC or send data to DAC
- * Basically, it's a uint32_t buffer with a lot of metadata
+ * Basically, it's a ring of samples with a little metadata
  */
 struct sampleStream_Info
 {
@@ -74,23 +90,15 @@ struct sampleStream_Info
 		that contains the configuration information for the specified ADC. */
 	};
 	struct bitStream_Info * defaultBitStream;   /** associated bitStream_Info structure (useful for encoder/decoder APIs) */
-	uint32_t * stream;          /** Buffer containing ADC samples to encode or decode */
+	struct ring_Info ring;      /** uint16_t ring containing samples to encode or decoded samples (SAMPLE_SIZE LSBs are used) */
 	enum streamState state;     /** Current state of the stream */
-	uint8_t bitsOut;            /** Number of bits successfully treated (between 0 and ADC's bit depth) */
-	uint16_t length;            /** Buffer's size */
-	uint16_t lastSampleIn;      /** Last new sample in the buffer (it was put here by the decoder or the ADC) */
-	uint16_t lastSampleOut;     /** Last sample successfully treated (encoded or given to the DAC) */
 	uint32_t DAC_Channel;       /** The selected HAL DAC channel. 
 	This field can be one of the following values: DAC_CHANNEL_1 or DAC_CHANNEL_2 */
 };
 
 /* Exported functions prototypes ---------------------------------------------*/
 
-#if (MODULE_TYPE == MICROW_EMITTER)
-HAL_StatusTypeDef streamInit(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream, ADC_HandleTypeDef * hadc, UART_HandleTypeDef * huart);
-#else
-HAL_StatusTypeDef streamInit(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream, DAC_HandleTypeDef * hdac, uint32_t Channel, UART_HandleTypeDef * huart);
-#endif
+HAL_StatusTypeDef streamInit(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream, ADC_HandleTypeDef * hadc, DAC_HandleTypeDef * hdac, uint32_t Channel, UART_HandleTypeDef * huart);
 
 HAL_StatusTypeDef streamFree(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream);
 
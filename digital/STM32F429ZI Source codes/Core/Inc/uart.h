@@ -30,19 +30,19 @@ extern "C" {
                   ##### Transmit functions #####
 =============================================================================*/
 
-HAL_StatusTypeDef UARTTx_streamStart(struct bitStream_Info * bitStream);
-HAL_StatusTypeDef UARTTx_streamRestart();
-HAL_StatusTypeDef UARTTx_streamUpdate();
-HAL_StatusTypeDef UARTTx_streamStop();
+HAL_StatusTypeDef UARTTx_streamStart(struct bitStream_Info * UART_stream);
+HAL_StatusTypeDef UARTTx_streamRestart(struct bitStream_Info * UART_stream);
+HAL_StatusTypeDef UARTTx_streamUpdate(struct bitStream_Info * UART_stream);
+HAL_StatusTypeDef UARTTx_streamStop(struct bitStream_Info * UART_stream);
 
 /*=============================================================================
                   ##### Receive functions #####
 =============================================================================*/
 
-HAL_StatusTypeDef UARTRx_streamStart(struct bitStream_Info * bitStream);
-HAL_StatusTypeDef UARTRx_streamRestart();
-HAL_StatusTypeDef UARTRx_streamUpdate();
-HAL_StatusTypeDef UARTRx_streamStop();
+HAL_StatusTypeDef UARTRx_streamStart(struct bitStream_Info * UART_stream);
+HAL_StatusTypeDef UARTRx_streamRestart(struct bitStream_Info * UART_stream);
+HAL_StatusTypeDef UARTRx_streamUpdate(struct bitStream_Info * UART_stream);
+HAL_StatusTypeDef UARTRx_streamStop(struct bitStream_Info * UART_stream);
 
 #ifdef __cplusplus
 }
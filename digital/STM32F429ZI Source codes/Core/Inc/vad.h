@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file           : vad.h
+  * @brief          : Header for vad.c file.
+  *                   Voice activity detection, for discontinuous transmission
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef INC_VAD_H_
+#define INC_VAD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "config.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief state of a voice activity detector, and its statistics
+ */
+struct vad_Info
+{
+	uint32_t noise;         /** Noise floor: mean square of silent frames (samples centered on 0) */
+	int32_t correlation;    /** Lag-1 correlation of silent frames, relative to their energy (Q15) */
+	uint16_t hangover;      /** Frames still sent after the last speech frame */
+	uint8_t started;        /** 0 until the first frame gave the initial noise floor */
+	uint32_t frames;        /** Frames processed since vad_Start */
+	uint32_t sentFrames;    /** Frames to send among them (speech and hangover) */
+};
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+void vad_Start(struct vad_Info * vad);
+uint8_t vad_Process(struct vad_Info * vad, const uint16_t * frame);
+void vad_getDescriptor(struct vad_Info * vad, uint8_t * descriptor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_VAD_H_ */
@@ -21,24 +21,25 @@
 #include "stm32f4xx_hal.h"
 #include "config.h"
 #include "links.h"
-
-/* Private variables ---------------------------------------------------------*/
-
-struct sampleStream_Info * ADC_stream;
+#include "sections.h"
 
 /* Exported functions --------------------------------------------------------*/
 
 /**
  * @brief creates an ADC stream according to provided sampleStream structure.
  * 
- * @param sampleStream[IN] pointer to the sampleStream_Info structure
+ * @param ADC_stream[IN] pointer to the sampleStream_Info structure, used as a handle by other ADC functions
  * @return HAL status (HAL_OK if no errors occured).
  * @note The ADC will automatically start 
  */
-HAL_StatusTypeDef ADC_streamStart(struct sampleStream_Info * sampleStream)
+HAL_StatusTypeDef ADC_streamStart(struct sampleStream_Info * ADC_stream)
 {
 	HAL_StatusTypeDef status;
-	ADC_stream = sampleStream;
+
+	if (ADC_stream == NULL)
+	{
+		return HAL_ERROR;
+	}
 
 	status = HAL_ADC_Start_IT(ADC_stream->hadc);
 	if (status != HAL_OK)
@@ -53,9 +54,10 @@ HAL_StatusTypeDef ADC_streamStart(struct sampleStream_Info * sampleStream)
 /**
  * @brief starts the ADC without overwriting existing parameters.
  * 
+ * @param ADC_stream[IN] pointer to the sampleStream_Info structure given to ADC_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef ADC_streamRestart()
+RAMFUNC HAL_StatusTypeDef ADC_streamRestart(struct sampleStream_Info * ADC_stream)
 {
 	HAL_StatusTypeDef status;
 	
@@ -77,40 +79,32 @@ HAL_StatusTypeDef ADC_streamRestart()
 /**
  * @brief should be called at the end of a conversion to update the buffer
  * 
- * @return HAL status (HAL_OK if no errors occured).
+ * @param ADC_stream[IN] pointer to the sampleStream_Info structure given to ADC_streamStart
+ * @return HAL status (HAL_OK if no errors occured, HAL_BUSY if the stream is stopped: the sample is dropped).
  */
-HAL_StatusTypeDef ADC_streamUpdate()
+RAMFUNC HAL_StatusTypeDef ADC_streamUpdate(struct sampleStream_Info * ADC_stream)
 {
-	uint32_t value;
+	uint16_t value;
 	
 	if (ADC_stream == NULL)
 	{
 		return HAL_ERROR;
 	}
 	
-	value = HAL_ADC_GetValue(ADC_stream->hadc);
+	value = (uint16_t)HAL_ADC_GetValue(ADC_stream->hadc);
 
 	if (ADC_stream->state == INACTIVE)
 	{
 		return HAL_BUSY;
 	}
 
-
-	ADC_stream->lastSampleIn += 1;
-	if (ADC_stream->lastSampleIn >= ADC_stream->length)
+	if (ring_Write(&(ADC_stream->ring), &value, 1) == 0)
 	{
-		ADC_stream->lastSampleIn = 0;
+		// Overrun (encoder too slow): the sample is dropped
+		Stream_ErrorHandle(ADC_stream, BUFFER_OVERRUN);
 	}
 
-	if (ADC_stream->lastSampleIn == ADC_stream->lastSampleOut)
-	{
-		// Overrun error (encoder too slow)
-		return HAL_ERROR;
-	}
-
-	(ADC_stream->stream)[ADC_stream->lastSampleIn] = value;
-
-	ADC_FinishedHandle();
+	ADC_FinishedHandle(ADC_stream);
 
 	return HAL_OK;
 }
@@ -118,9 +112,10 @@ HAL_StatusTypeDef ADC_streamUpdate()
 /**
  * @brief stops a running stream.
  * 
+ * @param ADC_stream[IN] pointer to the sampleStream_Info structure given to ADC_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef ADC_streamStop()
+HAL_StatusTypeDef ADC_streamStop(struct sampleStream_Info * ADC_stream)
 {
 	if (ADC_stream == NULL)
 	{
@@ -0,0 +1,249 @@
+/**
+  ******************************************************************************
+  * @file           : adpcm.c
+  * @brief          : IMA-ADPCM codec
+  *
+  * Each sample is coded on 4 bits: the sign and magnitude of its difference
+  * with a prediction (the previous reconstructed sample), in units of an
+  * adaptive step. The step grows after large codes and shrinks after small
+  * ones. Integer only: the encoder and the decoder reconstruct the same
+  * samples with the same function, so they never drift apart.
+  * Samples are scaled to 16 bits, the range of the standard step table.
+  * The predictor and the step index are sent after every synchronization
+  * signal: a decoder synchronizing in the middle of the stream starts from
+  * the state of the encoder.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "codec.h"
+#include "adpcm.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SAMPLE_OFFSET (1 << (SAMPLE_SIZE - 1))   // Mid-scale, 0 once centered
+#define SAMPLE_SHIFT (16 - SAMPLE_SIZE)          // Samples are scaled to 16 bits
+#define INDEX_MAX 88
+#define SIGN_BIT 0x08
+
+#if (SAMPLE_SIZE > 16)
+#error "SAMPLE_SIZE should not be above 16"
+#endif
+
+// The encoder and the decoder keep the state and the header of any codec in buffers of the codec.h sizes
+#if (ADPCM_HEADER_SIZE > CODEC_HEADER_SIZE)
+#error "ADPCM_HEADER_SIZE should not be above CODEC_HEADER_SIZE"
+#endif
+
+_Static_assert(sizeof(struct adpcm_State) <= CODEC_STATE_SIZE, "struct adpcm_State should not be larger than CODEC_STATE_SIZE");
+
+/* Private variables ---------------------------------------------------------*/
+
+static const uint16_t stepTable[INDEX_MAX + 1] =
+{
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+	19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+	130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+	876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+	5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t indexTable[16] =
+{
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void reconstruct(struct adpcm_State * adpcm, uint8_t code);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief resets the state: prediction at mid-scale, smallest step
+ *
+ * @param state[IN] pointer to an adpcm_State structure
+ */
+void adpcm_reset(void * state)
+{
+	struct adpcm_State * adpcm = state;
+
+	adpcm->predictor = 0;
+	adpcm->index = 0;
+	adpcm->previous = 0;
+	adpcm->low = 0;
+}
+
+/**
+ * @brief gives the 4-bit code of a sample
+ *
+ * Codes are sent two per byte, high nibble first. When the byte would be
+ * SYNC_SIGNAL, the closest code (LSB toggled) is used instead, before the
+ * state is updated: the decoder reconstructs the same sample.
+ *
+ * @param state[IN] pointer to an adpcm_State structure
+ * @param samples[IN] the sample (SAMPLE_SIZE LSBs)
+ * @return the code (4 LSBs)
+ */
+RAMFUNC uint32_t adpcm_encode(void * state, const uint16_t * samples)
+{
+	struct adpcm_State * adpcm = state;
+	int32_t difference = (((int32_t)samples[0] - SAMPLE_OFFSET) << SAMPLE_SHIFT) - adpcm->predictor;
+	int32_t step = stepTable[adpcm->index];
+	uint8_t code = 0;
+
+	if (difference < 0)
+	{
+		code = SIGN_BIT;
+		difference = -difference;
+	}
+
+	// Magnitude in units of step / 4, from the largest bit
+	if (difference >= step)
+	{
+		code |= 0x04;
+		difference -= step;
+	}
+	step >>= 1;
+	if (difference >= step)
+	{
+		code |= 0x02;
+		difference -= step;
+	}
+	step >>= 1;
+	if (difference >= step)
+	{
+		code |= 0x01;
+	}
+
+	if (adpcm->low && (adpcm->previous == (SYNC_SIGNAL >> 4)) && (code == (SYNC_SIGNAL & 0x0F)))
+	{
+		code ^= 0x01;
+	}
+	adpcm->previous = code;
+	adpcm->low ^= 1;
+
+	reconstruct(adpcm, code);
+	return code;
+}
+
+/**
+ * @brief gives the sample of a 4-bit code
+ *
+ * @param state[IN] pointer to an adpcm_State structure
+ * @param code[IN] the code (4 LSBs)
+ * @param samples[OUT] the sample (SAMPLE_SIZE LSBs)
+ */
+RAMFUNC void adpcm_decode(void * state, uint32_t code, uint16_t * samples)
+{
+	struct adpcm_State * adpcm = state;
+
+	reconstruct(adpcm, (uint8_t)code);
+	samples[0] = (uint16_t)((adpcm->predictor >> SAMPLE_SHIFT) + SAMPLE_OFFSET);
+}
+
+/**
+ * @brief gives the predictor and the step index of the encoder
+ *
+ * Every byte is below 0x80: a header is never taken for a synchronization signal.
+ * The next code is the high nibble of a byte (headers follow synchronization signals).
+ *
+ * @param state[IN] pointer to an adpcm_State structure
+ * @param header[OUT] ADPCM_HEADER_SIZE bytes
+ */
+RAMFUNC void adpcm_getHeader(void * state, uint8_t * header)
+{
+	struct adpcm_State * adpcm = state;
+	uint16_t predictor = (uint16_t)adpcm->predictor;
+
+	header[0] = (uint8_t)(predictor >> 14);
+	header[1] = (uint8_t)((predictor >> 7) & 0x7F);
+	header[2] = (uint8_t)(predictor & 0x7F);
+	header[3] = adpcm->index;
+
+	adpcm->previous = 0;
+	adpcm->low = 0;
+}
+
+/**
+ * @brief sets the predictor and the step index of the decoder
+ *
+ * @param state[IN] pointer to an adpcm_State structure
+ * @param header[IN] ADPCM_HEADER_SIZE bytes given by adpcm_getHeader
+ */
+RAMFUNC void adpcm_setHeader(void * state, const uint8_t * header)
+{
+	struct adpcm_State * adpcm = state;
+
+	adpcm->predictor = (int16_t)(((uint16_t)header[0] << 14) | ((uint16_t)header[1] << 7) | header[2]);
+	adpcm->index = (header[3] > INDEX_MAX) ? INDEX_MAX : header[3];
+}
+
+/**
+ * @brief updates the predictor and the step index with a code, like the decoder does
+ *
+ * @param adpcm[IN] pointer to the adpcm_State structure
+ * @param code[IN] the code (4 LSBs)
+ */
+static RAMFUNC void reconstruct(struct adpcm_State * adpcm, uint8_t code)
+{
+	int32_t step = stepTable[adpcm->index];
+	int32_t delta = step >> 3;
+	int32_t predictor;
+	int32_t index;
+
+	if (code & 0x04)
+	{
+		delta += step;
+	}
+	if (code & 0x02)
+	{
+		delta += step >> 1;
+	}
+	if (code & 0x01)
+	{
+		delta += step >> 2;
+	}
+
+	predictor = (code & SIGN_BIT) ? (adpcm->predictor - delta) : (adpcm->predictor + delta);
+	if (predictor > INT16_MAX)
+	{
+		predictor = INT16_MAX;
+	}
+	else if (predictor < INT16_MIN)
+	{
+		predictor = INT16_MIN;
+	}
+	adpcm->predictor = (int16_t)predictor;
+
+	index = adpcm->index + indexTable[code & 0x0F];
+	if (index < 0)
+	{
+		index = 0;
+	}
+	else if (index > INDEX_MAX)
+	{
+		index = INDEX_MAX;
+	}
+	adpcm->index = (uint8_t)index;
+}
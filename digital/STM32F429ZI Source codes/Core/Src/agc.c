@@ -0,0 +1,299 @@
+/**
+  ******************************************************************************
+  * @file           : agc.c
+  * @brief          : Automatic gain control and look-ahead limiter
+  *
+  * Emitter pipeline stage bringing every speaker to the same loudness before
+  * encoding, whether they whisper or shout. Speech frames update a speech
+  * level (mean square, following louder frames faster than quieter ones),
+  * which gives the gain bringing the RMS level to AGC_TARGET (AGC_MAX_GAIN at
+  * most). A noise floor tracks quiet frames like the VAD does: pauses don't
+  * move the gain, so the background isn't pumped up between sentences. The
+  * gain drops quickly and rises slowly, and is interpolated sample by sample
+  * across the frame.
+  * Peaks the gain pushes above AGC_LIMIT are caught by a limiter looking
+  * AGC_LOOKAHEAD samples ahead: samples are delayed by one block, and the
+  * limiter gain ramps linearly across each block to a value low enough for
+  * both this block and the next one. No output sample exceeds AGC_LIMIT,
+  * without the distortion of hard clipping.
+  * Fixed point only: Q12 AGC gain, Q15 limiter gain, one division per block.
+  * The stage adds AGC_LOOKAHEAD samples of latency.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "agc.h"
+#include "sections.h"
+
+#if (AGC == 1)
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SCALE_SHIFT (16 - SAMPLE_SIZE)           // Samples are scaled to 16 bits
+#define GAIN_MIN (AGC_GAIN_ONE / 8)              // Loudest speakers are attenuated by 18dB at most
+#define GAIN_MAX (AGC_MAX_GAIN * AGC_GAIN_ONE)
+#define RAMP_SHIFT 8                             // Fraction bits of gains being interpolated
+#define LEVEL_ATTACK_SHIFT 3                     // Speech level, louder frames: 1/8 of the way each frame
+#define LEVEL_RELEASE_SHIFT 5                    // Speech level, quieter frames: 1/32 of the way each frame
+#define ATTACK_SHIFT 2                           // Lower gain: 1/4 of the way each frame
+#define RELEASE_SHIFT 4                          // Higher gain: 1/16 of the way each frame
+#define LIMIT_RELEASE_SHIFT 3                    // Limiter gain: 1/8 of the way back to 1 each block
+#define SPEECH_THRESHOLD 4                       // Frames 6dB above the noise floor move the gain
+#define NOISE_MIN 1                              // The noise floor never reaches 0
+#define NOISE_FALL_SHIFT 2                       // Quieter frames: 1/4 of the way each frame
+#define NOISE_FOLLOW_SHIFT 4                     // Silent frames: 1/16 of the way each frame
+#define NOISE_RISE_SHIFT 8                       // Speech frames: +0.4% each frame (+1.7dB per second)
+
+#if (SAMPLE_SIZE > 16)
+#error "SAMPLE_SIZE should not be above 16"
+#endif
+
+#if (AGC_LOOKAHEAD < 1) || (FRAME_SIZE % AGC_LOOKAHEAD != 0)
+#error "AGC_LOOKAHEAD should be at least 1 and divide FRAME_SIZE"
+#endif
+
+// Samples scaled to 16 bits times GAIN_MAX fit in 32 bits
+#if (AGC_MAX_GAIN < 1) || (AGC_MAX_GAIN > 15)
+#error "AGC_MAX_GAIN should be between 1 and 15"
+#endif
+
+#if (AGC_TARGET < 1) || (AGC_TARGET > AGC_LIMIT) || (AGC_LIMIT > 32767)
+#error "AGC_TARGET should be between 1 and AGC_LIMIT, AGC_LIMIT below 32768"
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint32_t targetGain(struct agc_State * agc, uint32_t energy);
+static uint32_t squareRoot(uint32_t value);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief resets an automatic gain control: gain of 1, its first frame gives the noise floor
+ *
+ * @param state[IN] pointer to an agc_State structure
+ * @return HAL status (always HAL_OK)
+ */
+HAL_StatusTypeDef agc_Start(void * state)
+{
+	struct agc_State * agc = state;
+	uint16_t i;
+
+	for (i = 0; i < AGC_LOOKAHEAD; i++)
+	{
+		agc->pending[i] = 0;
+	}
+
+	agc->noise = NOISE_MIN;
+	agc->level = (uint32_t)AGC_TARGET * AGC_TARGET;
+	agc->gain = AGC_GAIN_ONE;
+	agc->limitedBlocks = 0;
+	agc->limit = AGC_LIMIT_ONE;
+	agc->pendingLimit = AGC_LIMIT_ONE;
+	agc->started = 0;
+	return HAL_OK;
+}
+
+/**
+ * @brief brings a frame to the target level, then limits its peaks
+ *
+ * @param state[IN] pointer to an agc_State structure
+ * @param frame[IN] FRAME_SIZE samples (SAMPLE_SIZE bits, centered on 0), replaced
+ * by the processed samples, AGC_LOOKAHEAD samples late
+ * @param length[IN] number of samples (FRAME_SIZE)
+ * @return HAL status (HAL_ERROR if length isn't FRAME_SIZE)
+ */
+RAMFUNC HAL_StatusTypeDef agc_Process(void * state, int16_t * frame, uint16_t length)
+{
+	struct agc_State * agc = state;
+	int32_t block[AGC_LOOKAHEAD];
+	uint64_t sum = 0;
+	uint32_t gain, peak, magnitude, need, end;
+	int32_t sample, ramp, step, limit, limitStep;
+	uint16_t i, j;
+
+	if (length != FRAME_SIZE)
+	{
+		return HAL_ERROR;
+	}
+
+	for (i = 0; i < FRAME_SIZE; i++)
+	{
+		sample = (int32_t)frame[i] * (1 << SCALE_SHIFT);
+		sum += (uint32_t)(sample * sample);
+	}
+
+	// Fast attack, slow release, interpolated from the gain of the last frame
+	gain = targetGain(agc, (uint32_t)(sum / FRAME_SIZE));
+	if (gain < agc->gain)
+	{
+		gain = agc->gain - ((agc->gain - gain) >> ATTACK_SHIFT);
+	}
+	else
+	{
+		gain = agc->gain + ((gain - agc->gain) >> RELEASE_SHIFT);
+	}
+	ramp = (int32_t)agc->gain << RAMP_SHIFT;
+	step = ((int32_t)gain - (int32_t)agc->gain) * (1 << RAMP_SHIFT) / FRAME_SIZE;
+	agc->gain = gain;
+
+	for (i = 0; i < FRAME_SIZE; i += AGC_LOOKAHEAD)
+	{
+		// Next block with the AGC gain, and its peak
+		peak = 0;
+		for (j = 0; j < AGC_LOOKAHEAD; j++)
+		{
+			ramp += step;
+			sample = ((int32_t)frame[i + j] * (1 << SCALE_SHIFT) * (ramp >> RAMP_SHIFT)) >> 12;
+			block[j] = sample;
+			magnitude = (sample < 0) ? -sample : sample;
+			if (magnitude > peak)
+			{
+				peak = magnitude;
+			}
+		}
+		need = (peak > AGC_LIMIT) ? ((uint32_t)AGC_LIMIT << 15) / peak : AGC_LIMIT_ONE;
+		if (need < AGC_LIMIT_ONE)
+		{
+			agc->limitedBlocks += 1;
+		}
+
+		// Limiter gain at the end of the pending block: recovering, but low enough for both blocks
+		end = agc->limit + ((AGC_LIMIT_ONE - agc->limit) >> LIMIT_RELEASE_SHIFT);
+		if (end > agc->pendingLimit)
+		{
+			end = agc->pendingLimit;
+		}
+		if (end > need)
+		{
+			end = need;
+		}
+
+		// Pending block, limiter gain ramping between two values keeping it under AGC_LIMIT
+		limit = (int32_t)agc->limit << RAMP_SHIFT;
+		limitStep = ((int32_t)end - (int32_t)agc->limit) * (1 << RAMP_SHIFT) / AGC_LOOKAHEAD;
+		for (j = 0; j < AGC_LOOKAHEAD; j++)
+		{
+			limit += limitStep;
+			sample = (int32_t)(((int64_t)agc->pending[j] * (limit >> RAMP_SHIFT)) >> 15);
+			frame[i + j] = (int16_t)((sample + ((1 << SCALE_SHIFT) >> 1)) >> SCALE_SHIFT);
+			agc->pending[j] = block[j];
+		}
+
+		agc->limit = (uint16_t)end;
+		agc->pendingLimit = (uint16_t)need;
+	}
+
+	return HAL_OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief gives the gain bringing a speech frame to AGC_TARGET, and updates the noise floor
+ *
+ * @param agc[IN] pointer to the agc_State structure
+ * @param energy[IN] mean square of the frame (scaled to 16 bits)
+ * @return the gain (Q12), the current one if the frame isn't speech
+ */
+static RAMFUNC uint32_t targetGain(struct agc_State * agc, uint32_t energy)
+{
+	uint32_t gain = agc->gain;
+
+	if (!agc->started)
+	{
+		agc->noise = (energy > NOISE_MIN) ? energy : NOISE_MIN;
+		agc->started = 1;
+	}
+
+	if (energy > (uint64_t)agc->noise * SPEECH_THRESHOLD)
+	{
+		// Speech level: follows louder speech faster than quieter speech, syllables don't move it much
+		if (energy > agc->level)
+		{
+			agc->level += (energy - agc->level) >> LEVEL_ATTACK_SHIFT;
+		}
+		else
+		{
+			agc->level -= (agc->level - energy) >> LEVEL_RELEASE_SHIFT;
+		}
+
+		gain = ((uint32_t)AGC_TARGET << 12) / squareRoot(agc->level);
+		if (gain < GAIN_MIN)
+		{
+			gain = GAIN_MIN;
+		}
+		else if (gain > GAIN_MAX)
+		{
+			gain = GAIN_MAX;
+		}
+	}
+
+	if (energy < agc->noise)
+	{
+		agc->noise -= (agc->noise - energy) >> NOISE_FALL_SHIFT;
+	}
+	else if (energy <= (uint64_t)agc->noise * SPEECH_THRESHOLD)
+	{
+		agc->noise += (energy - agc->noise) >> NOISE_FOLLOW_SHIFT;
+	}
+	else
+	{
+		agc->noise += (agc->noise >> NOISE_RISE_SHIFT) + 1;
+	}
+	if (agc->noise < NOISE_MIN)
+	{
+		agc->noise = NOISE_MIN;
+	}
+
+	return gain;
+}
+
+/**
+ * @brief gives the integer square root of a value (bit by bit)
+ *
+ * @param value[IN] the value
+ * @return the square root, rounded down
+ */
+static RAMFUNC uint32_t squareRoot(uint32_t value)
+{
+	uint32_t root = 0;
+	uint32_t bit = (uint32_t)1 << 30;
+
+	while (bit > value)
+	{
+		bit >>= 2;
+	}
+
+	while (bit != 0)
+	{
+		if (value >= root + bit)
+		{
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+#endif /* AGC == 1 */
@@ -0,0 +1,115 @@
+/**
+  ******************************************************************************
+  * @file           : biquad.c
+  * @brief          : Biquad cascade API
+  *
+  * Cascades of second-order IIR sections in direct form I, like
+  * arm_biquad_cascade_df1_q31 of CMSIS-DSP (same coefficient layout and
+  * signs): y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2],
+  * where a1 and a2 are stored negated. Coefficients are Q30 (-2 to 2), so
+  * that low-frequency poles close to the unit circle keep their precision.
+  * Samples are scaled to 24 bits between sections, with a 64-bit
+  * accumulator: rounding noise stays far below the 12-bit samples, and the
+  * cascade keeps 7 bits of headroom for sections with gain.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "biquad.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SCALE_SHIFT (24 - SAMPLE_SIZE)   // Samples are scaled to 24 bits
+#define COEFFICIENT_SHIFT 30             // Coefficients are Q30
+
+#if (SAMPLE_SIZE > 16)
+#error "SAMPLE_SIZE should not be above 16"
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief initializes a cascade, clearing its state
+ *
+ * @param biquad[IN] pointer to the biquad_Info structure, used as a handle by biquad_Process
+ * @param coefficients[IN] BIQUAD_COEFFICIENTS per section (b0, b1, b2, -a1, -a2 in Q30), not copied
+ * @param sections[IN] number of sections (BIQUAD_MAX_SECTIONS at most)
+ * @return HAL status (HAL_ERROR if there are too many sections)
+ */
+HAL_StatusTypeDef biquad_Init(struct biquad_Info * biquad, const int32_t * coefficients, uint8_t sections)
+{
+	uint8_t i;
+
+	if ((biquad == NULL) || ((coefficients == NULL) && (sections != 0)) || (sections > BIQUAD_MAX_SECTIONS))
+	{
+		return HAL_ERROR;
+	}
+
+	biquad->coefficients = coefficients;
+	biquad->sections = sections;
+
+	for (i = 0; i < 4 * BIQUAD_MAX_SECTIONS; i++)
+	{
+		biquad->state[i] = 0;
+	}
+
+	return HAL_OK;
+}
+
+/**
+ * @brief filters samples in place through every section of a cascade
+ *
+ * @param biquad[IN] pointer to the biquad_Info structure given to biquad_Init
+ * @param samples[IN] signed samples (SAMPLE_SIZE bits, centered on 0), replaced by
+ * the filtered ones (saturated)
+ * @param length[IN] number of samples
+ */
+RAMFUNC void biquad_Process(struct biquad_Info * biquad, int16_t * samples, uint16_t length)
+{
+	const int32_t * coefficients;
+	int32_t * state;
+	int64_t accumulator;
+	int32_t sample;
+	uint16_t i;
+	uint8_t k;
+
+	for (i = 0; i < length; i++)
+	{
+		sample = (int32_t)samples[i] * (1 << SCALE_SHIFT);
+		coefficients = biquad->coefficients;
+		state = biquad->state;
+
+		for (k = 0; k < biquad->sections; k++)
+		{
+			accumulator = (int64_t)coefficients[0] * sample + (int64_t)coefficients[1] * state[0]
+			            + (int64_t)coefficients[2] * state[1] + (int64_t)coefficients[3] * state[2]
+			            + (int64_t)coefficients[4] * state[3] + (1 << (COEFFICIENT_SHIFT - 1));
+			state[1] = state[0];
+			state[0] = sample;
+			sample = (int32_t)(accumulator >> COEFFICIENT_SHIFT);
+			state[3] = state[2];
+			state[2] = sample;
+
+			coefficients += BIQUAD_COEFFICIENTS;
+			state += 4;
+		}
+
+		sample = (sample + (1 << (SCALE_SHIFT - 1))) >> SCALE_SHIFT;
+		samples[i] = (int16_t)__SSAT(sample, SAMPLE_SIZE);
+	}
+}
@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file           : boot.c
+  * @brief          : Boot API
+  *
+  * Records when each boot step is reached, from the beginning of main() to
+  * the first sample, with the DWT cycle counter. The clock changes during the
+  * boot: cycles elapsed since the previous step are converted with the clock
+  * of the previous step. The CPU clock is kept running in sleep mode until
+  * the first sample, so that the main loop waiting for it is counted.
+  * The time spent by the startup before main() isn't counted: when BOOT_PROBE
+  * is 1, the LED at PG13 turns on at the first sample, an oscilloscope on
+  * NRST and PG13 gives the whole reset-to-first-sample time.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "boot.h"
+#include "cycles.h"
+#include "priority.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define BOOT_PROBE_PORT GPIOG
+#define BOOT_PROBE_PIN GPIO_PIN_13   // Configured as an output by MX_GPIO_Init()
+
+/* Private variables ---------------------------------------------------------*/
+
+static struct boot_Info boot CCMDATA;
+static uint32_t lastTime CCMDATA;     /** Time of the last step (us) */
+static uint32_t lastCycles CCMDATA;   /** DWT cycle counter value at the last step */
+static uint32_t lastClock CCMDATA;    /** CPU clock at the last step (MHz) */
+static uint8_t sleepClock CCMDATA;    /** 1 if Boot_Init kept the CPU clock running in sleep mode */
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief starts timing the boot and marks BOOT_MAIN
+ *
+ * Should be the first thing done by main(), before HAL_Init().
+ */
+void Boot_Init()
+{
+	uint8_t i;
+
+	for (i = 0; i < BOOT_STEPS; i++)
+	{
+		boot.time[i] = 0;
+	}
+	boot.reached = 0;
+
+	Cycles_Init();
+	DWT->CYCCNT = 0;
+	lastTime = 0;
+	lastCycles = 0;
+	lastClock = SystemCoreClock / 1000000;
+
+	// The cycle counter stops while the CPU sleeps, unless the debugger keeps its clock running
+	sleepClock = ((DBGMCU->CR & DBGMCU_CR_DBG_SLEEP) == 0);
+	if (sleepClock)
+	{
+		HAL_DBGMCU_EnableDBGSleepMode();
+	}
+
+	Boot_Mark(BOOT_MAIN);
+}
+
+/**
+ * @brief records the time at which a step is reached
+ *
+ * Only the first call for each step is recorded: it can be called on every
+ * sample, from any interrupt. BOOT_FIRST_SAMPLE also turns the LED at PG13 on (if BOOT_PROBE is 1)
+ * and lets the CPU clock stop in sleep mode again.
+ *
+ * @param step[IN] step reached
+ */
+RAMFUNC void Boot_Mark(enum bootStep step)
+{
+	uint32_t critical;
+	uint32_t now;
+
+	if (boot.reached & (1 << step))
+	{
+		return;
+	}
+
+	// The first sample may be marked by an interrupt while main() marks another step
+	critical = Priority_EnterCritical();
+	now = DWT->CYCCNT;
+	lastTime += (now - lastCycles) / lastClock;
+	boot.time[step] = lastTime;
+	boot.reached |= (1 << step);
+
+	lastCycles = now;
+	lastClock = SystemCoreClock / 1000000;
+	Priority_ExitCritical(critical);
+
+	if (step == BOOT_FIRST_SAMPLE)
+	{
+		if (BOOT_PROBE)
+		{
+			HAL_GPIO_WritePin(BOOT_PROBE_PORT, BOOT_PROBE_PIN, GPIO_PIN_SET);
+		}
+
+		if (sleepClock)
+		{
+			HAL_DBGMCU_DisableDBGSleepMode();
+			sleepClock = 0;
+		}
+	}
+}
+
+/**
+ * @brief gives the time at which each boot step was reached
+ *
+ * @return pointer to the times (microseconds since the beginning of main())
+ */
+const struct boot_Info * Boot_GetTimes()
+{
+	return &boot;
+}
@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file           : codec.c
+  * @brief          : Codec API
+  *
+  * The emitter encodes samples with the codec selected by CODEC. After every
+  * synchronization signal, it sends the id of the codec, then a header giving
+  * the state of its encoder (if it has one). The receiver decodes every codec
+  * of the table below: it selects the decoder matching the received id, so
+  * both modules don't have to be built with the same CODEC.
+  * To add a codec, give it a new id in config.h and an entry in the table.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "codec.h"
+#include "adpcm.h"
+#include "g711.h"
+#include "subband.h"
+#include "lossless.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define WORD_MASK ((1 << WORD_LENGTH) - 1)   // WORD_LENGTH LSBs are ones
+#define SAMPLE_MASK ((1 << SAMPLE_SIZE) - 1)   // SAMPLE_SIZE LSBs are ones
+#define PCM10_BITS ((SAMPLE_SIZE > 10) ? 10 : SAMPLE_SIZE)
+#define PCM10_SHIFT (SAMPLE_SIZE - PCM10_BITS)
+#define PCM8_BITS ((SAMPLE_SIZE > 8) ? 8 : SAMPLE_SIZE)
+#define PCM8_SHIFT (SAMPLE_SIZE - PCM8_BITS)
+
+// Ids and headers are sent as they are: they should never look like a synchronization signal
+#if (SYNC_SIGNAL < 0x80)
+#error "SYNC_SIGNAL should be at least 0x80 (codec ids and headers are below)"
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint32_t pcm_encode(void * state, const uint16_t * samples);
+static void pcm_decode(void * state, uint32_t code, uint16_t * samples);
+static uint32_t pcm10_encode(void * state, const uint16_t * samples);
+static void pcm10_decode(void * state, uint32_t code, uint16_t * samples);
+static uint32_t pcm8_encode(void * state, const uint16_t * samples);
+static void pcm8_decode(void * state, uint32_t code, uint16_t * samples);
+
+/* Codec table ---------------------------------------------------------------*/
+
+static const struct codec_Info codecs[] =
+{
+	{ "PCM", CODEC_PCM, WORD_LENGTH, 1, 0, 0, NULL, pcm_encode, pcm_decode, NULL, NULL, NULL },
+	{ "IMA-ADPCM", CODEC_ADPCM, ADPCM_CODE_BITS, 1, ADPCM_HEADER_SIZE, sizeof(struct adpcm_State),
+	  adpcm_reset, adpcm_encode, adpcm_decode, adpcm_getHeader, adpcm_setHeader, NULL },
+	{ "G.711 mu-law", CODEC_MULAW, G711_CODE_BITS, 1, 0, 0, NULL, g711_encodeMuLaw, g711_decodeMuLaw, NULL, NULL, NULL },
+	{ "G.711 A-law", CODEC_ALAW, G711_CODE_BITS, 1, 0, 0, NULL, g711_encodeALaw, g711_decodeALaw, NULL, NULL, NULL },
+	{ "Sub-band ADPCM", CODEC_SUBBAND, SUBBAND_CODE_BITS, SUBBAND_SAMPLES, SUBBAND_HEADER_SIZE, sizeof(struct subband_State),
+	  subband_reset, subband_encode, subband_decode, subband_getHeader, subband_setHeader, NULL },
+	{ "Lossless", CODEC_LOSSLESS, LOSSLESS_CODE_BITS, 1, LOSSLESS_HEADER_SIZE, sizeof(struct lossless_State),
+	  lossless_reset, lossless_encode, lossless_decode, lossless_getHeader, lossless_setHeader, lossless_measure },
+	{ "PCM 10-bit", CODEC_PCM10, PCM10_BITS, 1, 0, 0, NULL, pcm10_encode, pcm10_decode, NULL, NULL, NULL },
+	{ "PCM 8-bit", CODEC_PCM8, PCM8_BITS, 1, 0, 0, NULL, pcm8_encode, pcm8_decode, NULL, NULL, NULL }
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief gives the codec with the given id
+ *
+ * @param id[IN] the id (CODEC_PCM, CODEC_ADPCM...)
+ * @return pointer to the codec, NULL if there's no such codec
+ * @note Each codec file checks at compile time that it fits in
+ * CODEC_STATE_SIZE, CODEC_HEADER_SIZE and CODEC_MAX_SAMPLES
+ */
+RAMFUNC const struct codec_Info * codec_Find(uint8_t id)
+{
+	uint8_t i;
+
+	for (i = 0; i < sizeof(codecs) / sizeof(codecs[0]); i++)
+	{
+		if (codecs[i].id == id)
+		{
+			return &(codecs[i]);
+		}
+	}
+
+	return NULL;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief raw samples, WORD_LENGTH bits each. A byte equal to SYNC_SIGNAL is
+ * changed by the encoder afterwards (see encoder.c)
+ */
+static RAMFUNC uint32_t pcm_encode(void * state, const uint16_t * samples)
+{
+	return samples[0] & WORD_MASK;
+}
+
+static RAMFUNC void pcm_decode(void * state, uint32_t code, uint16_t * samples)
+{
+	samples[0] = code;
+}
+
+/**
+ * @brief MSBs of raw samples, used by the encoder under congestion (see
+ * encoder.c). Samples are decoded in the middle of the dropped LSBs range.
+ */
+static RAMFUNC uint32_t pcm10_encode(void * state, const uint16_t * samples)
+{
+	return (samples[0] & SAMPLE_MASK) >> PCM10_SHIFT;
+}
+
+static RAMFUNC void pcm10_decode(void * state, uint32_t code, uint16_t * samples)
+{
+	samples[0] = (uint16_t)((code << PCM10_SHIFT) | ((1 << PCM10_SHIFT) >> 1));
+}
+
+static RAMFUNC uint32_t pcm8_encode(void * state, const uint16_t * samples)
+{
+	return (samples[0] & SAMPLE_MASK) >> PCM8_SHIFT;
+}
+
+static RAMFUNC void pcm8_decode(void * state, uint32_t code, uint16_t * samples)
+{
+	samples[0] = (uint16_t)((code << PCM8_SHIFT) | ((1 << PCM8_SHIFT) >> 1));
+}
@@ -0,0 +1,242 @@
+/**
+  ******************************************************************************
+  * @file           : comfort.c
+  * @brief          : Silence descriptors and comfort noise
+  *
+  * During silences, the emitter only sends a silence descriptor every
+  * DTX_KEEPALIVE_PERIOD frames (see vad.c): the level and the spectral tilt
+  * of its background noise. When no sample arrives, the receiver plays a
+  * noise matching them instead of holding the last sample: a first-order
+  * filter shapes white noise, with the lag-1 correlation of the background
+  * noise as its pole. Silences don't sound like dropouts.
+  * The noise stops when samples arrive again, or when 3 descriptors in a row
+  * were lost (the emitter stopped).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "comfort.h"
+#include "priority.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SAMPLE_OFFSET (1 << (SAMPLE_SIZE - 1))   // Mid-scale, 0 once centered
+#define LEVEL_FRACTION_BITS 2                    // Level codes are 4 * log2(energy): 1.5dB steps
+#define TILT_ZERO 64                             // Tilt code of a white noise
+#define TILT_SCALE 63                            // Tilt codes range from 1 to 127
+#define POLE_MAX 29491                           // 0.9 (Q15): the shaping filter stays short
+#define TIMEOUT (4 * DTX_KEEPALIVE_PERIOD * FRAME_SIZE)   // Samples generated after a descriptor
+
+#if (SAMPLE_SIZE > 16)
+#error "SAMPLE_SIZE should not be above 16"
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint32_t squareRoot(uint64_t value);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief gives the silence descriptor of a background noise
+ *
+ * @param energy[IN] mean square of the noise (samples centered on 0)
+ * @param correlation[IN] lag-1 correlation of the noise, relative to its energy (Q15)
+ * @param descriptor[OUT] COMFORT_DESCRIPTOR_SIZE bytes, each one below 0x80
+ */
+RAMFUNC void comfort_Describe(uint32_t energy, int32_t correlation, uint8_t * descriptor)
+{
+	uint8_t msb;
+	int32_t tilt;
+
+	// Piecewise linear log2: integer part, then the 2 bits below the MSB
+	if (energy == 0)
+	{
+		descriptor[0] = 0;
+	}
+	else
+	{
+		msb = 31 - __CLZ(energy);
+		descriptor[0] = (uint8_t)((msb << LEVEL_FRACTION_BITS)
+		                | (((msb >= LEVEL_FRACTION_BITS) ? (energy >> (msb - LEVEL_FRACTION_BITS)) : (energy << (LEVEL_FRACTION_BITS - msb))) & 0x03));
+	}
+
+	tilt = TILT_ZERO + ((correlation * TILT_SCALE) >> 15);
+	if (tilt < TILT_ZERO - TILT_SCALE)
+	{
+		tilt = TILT_ZERO - TILT_SCALE;
+	}
+	else if (tilt > TILT_ZERO + TILT_SCALE)
+	{
+		tilt = TILT_ZERO + TILT_SCALE;
+	}
+	descriptor[1] = (uint8_t)tilt;
+}
+
+/**
+ * @brief resets a comfort noise generator, stopped until the first descriptor
+ *
+ * comfort_Generate runs in the DAC interrupts (sample timer or DMA), comfort_Set
+ * and comfort_Stop in PendSV: each one changes the state inside a critical
+ * section, comfort_Generate never sees half of it.
+ *
+ * @param comfort[IN] pointer to the comfort_Info structure, used as a handle by other comfort functions
+ */
+void comfort_Start(struct comfort_Info * comfort)
+{
+	uint32_t critical;
+
+	// With DAC_INTERPOLATION 0, the sample timer may already run
+	critical = Priority_EnterCritical();
+	comfort->gain = 0;
+	comfort->pole = 0;
+	comfort->last = 0;
+	comfort->seed = 1;
+	comfort->remaining = 0;
+	Priority_ExitCritical(critical);
+}
+
+/**
+ * @brief sets the noise from a received silence descriptor, and (re)starts it
+ *
+ * The gain gives the white noise the level of the descriptor once shaped:
+ * sqrt(3 * energy * (1 - pole^2)), the noise being uniform.
+ *
+ * @param comfort[IN] pointer to the comfort_Info structure given to comfort_Start
+ * @param descriptor[IN] COMFORT_DESCRIPTOR_SIZE bytes given by comfort_Describe
+ */
+RAMFUNC void comfort_Set(struct comfort_Info * comfort, const uint8_t * descriptor)
+{
+	uint8_t msb = descriptor[0] >> LEVEL_FRACTION_BITS;
+	uint32_t energy = ((uint32_t)((1 << LEVEL_FRACTION_BITS) | (descriptor[0] & 0x03)) << msb) >> LEVEL_FRACTION_BITS;
+	int32_t pole = (((int32_t)descriptor[1] - TILT_ZERO) << 15) / TILT_SCALE;
+	int32_t gain;
+	uint32_t critical;
+
+	if (descriptor[0] == 0)
+	{
+		energy = 0;
+	}
+
+	if (pole > POLE_MAX)
+	{
+		pole = POLE_MAX;
+	}
+	else if (pole < -POLE_MAX)
+	{
+		pole = -POLE_MAX;
+	}
+
+	gain = (int32_t)squareRoot((3 * (uint64_t)energy * (uint64_t)((1 << 30) - pole * pole)) >> 30);
+
+	// Computed above, published at once: the DAC interrupt (above PendSV) generates the noise
+	critical = Priority_EnterCritical();
+	comfort->gain = gain;
+	comfort->pole = (int16_t)pole;
+	comfort->remaining = TIMEOUT;
+	Priority_ExitCritical(critical);
+}
+
+/**
+ * @brief stops the noise, when samples arrive again
+ *
+ * @param comfort[IN] pointer to the comfort_Info structure given to comfort_Start
+ */
+RAMFUNC void comfort_Stop(struct comfort_Info * comfort)
+{
+	uint32_t critical;
+
+	critical = Priority_EnterCritical();
+	comfort->remaining = 0;
+	Priority_ExitCritical(critical);
+}
+
+/**
+ * @brief generates comfort noise samples, to be played when no sample arrived
+ *
+ * @param comfort[IN] pointer to the comfort_Info structure given to comfort_Start
+ * @param samples[OUT] the samples (SAMPLE_SIZE LSBs)
+ * @param count[IN] number of samples wanted
+ * @return number of samples generated (0 if the noise is stopped)
+ */
+RAMFUNC uint16_t comfort_Generate(struct comfort_Info * comfort, uint16_t * samples, uint16_t count)
+{
+	int32_t value = comfort->last;
+	uint16_t i;
+
+	if (count > comfort->remaining)
+	{
+		count = (uint16_t)comfort->remaining;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		// Linear congruential generator, its 16 MSBs are a uniform noise
+		comfort->seed = comfort->seed * 1664525 + 1013904223;
+		value = ((comfort->pole * value) >> 15) + ((comfort->gain * (int16_t)(comfort->seed >> 16)) >> 15);
+
+		if (value < -SAMPLE_OFFSET)
+		{
+			value = -SAMPLE_OFFSET;
+		}
+		else if (value > SAMPLE_OFFSET - 1)
+		{
+			value = SAMPLE_OFFSET - 1;
+		}
+		samples[i] = (uint16_t)(value + SAMPLE_OFFSET);
+	}
+
+	comfort->last = value;
+	comfort->remaining -= count;
+	return count;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief gives the integer square root of a value (bit by bit)
+ *
+ * @param value[IN] the value, below 2^62
+ * @return the square root, rounded down
+ */
+static uint32_t squareRoot(uint64_t value)
+{
+	uint64_t root = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while (bit > value)
+	{
+		bit >>= 2;
+	}
+
+	while (bit != 0)
+	{
+		if (value >= root + bit)
+		{
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return (uint32_t)root;
+}
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file           : cycles.c
+  * @brief          : CPU cycle counting API
+  *
+  * Uses the DWT cycle counter of the Cortex-M4, which counts every CPU cycle
+  * (180 per microsecond at 180MHz) with no runtime overhead.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "cycles.h"
+#include "sections.h"
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief enables the DWT cycle counter
+ * @note Can be called several times
+ */
+void Cycles_Init()
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief clears previous measurements
+ * 
+ * @param cycles[IN] pointer to the cycles_Info structure
+ */
+void Cycles_Reset(struct cycles_Info * cycles)
+{
+	cycles->start = 0;
+	cycles->last = 0;
+	cycles->max = 0;
+	cycles->count = 0;
+}
+
+/**
+ * @brief starts a new measurement
+ * 
+ * @param cycles[IN] pointer to the cycles_Info structure
+ */
+RAMFUNC void Cycles_Start(struct cycles_Info * cycles)
+{
+	cycles->start = DWT->CYCCNT;
+}
+
+/**
+ * @brief ends the measurement started by Cycles_Start and updates statistics
+ * 
+ * @param cycles[IN] pointer to the cycles_Info structure
+ * @note The counter wraps around every 23 seconds at 180MHz, unsigned
+ * substraction handles it as long as a measurement is shorter than that
+ */
+RAMFUNC void Cycles_Stop(struct cycles_Info * cycles)
+{
+	cycles->last = DWT->CYCCNT - cycles->start;
+	if (cycles->last > cycles->max)
+	{
+		cycles->max = cycles->last;
+	}
+	cycles->count += 1;
+}
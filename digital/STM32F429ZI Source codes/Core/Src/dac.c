@@ -21,76 +21,159 @@
 #include "stm32f4xx_hal.h"
 #include "config.h"
 #include "types.h"
+#include "dac.h"
+#include "links.h"
+#include "interpolator.h"
+#include "comfort.h"
+#include "cycles.h"
+#include "sections.h"
 
-/* Private variables ---------------------------------------------------------*/
+/* Private defines -----------------------------------------------------------*/
 
-struct sampleStream_Info * DAC_stream;
-uint16_t maskSample;
+#define SAMPLE_MASK ((1 << SAMPLE_SIZE) - 1)   // SAMPLE_SIZE LSBs are ones
+
+#if (DAC_INTERPOLATION > 1)
+#define DMA_BUFFER_SIZE (2 * DAC_DMA_BLOCK_SIZE * DAC_INTERPOLATION)
+
+#if (DAC_DMA_BLOCK_SIZE >= SAMPLE_BUFFER_SIZE)
+#error "DAC_DMA_BLOCK_SIZE should be below SAMPLE_BUFFER_SIZE"
+#endif
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
 
-static uint64_t mask(uint8_t bits);
-static uint8_t sampleAvailable();
+#if (DAC_INTERPOLATION > 1)
+static HAL_StatusTypeDef startDMA(struct DAC_Info * DAC_output);
+static void fillHalf(struct DAC_Info * DAC_output, uint16_t * output);
+static uint8_t getPlayedHalf(struct DAC_Info * DAC_output);
+#endif
 
 /* Exported functions --------------------------------------------------------*/
 
 /**
  * @brief initializes a stream to continuously output analog data
  * 
+ * @param DAC_output[IN] pointer to the DAC_Info structure, used as a handle by other DAC functions
  * @param sampleStream[IN] pointer to the sampleStream_Info structure
  * @return HAL status (HAL_OK if no errors occured).
  * @note The DAC will automatically start
  */
-HAL_StatusTypeDef DAC_streamStart(struct sampleStream_Info * sampleStream)
+HAL_StatusTypeDef DAC_streamStart(struct DAC_Info * DAC_output, struct sampleStream_Info * sampleStream)
 {
-	DAC_stream = sampleStream;
-	DAC_stream->state = ACTIVE;
+	if ((DAC_output == NULL) || (sampleStream == NULL))
+	{
+		return HAL_ERROR;
+	}
 
-	maskSample = mask(SAMPLE_SIZE);
+	// Reset before DAC_streamUpdate can see the stream: with DAC_INTERPOLATION 0, the sample timer already runs
+	comfort_Start(&(DAC_output->comfort));
+	DAC_output->DAC_stream = sampleStream;
+	sampleStream->state = ACTIVE;
 
-	return HAL_DAC_Start(DAC_stream->hdac, DAC_stream->DAC_Channel);
+#if (DAC_INTERPOLATION > 1)
+	Cycles_Init();
+	Cycles_Reset(&(DAC_output->cycles));
+	return startDMA(DAC_output);
+#else
+	return HAL_DAC_Start(sampleStream->hdac, sampleStream->DAC_Channel);
+#endif
 }
 
 /**
  * @brief starts a stream without overwriting existing parameters.
  * 
+ * @param DAC_output[IN] pointer to the DAC_Info structure given to DAC_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef DAC_streamRestart()
+HAL_StatusTypeDef DAC_streamRestart(struct DAC_Info * DAC_output)
 {
+	struct sampleStream_Info * DAC_stream = DAC_output->DAC_stream;
 	if (DAC_stream == NULL)
 	{
 		return HAL_ERROR;
 	}
 	
+	DAC_stream->state = ACTIVE;
+
+#if (DAC_INTERPOLATION > 1)
+	return startDMA(DAC_output);
+#else
 	return HAL_DAC_Start(DAC_stream->hdac, DAC_stream->DAC_Channel);
+#endif
 }
 
 /**
  * @brief should be called at the end of new data saving
  * 
+ * If DAC_INTERPOLATION > 1, should be called when DMA reaches the middle or
+ * the end of its buffer instead: the half of the DMA buffer that isn't being
+ * played is filled (see DAC_streamFill).
+ * 
+ * @param DAC_output[IN] pointer to the DAC_Info structure given to DAC_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef DAC_streamUpdate()
+#if (DAC_INTERPOLATION > 1)
+RAMFUNC HAL_StatusTypeDef DAC_streamUpdate(struct DAC_Info * DAC_output)
 {
-	uint64_t value;
-	if (DAC_stream == NULL)
+	if (DAC_output->DAC_stream == NULL)
 	{
 		return HAL_ERROR;
 	}
 
-	if (sampleAvailable())
+	return DAC_streamFill(DAC_output, DAC_HALVES ^ getPlayedHalf(DAC_output));
+}
+
+/**
+ * @brief fills halves of the DMA buffer, once DMA has played them
+ * 
+ * For each half, DAC_DMA_BLOCK_SIZE samples are taken from the sample stream,
+ * interpolated and written to it. During a silence (no sample sent by the
+ * emitter), the comfort noise replaces missing samples.
+ * When both halves were played since the last call, DMA is playing one of
+ * them again: that one was due first, it is filled first.
+ * 
+ * @param DAC_output[IN] pointer to the DAC_Info structure given to DAC_streamStart
+ * @param halves[IN] DAC_FIRST_HALF, DAC_SECOND_HALF, or both
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+RAMFUNC HAL_StatusTypeDef DAC_streamFill(struct DAC_Info * DAC_output, uint8_t halves)
+{
+	uint8_t played;
+
+	if (DAC_output->DAC_stream == NULL)
 	{
-		DAC_stream->lastSampleOut += 1;
-		if (DAC_stream->lastSampleOut >= DAC_stream->length)
-		{
-			DAC_stream->lastSampleOut = 0;
-		}
-		value = (DAC_stream->stream)[DAC_stream->lastSampleOut];
+		return HAL_ERROR;
+	}
+
+	played = getPlayedHalf(DAC_output);
+	if (halves & played)
+	{
+		fillHalf(DAC_output, (played == DAC_FIRST_HALF) ? &(DAC_output->DMA_buffer[0]) : &(DAC_output->DMA_buffer[DMA_BUFFER_SIZE / 2]));
+	}
+	if (halves & (DAC_HALVES ^ played))
+	{
+		fillHalf(DAC_output, (played == DAC_FIRST_HALF) ? &(DAC_output->DMA_buffer[DMA_BUFFER_SIZE / 2]) : &(DAC_output->DMA_buffer[0]));
+	}
+
+	return HAL_OK;
+}
+#else
+RAMFUNC HAL_StatusTypeDef DAC_streamUpdate(struct DAC_Info * DAC_output)
+{
+	struct sampleStream_Info * DAC_stream = DAC_output->DAC_stream;
+	uint16_t value;
+	if (DAC_stream == NULL)
+	{
+		return HAL_ERROR;
+	}
 
-		if ((value & maskSample) != value)
+	if ((ring_Read(&(DAC_stream->ring), &value, 1) == 1) || (comfort_Generate(&(DAC_output->comfort), &value, 1) == 1))
+	{
+		if ((value & SAMPLE_MASK) != value)
 		{
-			return HAL_ERROR;
+			// The DAC keeps the last sample
+			Stream_ErrorHandle(DAC_stream, SAMPLE_RANGE);
+			return HAL_OK;
 		}
 
 		return HAL_DAC_SetValue(DAC_stream->hdac, DAC_stream->DAC_Channel, DAC_ALIGN_12B_R, (uint32_t)value);
@@ -100,14 +183,17 @@ HAL_StatusTypeDef DAC_streamUpdate()
 		return HAL_OK;
 	}
 }
+#endif
 
 /**
  * @brief stops a running stream.
  * 
+ * @param DAC_output[IN] pointer to the DAC_Info structure given to DAC_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef DAC_streamStop()
+HAL_StatusTypeDef DAC_streamStop(struct DAC_Info * DAC_output)
 {
+	struct sampleStream_Info * DAC_stream = DAC_output->DAC_stream;
 	if (DAC_stream == NULL)
 	{
 		return HAL_ERROR;
@@ -115,47 +201,114 @@ HAL_StatusTypeDef DAC_streamStop()
 	
 	DAC_stream->state = INACTIVE;
 
+#if (DAC_INTERPOLATION > 1)
+	return HAL_DAC_Stop_DMA(DAC_stream->hdac, DAC_stream->DAC_Channel);
+#else
 	return HAL_DAC_Stop(DAC_stream->hdac, DAC_stream->DAC_Channel);
+#endif
 }
 
+#if (DAC_INTERPOLATION > 1)
 /**
- * @brief checks if sample is available
+ * @brief gives the CPU cost of the interpolation
  * 
- * @return 1 if a sample is available 0 else
+ * @param DAC_output[IN] pointer to the DAC_Info structure given to DAC_streamStart
+ * @return pointer to the measurements of the time to fill a half of the DMA buffer (CPU cycles)
  */
-static uint8_t sampleAvailable()
+const struct cycles_Info * DAC_getCycles(struct DAC_Info * DAC_output)
 {
-	if (DAC_stream == NULL)
+	return &(DAC_output->cycles);
+}
+#endif
+
+#if (DAC_INTERPOLATION > 1)
+/**
+ * @brief resets the interpolator and starts circular DMA transfers to the DAC.
+ * The DAC is then refreshed on every trigger of the timer.
+ * 
+ * @param DAC_output[IN] pointer to the DAC_Info structure
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+static HAL_StatusTypeDef startDMA(struct DAC_Info * DAC_output)
+{
+	struct sampleStream_Info * DAC_stream = DAC_output->DAC_stream;
+	uint16_t i;
+
+	interpolator_init(&(DAC_output->interpolator));
+	DAC_output->lastValue = 1 << (SAMPLE_SIZE - 1);
+
+	for (i = 0; i < DMA_BUFFER_SIZE; i++)
 	{
-		return 0;
+		DAC_output->DMA_buffer[i] = DAC_output->lastValue;
 	}
-	
-	if (DAC_stream->lastSampleIn != DAC_stream->lastSampleOut)
+
+	return HAL_DAC_Start_DMA(DAC_stream->hdac, DAC_stream->DAC_Channel, (uint32_t *)DAC_output->DMA_buffer, DMA_BUFFER_SIZE, DAC_ALIGN_12B_R);
+}
+
+/**
+ * @brief interpolates DAC_DMA_BLOCK_SIZE samples of the stream into a half of the DMA buffer
+ * 
+ * @param DAC_output[IN] pointer to the DAC_Info structure
+ * @param output[OUT] the half of the DMA buffer
+ */
+static RAMFUNC void fillHalf(struct DAC_Info * DAC_output, uint16_t * output)
+{
+	struct sampleStream_Info * DAC_stream = DAC_output->DAC_stream;
+	uint16_t samples[DAC_DMA_BLOCK_SIZE];
+	uint16_t count;
+	uint8_t i;
+
+	Cycles_Start(&(DAC_output->cycles));
+
+	count = ring_Read(&(DAC_stream->ring), samples, DAC_DMA_BLOCK_SIZE);
+	if (count < DAC_DMA_BLOCK_SIZE)
 	{
-		return 1;
+		count += comfort_Generate(&(DAC_output->comfort), &(samples[count]), DAC_DMA_BLOCK_SIZE - count);
 	}
-	else
+
+	for (i = 0; i < DAC_DMA_BLOCK_SIZE; i++)
 	{
-		return 0;
+		// If the decoder is late, or if the sample is out of range, the last sample is held
+		if (i < count)
+		{
+			if ((samples[i] & SAMPLE_MASK) == samples[i])
+			{
+				DAC_output->lastValue = samples[i];
+			}
+			else
+			{
+				Stream_ErrorHandle(DAC_stream, SAMPLE_RANGE);
+			}
+		}
+
+		interpolator_process(&(DAC_output->interpolator), DAC_output->lastValue, &(output[i * DAC_INTERPOLATION]));
 	}
+
+	Cycles_Stop(&(DAC_output->cycles));
 }
 
 /**
- * @brief creates a number in which n LSBs are ones
+ * @brief gives the half of the DMA buffer being played
  * 
- * @return the mask
+ * @param DAC_output[IN] pointer to the DAC_Info structure
+ * @return DAC_FIRST_HALF or DAC_SECOND_HALF
  */
-static uint64_t mask(uint8_t bits)
+static RAMFUNC uint8_t getPlayedHalf(struct DAC_Info * DAC_output)
 {
-	uint8_t bit;
-	uint64_t mask_var = 0;
+	struct sampleStream_Info * DAC_stream = DAC_output->DAC_stream;
+	DMA_HandleTypeDef * hdma;
 
-	for (bit = 0; bit < bits; bit++)
+	if (DAC_stream->DAC_Channel == DAC_CHANNEL_1)
+	{
+		hdma = DAC_stream->hdac->DMA_Handle1;
+	}
+	else
 	{
-		mask_var <<= 1;
-		mask_var += 1;
+		hdma = DAC_stream->hdac->DMA_Handle2;
 	}
 
-	return mask_var;
+	// The DMA counter tells how many transfers remain before the end of the buffer
+	return (__HAL_DMA_GET_COUNTER(hdma) > DMA_BUFFER_SIZE / 2) ? DAC_FIRST_HALF : DAC_SECOND_HALF;
 }
+#endif
 
@@ -20,47 +20,68 @@
 #include "stm32f4xx_hal.h"
 #include "links.h"
 #include "config.h"
+#include "sections.h"
+#include "cycles.h"
+#include "pipeline.h"
+#include "codec.h"
+#include "comfort.h"
 
-/* Private variables ---------------------------------------------------------*/
+/* Private defines -----------------------------------------------------------*/
 
-struct sampleStream_Info * DAC_stream;
-struct bitStream_Info * UART_stream;
+#define DECODER_BLOCK_SIZE 8                   // Bytes taken from the UART ring at once
+
+// Silence descriptors are received in the header buffer
+#if (COMFORT_DESCRIPTOR_SIZE > CODEC_HEADER_SIZE)
+#error "COMFORT_DESCRIPTOR_SIZE should not be above CODEC_HEADER_SIZE"
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
 
-static HAL_StatusTypeDef synchronize();
-static uint8_t dataAvailable();
-static HAL_StatusTypeDef saveSample(uint64_t value);
-static uint32_t posiLastIncomingBit();
-static uint32_t posiNextOutgoingBit();
-static uint32_t posiNextNeededBit();
+static HAL_StatusTypeDef decodeByte(struct decoder_Info * decoder, uint8_t byte);
+static void selectCodec(struct decoder_Info * decoder, uint8_t id);
+static HAL_StatusTypeDef decodeCode(struct decoder_Info * decoder, uint32_t code);
+static HAL_StatusTypeDef saveSample(struct decoder_Info * decoder, uint16_t value);
 
 /* Exported functions --------------------------------------------------------*/
 
 /**
  * @brief initializes a stream to continuously decode data
  * 
+ * @param decoder[IN] pointer to the decoder_Info structure, used as a handle by other decoder functions
  * @param bitStream[IN] pointer to an initialized bitStream_Info structure
  * @param sampleStream[IN] pointer to an initialized sampleStream_Info structure
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef decoder_streamStart(struct bitStream_Info * bitStream, struct sampleStream_Info * sampleStream)
+HAL_StatusTypeDef decoder_streamStart(struct decoder_Info * decoder, struct bitStream_Info * bitStream, struct sampleStream_Info * sampleStream)
 {
-	DAC_stream = sampleStream;
-	UART_stream = bitStream;
+	HAL_StatusTypeDef status;
 
-	if (UART_stream->length < 1 + WORD_LENGTH/8)
+	if ((decoder == NULL) || (bitStream == NULL) || (sampleStream == NULL))
 	{
 		return HAL_ERROR;
 	}
 
-	if (UART_stream->lastBitOut != 0)
+	status = pipeline_Start(&(decoder->pipeline), pipeline_receiverStages);
+	if (status != HAL_OK)
 	{
-		UART_stream->lastBitOut = 0;
+		return status;
 	}
 
-	DAC_stream->state = ACTIVE;
-	UART_stream->state = ACTIVE;
+	decoder->UART_stream = bitStream;
+	decoder->DAC_stream = sampleStream;
+	decoder->codec = NULL;
+	decoder->headerLength = 0;
+	decoder->accumulator = 0;
+	decoder->bits = 0;
+	decoder->synchronized = 0;
+	decoder->silence = 0;
+	decoder->comfort = NULL;
+
+	sampleStream->state = ACTIVE;
+	bitStream->state = ACTIVE;
+
+	Cycles_Init();
+	Cycles_Reset(&(decoder->cycles));
 
 	return HAL_OK;
 }
@@ -68,10 +89,13 @@ HAL_StatusTypeDef decoder_streamStart(struct bitStream_Info * bitStream, struct
 /**
  * @brief starts a stream without overwriting existing parameters.
  * 
+ * @param decoder[IN] pointer to the decoder_Info structure given to decoder_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef decoder_streamRestart()
+HAL_StatusTypeDef decoder_streamRestart(struct decoder_Info * decoder)
 {
+	struct bitStream_Info * UART_stream = decoder->UART_stream;
+	struct sampleStream_Info * DAC_stream = decoder->DAC_stream;
 	if ((UART_stream == NULL) || (DAC_stream == NULL))
 	{
 		return HAL_ERROR;
@@ -79,12 +103,9 @@ HAL_StatusTypeDef decoder_streamRestart()
 	
 	DAC_stream->state = ACTIVE;
 	UART_stream->state = ACTIVE;
-	UART_stream->synchronized = 0;
-
-	if (UART_stream->lastBitOut != 0)
-	{
-		UART_stream->lastBitOut = 0;
-	}
+	decoder->synchronized = 0;
+	decoder->bits = 0;
+	decoder->pipeline.length = 0;
 
 	return HAL_OK;
 }
@@ -92,70 +113,63 @@ HAL_StatusTypeDef decoder_streamRestart()
 /**
  * @brief updates the streams structures fields : take data from UART buffer to put it into the DAC buffer
  * 
+ * @param decoder[IN] pointer to the decoder_Info structure given to decoder_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  * @note should be called at the end of new data saving (see in links.c for details)
  */
-HAL_StatusTypeDef decoder_streamUpdate()
+RAMFUNC HAL_StatusTypeDef decoder_streamUpdate(struct decoder_Info * decoder)
 {
+	struct bitStream_Info * UART_stream = decoder->UART_stream;
 	HAL_StatusTypeDef status = HAL_OK;
-	uint8_t bit = 0; // For for loop
-	uint8_t bitCursor;
-	uint16_t byteCursor;
-	uint64_t value = 0;
+	uint8_t bytes[DECODER_BLOCK_SIZE];
+	uint16_t count;
+	uint16_t i;
 	
 	if (UART_stream == NULL)
 	{
 		return HAL_ERROR;
 	}
-	
-	bitCursor = UART_stream->lastBitOut;
-	byteCursor = UART_stream->lastByteOut;
 
-	status = synchronize();
-	if (status == HAL_BUSY)
-	{
-		// Waiting for sync signal (not an error)
-		return HAL_OK;
-	}
-	if (status != HAL_OK)
-	{
-		return status;
-	}
+	Cycles_Start(&(decoder->cycles));
 
-	if (dataAvailable() == 0)
+	do
 	{
-		// No new data
-		return HAL_OK;
-	}
+		count = ring_Read(&(UART_stream->ring), bytes, DECODER_BLOCK_SIZE);
 
-	for (bit = 0; bit < WORD_LENGTH; bit++)
-	{
-		value += (((UART_stream->stream)[byteCursor] & (0x80 >> bitCursor)) >> (7-bitCursor)) << (WORD_LENGTH-1-bit);
-		bitCursor += 1;
-		if (bitCursor == 8)
-		{
-			bitCursor = 0;
-			byteCursor += 1;
-		}
-		if (byteCursor >= UART_stream->length)
+		for (i = 0; (i < count) && (status == HAL_OK); i++)
 		{
-			byteCursor = 0;
+			status = decodeByte(decoder, bytes[i]);
 		}
-	}
+	} while ((count == DECODER_BLOCK_SIZE) && (status == HAL_OK));
 
-	UART_stream->lastBitOut = bitCursor;
-	UART_stream->lastByteOut = byteCursor;
+	Cycles_Stop(&(decoder->cycles));
+	return status;
+}
 
-	return saveSample(value);
+/**
+ * @brief drops every received bit up to the next synchronization signal
+ * 
+ * @param decoder[IN] pointer to the decoder_Info structure given to decoder_streamStart
+ * @note should be called when bytes may have been lost, for example after a UART error.
+ * The frame being gathered is kept.
+ */
+RAMFUNC void decoder_streamResync(struct decoder_Info * decoder)
+{
+	decoder->synchronized = 0;
+	decoder->accumulator = 0;
+	decoder->bits = 0;
 }
 
 /**
  * @brief stops a running stream.
  * 
+ * @param decoder[IN] pointer to the decoder_Info structure given to decoder_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef decoder_streamStop()
+HAL_StatusTypeDef decoder_streamStop(struct decoder_Info * decoder)
 {
+	struct bitStream_Info * UART_stream = decoder->UART_stream;
+	struct sampleStream_Info * DAC_stream = decoder->DAC_stream;
 	if ((UART_stream == NULL) || (DAC_stream == NULL))
 	{
 		return HAL_ERROR;
@@ -163,145 +177,253 @@ HAL_StatusTypeDef decoder_streamStop()
 	
 	DAC_stream->state = INACTIVE;
 	UART_stream->state = INACTIVE;
-	UART_stream->synchronized = 0;
+	decoder->synchronized = 0;
 
 	return HAL_OK;
 }
 
 /**
- * @brief Checks if the UART stream is synchronized with the encoder.
- * This function also tries to synchronize the stream.
+ * @brief gives the CPU cost of the decoder
  * 
- * @return HAL_ERROR if UART_stream isn't synchronized, else and HAL_OK
+ * @param decoder[IN] pointer to the decoder_Info structure given to decoder_streamStart
+ * @return pointer to the measurements of decoder_streamUpdate duration (CPU cycles per call)
  */
-static HAL_StatusTypeDef synchronize()
+const struct cycles_Info * decoder_getCycles(struct decoder_Info * decoder)
 {
-	if (UART_stream == NULL)
+	return &(decoder->cycles);
+}
+
+/**
+ * @brief appends a received byte to the bit accumulator and saves the samples of every completed code
+ * 
+ * A synchronization signal is followed by the codec id and its header, then
+ * the next bit is the MSB of a code. It may be followed by CODEC_SILENCE and
+ * a silence descriptor instead: the emitter doesn't send silent frames, the
+ * comfort noise is played until the next codec id (see vad.c and comfort.c).
+ * Bytes of variable-length codes whose 7 MSBs are the ones of SYNC_SIGNAL
+ * only carry these 7 bits (see encoder.c).
+ * Bytes received before the first synchronization signal are dropped.
+ * 
+ * @param decoder[IN] pointer to the decoder_Info structure
+ * @param byte[IN] the received byte
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+static RAMFUNC HAL_StatusTypeDef decodeByte(struct decoder_Info * decoder, uint8_t byte)
+{
+	HAL_StatusTypeDef status;
+	uint32_t code;
+	uint8_t codeBits;
+
+	if (byte == SYNC_SIGNAL)
 	{
-		return HAL_ERROR;
+		decoder->synchronized = 1;
+		decoder->headerLength = 0;
+		decoder->accumulator = 0;
+		decoder->bits = 0;
+		return HAL_OK;
 	}
-	
-	// Try to synchronize...
-	if ((UART_stream->stream)[UART_stream->lastByteIn] == SYNC_SIGNAL)
+
+	if (decoder->synchronized == 0)
 	{
+		// Waiting for sync signal (not an error)
+		return HAL_OK;
+	}
 
-		UART_stream->synchronized = 1;
-		UART_stream->lastBitOut = 0;
-		UART_stream->lastByteOut = UART_stream->lastByteIn + 1;
-		if (UART_stream->lastByteOut >= UART_stream->length)
+	if (decoder->headerLength == 0)
+	{
+		if (byte == CODEC_SILENCE)
 		{
-			UART_stream->lastByteOut = 0;
+			// The emitter only stops at the end of a frame: a frame being gathered lost bytes, and is kept
+			decoder->silence = 1;
+			decoder->headerLength = 1;
+			return HAL_OK;
 		}
+
+		decoder->silence = 0;
+		selectCodec(decoder, byte);
+		return HAL_OK;
 	}
 
-	if (UART_stream->synchronized == 0)
+	if (decoder->silence)
 	{
-		return HAL_BUSY;
+		decoder->header[decoder->headerLength - 1] = byte;
+		decoder->headerLength += 1;
+
+		if (decoder->headerLength > COMFORT_DESCRIPTOR_SIZE)
+		{
+			if (decoder->comfort != NULL)
+			{
+				comfort_Set(decoder->comfort, decoder->header);
+			}
+			// Nothing else up to the next synchronization signal
+			decoder->synchronized = 0;
+		}
+		return HAL_OK;
 	}
-	else
+
+	if (decoder->headerLength <= decoder->codec->headerSize)
 	{
+		decoder->header[decoder->headerLength - 1] = byte;
+		decoder->headerLength += 1;
+
+		if (decoder->headerLength > decoder->codec->headerSize)
+		{
+			decoder->codec->setHeader(decoder->codecState, decoder->header);
+		}
 		return HAL_OK;
 	}
-}
 
-/**
- * @brief gives the position of the last incoming bit
- * 
- * @return 0xFFFFFFFF in case of error, else the position of the last incoming bit
- */
-static uint32_t posiLastIncomingBit()
-{
-	if (UART_stream == NULL)
+	codeBits = decoder->codec->codeBits;
+	if (codeBits == 0)
 	{
-		return 0xFFFFFFFF;
+		// Variable-length codes: the codec tells when a code is complete
+		if ((byte >> 1) == (SYNC_SIGNAL >> 1))
+		{
+			decoder->accumulator = (decoder->accumulator << 7) | (byte >> 1);
+			decoder->bits += 7;
+		}
+		else
+		{
+			decoder->accumulator = (decoder->accumulator << 8) | byte;
+			decoder->bits += 8;
+		}
+
+		while ((codeBits = decoder->codec->measure(decoder->codecState, decoder->accumulator, decoder->bits)) != 0)
+		{
+			decoder->bits -= codeBits;
+
+			// Marker bit above the MSB, like given by the encoder
+			code = ((decoder->accumulator >> decoder->bits) & (((uint32_t)1 << codeBits) - 1)) | ((uint32_t)1 << codeBits);
+			status = decodeCode(decoder, code);
+			if (status != HAL_OK)
+			{
+				return status;
+			}
+		}
+		return HAL_OK;
 	}
-	
-	return (UART_stream->lastByteIn + 1) * 8 - 1;
-}
 
-/*
- * posiNextOutgoingBit gives the position of the next bit that will go out
- */
-/**
- * @brief gives the position of the next bit that will go out
- * 
- * @return 0xFFFFFFFF in case of error, else position of the next bit that will go out
- */
-static uint32_t posiNextOutgoingBit()
-{
-	if (UART_stream == NULL)
+	decoder->accumulator = (decoder->accumulator << 8) | byte;
+	decoder->bits += 8;
+
+	while (decoder->bits >= codeBits)
 	{
-		return 0xFFFFFFFF;
+		decoder->bits -= codeBits;
+
+		code = (decoder->accumulator >> decoder->bits) & (((uint32_t)1 << codeBits) - 1);
+		status = decodeCode(decoder, code);
+		if (status != HAL_OK)
+		{
+			return status;
+		}
 	}
-	
-	return (UART_stream->lastByteOut * 8) + UART_stream->lastBitOut;
+
+	return HAL_OK;
 }
 
 /**
- * @brief gives the position of the last bit needed to complete a sample
+ * @brief decodes a code and saves its samples
  * 
- * @return 0xFFFFFFFF in case of error, else position of the last bit needed to complete a sample
+ * @param decoder[IN] pointer to the decoder_Info structure
+ * @param code[IN] the code
+ * @return HAL status (HAL_OK if no errors occured).
  */
-static uint32_t posiNextNeededBit()
+static RAMFUNC HAL_StatusTypeDef decodeCode(struct decoder_Info * decoder, uint32_t code)
 {
-	if (UART_stream == NULL)
-	{
-		return 0xFFFFFFFF;
-	}
-	
-	if (posiNextOutgoingBit() + WORD_LENGTH >= UART_stream->length * 8)
-	{
-		return posiNextOutgoingBit() + WORD_LENGTH - UART_stream->length * 8;
-	}
-	else
+	HAL_StatusTypeDef status;
+	uint16_t samples[CODEC_MAX_SAMPLES];
+	uint8_t i;
+
+	decoder->codec->decode(decoder->codecState, code, samples);
+
+	for (i = 0; i < decoder->codec->samplesPerCode; i++)
 	{
-		return posiNextOutgoingBit() + WORD_LENGTH;
+		status = saveSample(decoder, samples[i]);
+		if (status != HAL_OK)
+		{
+			return status;
+		}
 	}
+
+	return HAL_OK;
 }
 
 /**
- * @brief check if there is nex data in incoming buffer (UART)
+ * @brief selects the codec matching the id received after a synchronization signal
  * 
- * @return returns 1 if untreated data is available, 0 else.
+ * The state of the codec is reset when the emitter changed codec. An unknown
+ * id is ignored up to the next synchronization signal.
+ * 
+ * @param decoder[IN] pointer to the decoder_Info structure
+ * @param id[IN] the received id
  */
-static uint8_t dataAvailable()
+static RAMFUNC void selectCodec(struct decoder_Info * decoder, uint8_t id)
 {
-	if (posiNextNeededBit()/8 == posiLastIncomingBit()/8 && posiLastIncomingBit() >= posiNextNeededBit())
+	const struct codec_Info * codec = codec_Find(id);
+
+	if (codec == NULL)
 	{
-		return 1;
+		decoder->synchronized = 0;
+		return;
 	}
-	else
+
+	if ((codec != decoder->codec) && (codec->reset != NULL))
 	{
-		return 0;
+		codec->reset(decoder->codecState);
 	}
+
+	decoder->codec = codec;
+	decoder->headerLength = 1;
 }
 
 /**
- * @brief saves provided value into sample stream to make it available to the DAC
+ * @brief adds provided value to the frame of the pipeline. Once the frame is
+ * full, the receiver stages process it and it is saved into sample stream to
+ * make it available to the DAC
  * 
+ * @param decoder[IN] pointer to the decoder_Info structure
+ * @param value[IN] the decoded sample
  * @return HAL status (HAL_ERROR or HAL_OK)
  */
-static HAL_StatusTypeDef saveSample(uint64_t value)
+static RAMFUNC HAL_StatusTypeDef saveSample(struct decoder_Info * decoder, uint16_t value)
 {
+	struct sampleStream_Info * DAC_stream = decoder->DAC_stream;
+	struct pipeline_Info * pipeline = &(decoder->pipeline);
+	HAL_StatusTypeDef status;
+
 	if (DAC_stream == NULL)
 	{
 		return HAL_ERROR;
 	}
-	
-	DAC_stream->lastSampleIn += 1;
-	if (DAC_stream->lastSampleIn >= DAC_stream->length)
+
+	pipeline->frame[pipeline->length] = value;
+	pipeline->length += 1;
+
+	if (pipeline->length < FRAME_SIZE)
 	{
-		DAC_stream->lastSampleIn = 0;
+		return HAL_OK;
 	}
 
-	if (DAC_stream->lastSampleIn == DAC_stream->lastSampleOut)
+	pipeline->length = 0;
+
+	status = pipeline_Process(pipeline);
+	if (status != HAL_OK)
 	{
-		// Overrun error (DAC too slow, or buffer too short)
-		return HAL_ERROR;
+		return status;
 	}
 
-	(DAC_stream->stream)[DAC_stream->lastSampleIn] = value;
-	return HAL_OK;
-}
+	if (ring_Space(&(DAC_stream->ring)) < FRAME_SIZE)
+	{
+		// Overrun (DAC too slow, or buffer too short): the frame is dropped
+		Stream_ErrorHandle(DAC_stream, BUFFER_OVERRUN);
+		return HAL_OK;
+	}
 
+	ring_Write(&(DAC_stream->ring), pipeline->frame, FRAME_SIZE);
 
+	if (decoder->comfort != NULL)
+	{
+		comfort_Stop(decoder->comfort);
+	}
+	return HAL_OK;
+}
@@ -0,0 +1,402 @@
+/**
+  ******************************************************************************
+  * @file           : denoise.c
+  * @brief          : Spectral noise suppression
+  *
+  * Emitter pipeline stage attenuating stationary noise (wind, water, engine)
+  * before encoding. Each frame and the previous one are windowed (sine
+  * window), then go through a 256-point real FFT. In every bin, a noise
+  * floor tracks the smoothed power: it drops quickly to quieter frames,
+  * follows frames below twice the floor (noise), and only rises slowly
+  * (+3.4dB per second) above, so that speech doesn't raise it. Each bin is scaled by a Wiener gain
+  * (1 - DENOISE_OVERSUBTRACTION * noise / power, DENOISE_GAIN_FLOOR at
+  * least), smoothed from frame to frame against musical noise. The inverse
+  * FFT is windowed again and overlap-added: the output is one frame late.
+  * Fixed point only: 16-bit samples and Q15 twiddles, 32-bit FFT data
+  * without scaling, so quiet backgrounds keep their resolution.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "denoise.h"
+#include "sections.h"
+
+#if (NOISE_SUPPRESSION == 1)
+
+/* Private defines -----------------------------------------------------------*/
+
+#define HALF (DENOISE_FFT_SIZE / 2)            // Complex FFT size: real samples are paired
+#define SCALE_SHIFT (16 - SAMPLE_SIZE)         // Samples are scaled to 16 bits
+#define INVERSE_SHIFT 9                        // Inverse FFT (1 / HALF) and both splits (1 / 4)
+#define POWER_SHIFT 12                         // Power of a bin, scaled to 32 bits
+#define POWER_SMOOTH_SHIFT 2                   // Smoothed power: 1/4 of the way each frame
+#define NOISE_FALL_SHIFT 2                     // Quieter bins: 1/4 of the way each frame
+#define NOISE_LIKE 2                           // Bins below twice their noise floor are noise
+#define NOISE_FOLLOW_SHIFT 4                   // Noise bins: 1/16 of the way each frame
+#define NOISE_RISE_SHIFT 7                     // Otherwise: +0.8% each frame (+3.4dB per second)
+#define GAIN_SMOOTH_SHIFT 2                    // Smoothed gain: 1/4 of the way each frame
+#define GAIN_ONE 32767                         // Gain of 1 (Q15)
+
+#if (FRAME_SIZE != 120) || (DENOISE_FFT_SIZE != 256)
+#error "Window and twiddle tables below are designed for FRAME_SIZE = 120 (SAMPLING_FREQUENCY = 12000) and DENOISE_FFT_SIZE = 256: set NOISE_SUPPRESSION to 0"
+#endif
+
+#if (SAMPLE_SIZE > 16)
+#error "SAMPLE_SIZE should not be above 16"
+#endif
+
+#if (DENOISE_GAIN_FLOOR < 1) || (DENOISE_GAIN_FLOOR > GAIN_ONE) || (DENOISE_OVERSUBTRACTION < 1)
+#error "DENOISE_GAIN_FLOOR should be between 1 and 32767, DENOISE_OVERSUBTRACTION at least 1"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+/*
+ * sine[i] = sin(2 * pi * i / DENOISE_FFT_SIZE) in Q15, for i from 0 to
+ * 3 / 4 of a turn (included): cos(2 * pi * i / DENOISE_FFT_SIZE) = sine[i + HALF / 2].
+ */
+static const int16_t sine[HALF + HALF / 2 + 1] =
+{
+	     0,    804,   1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,   7962,   8739,
+	  9512,  10278,  11039,  11793,  12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+	 18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,  23170,  23731,  24279,  24811,
+	 25329,  25832,  26319,  26790,  27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+	 30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,
+	 32609,  32678,  32728,  32757,  32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+	 32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,  30273,  29956,  29621,  29268,
+	 28898,  28510,  28105,  27683,  27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+	 23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,
+	 15446,  14732,  14010,  13279,  12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+	  6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,      0,   -804,  -1608,  -2410,
+	 -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+	-12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159,
+	-20787, -21403, -22005, -22594, -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+	-27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+	-31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+	-32767
+};
+
+/*
+ * First half of the sine window: window[n] = sin(pi * (n + 0.5) / (2 * FRAME_SIZE))
+ * in Q15, the second half is symmetric. It is applied before the FFT and
+ * after the inverse FFT: the squares of overlapping halves sum to 1.
+ */
+static const int16_t window[FRAME_SIZE] =
+{
+	   214,    643,   1072,   1501,   1929,   2357,   2785,   3212,   3638,   4064,   4489,   4914,
+	  5338,   5760,   6182,   6603,   7022,   7441,   7858,   8273,   8688,   9101,   9512,   9921,
+	 10329,  10735,  11140,  11542,  11943,  12341,  12737,  13131,  13523,  13913,  14300,  14685,
+	 15067,  15446,  15823,  16197,  16569,  16937,  17303,  17666,  18026,  18382,  18736,  19086,
+	 19433,  19777,  20117,  20454,  20787,  21117,  21443,  21766,  22084,  22399,  22710,  23018,
+	 23321,  23620,  23915,  24207,  24494,  24776,  25055,  25329,  25599,  25865,  26126,  26382,
+	 26635,  26882,  27125,  27363,  27597,  27826,  28050,  28269,  28484,  28693,  28898,  29098,
+	 29292,  29482,  29667,  29846,  30021,  30190,  30354,  30513,  30667,  30815,  30958,  31096,
+	 31229,  31356,  31478,  31594,  31705,  31811,  31911,  32006,  32095,  32179,  32257,  32329,
+	 32396,  32458,  32514,  32564,  32609,  32648,  32682,  32710,  32733,  32749,  32761,  32766
+};
+
+/*
+ * Work buffers. Only the encoder runs this stage, and frames are processed
+ * one at a time (in the ADC interrupt or in PendSV): links share them.
+ */
+static int32_t samples[DENOISE_FFT_SIZE];     // Real samples, read as HALF complex ones (real, imaginary)
+static int32_t spectrum[2 * DENOISE_BINS];    // Bins 0 to HALF (real, imaginary)
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void fft(int32_t * data);
+static void forwardSplit();
+static void inverseSplit();
+static void suppress(struct denoise_State * denoise);
+static int32_t multiply(int32_t value, int32_t q15);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief resets a noise suppressor: its first frame gives the noise floor
+ *
+ * @param state[IN] pointer to a denoise_State structure
+ * @return HAL status (always HAL_OK)
+ */
+HAL_StatusTypeDef denoise_Start(void * state)
+{
+	struct denoise_State * denoise = state;
+	uint16_t i;
+
+	for (i = 0; i < FRAME_SIZE; i++)
+	{
+		denoise->history[i] = 0;
+		denoise->overlap[i] = 0;
+	}
+
+	for (i = 0; i < DENOISE_BINS; i++)
+	{
+		denoise->power[i] = 0;
+		denoise->noise[i] = 0;
+		denoise->gain[i] = GAIN_ONE;
+	}
+
+	denoise->started = 0;
+	return HAL_OK;
+}
+
+/**
+ * @brief removes the noise floor from a frame
+ *
+ * @param state[IN] pointer to a denoise_State structure
+ * @param frame[IN] FRAME_SIZE samples (SAMPLE_SIZE bits, centered on 0), replaced
+ * by the previous frame once processed
+ * @param length[IN] number of samples (FRAME_SIZE)
+ * @return HAL status (HAL_ERROR if length isn't FRAME_SIZE)
+ */
+RAMFUNC HAL_StatusTypeDef denoise_Process(void * state, int16_t * frame, uint16_t length)
+{
+	struct denoise_State * denoise = state;
+	int32_t sample;
+	uint16_t i;
+
+	if (length != FRAME_SIZE)
+	{
+		return HAL_ERROR;
+	}
+
+	// Previous frame, then this one, windowed and zero-padded
+	for (i = 0; i < FRAME_SIZE; i++)
+	{
+		sample = (int32_t)frame[i] * (1 << SCALE_SHIFT);
+		samples[i] = multiply(denoise->history[i], window[i]);
+		samples[i + FRAME_SIZE] = multiply(sample, window[FRAME_SIZE - 1 - i]);
+		denoise->history[i] = (int16_t)sample;
+	}
+	for (i = 2 * FRAME_SIZE; i < DENOISE_FFT_SIZE; i++)
+	{
+		samples[i] = 0;
+	}
+
+	fft(samples);
+	forwardSplit();
+	suppress(denoise);
+	inverseSplit();
+
+	// Inverse FFT: conjugate (done by inverseSplit), forward FFT, conjugate
+	fft(samples);
+	for (i = 1; i < DENOISE_FFT_SIZE; i += 2)
+	{
+		samples[i] = -samples[i];
+	}
+
+	// Overlap-add: the first half completes the previous output, the second one waits
+	for (i = 0; i < FRAME_SIZE; i++)
+	{
+		sample = (samples[i] + (1 << (INVERSE_SHIFT - 1))) >> INVERSE_SHIFT;
+		sample = multiply(sample, window[i]) + denoise->overlap[i];
+		frame[i] = (int16_t)((sample + ((1 << SCALE_SHIFT) >> 1)) >> SCALE_SHIFT);
+
+		sample = (samples[i + FRAME_SIZE] + (1 << (INVERSE_SHIFT - 1))) >> INVERSE_SHIFT;
+		sample = multiply(sample, window[FRAME_SIZE - 1 - i]);
+		denoise->overlap[i] = (int16_t)__SSAT(sample, 16);
+	}
+
+	return HAL_OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief multiplies a value by a Q15 factor (rounded)
+ */
+static inline int32_t multiply(int32_t value, int32_t q15)
+{
+	return (int32_t)(((int64_t)value * q15 + (1 << 14)) >> 15);
+}
+
+/**
+ * @brief in-place radix-2 FFT of HALF complex samples (real, imaginary), not scaled
+ *
+ * @param data[IN] 2 * HALF values, replaced by the spectrum
+ */
+static RAMFUNC void fft(int32_t * data)
+{
+	uint16_t i, j, k, size, step;
+	int32_t real, imaginary, c, s;
+	int32_t * a;
+	int32_t * b;
+
+	// Bit-reversed order
+	for (i = 0, j = 0; i < HALF; i++)
+	{
+		if (i < j)
+		{
+			real = data[2 * i];
+			imaginary = data[2 * i + 1];
+			data[2 * i] = data[2 * j];
+			data[2 * i + 1] = data[2 * j + 1];
+			data[2 * j] = real;
+			data[2 * j + 1] = imaginary;
+		}
+		for (k = HALF >> 1; (k != 0) && (j & k); k >>= 1)
+		{
+			j ^= k;
+		}
+		j |= k;
+	}
+
+	// Butterflies, twiddle exp(-2i * pi * k / size) = sine[k * step + HALF / 2] - i * sine[k * step]
+	for (size = 2; size <= HALF; size <<= 1)
+	{
+		step = DENOISE_FFT_SIZE / size;
+		for (k = 0; k < size / 2; k++)
+		{
+			c = sine[k * step + HALF / 2];
+			s = sine[k * step];
+			for (i = k; i < HALF; i += size)
+			{
+				a = &(data[2 * i]);
+				b = &(data[2 * (i + size / 2)]);
+				real = multiply(b[0], c) + multiply(b[1], s);
+				imaginary = multiply(b[1], c) - multiply(b[0], s);
+				b[0] = a[0] - real;
+				b[1] = a[1] - imaginary;
+				a[0] += real;
+				a[1] += imaginary;
+			}
+		}
+	}
+}
+
+/**
+ * @brief gives the bins of the real samples from the FFT of their pairs
+ *
+ * X[k] = (A + W^k * -i * B) / 2, with A = Z[k] + conj(Z[HALF - k]),
+ * B = Z[k] - conj(Z[HALF - k]) and W = exp(-2i * pi / DENOISE_FFT_SIZE).
+ * Bins are left twice as large (the 1 / 2 is in INVERSE_SHIFT).
+ */
+static RAMFUNC void forwardSplit()
+{
+	uint16_t k, m;
+	int32_t aReal, aImaginary, bReal, bImaginary, c, s;
+
+	for (k = 0; k <= HALF; k++)
+	{
+		m = (HALF - k) & (HALF - 1);
+		aReal = samples[2 * (k & (HALF - 1))] + samples[2 * m];
+		aImaginary = samples[2 * (k & (HALF - 1)) + 1] - samples[2 * m + 1];
+		bReal = samples[2 * (k & (HALF - 1))] - samples[2 * m];
+		bImaginary = samples[2 * (k & (HALF - 1)) + 1] + samples[2 * m + 1];
+
+		// -i * B = bImaginary - i * bReal, times W^k = c - i * s
+		c = sine[k + HALF / 2];
+		s = sine[k];
+		spectrum[2 * k] = aReal + multiply(bImaginary, c) - multiply(bReal, s);
+		spectrum[2 * k + 1] = aImaginary - multiply(bReal, c) - multiply(bImaginary, s);
+	}
+}
+
+/**
+ * @brief gives the conjugate of the FFT of the pairs of real samples from their bins
+ *
+ * Z[k] = A + i * W^-k * B, with A = X[k] + conj(X[HALF - k]) and
+ * B = X[k] - conj(X[HALF - k]). The conjugate is ready for the inverse FFT.
+ */
+static RAMFUNC void inverseSplit()
+{
+	uint16_t k;
+	int32_t aReal, aImaginary, bReal, bImaginary, c, s;
+
+	for (k = 0; k < HALF; k++)
+	{
+		aReal = spectrum[2 * k] + spectrum[2 * (HALF - k)];
+		aImaginary = spectrum[2 * k + 1] - spectrum[2 * (HALF - k) + 1];
+		bReal = spectrum[2 * k] - spectrum[2 * (HALF - k)];
+		bImaginary = spectrum[2 * k + 1] + spectrum[2 * (HALF - k) + 1];
+
+		// i * W^-k * B, with i * W^-k = -s + i * c
+		c = sine[k + HALF / 2];
+		s = sine[k];
+		samples[2 * k] = aReal - multiply(bReal, s) - multiply(bImaginary, c);
+		samples[2 * k + 1] = -(aImaginary + multiply(bReal, c) - multiply(bImaginary, s));
+	}
+}
+
+/**
+ * @brief updates the noise floor of every bin and scales the bin by its gain
+ *
+ * @param denoise[IN] pointer to the denoise_State structure
+ */
+static RAMFUNC void suppress(struct denoise_State * denoise)
+{
+	uint64_t square;
+	uint32_t power, noise, shift;
+	int32_t gain;
+	uint16_t k;
+
+	for (k = 0; k < DENOISE_BINS; k++)
+	{
+		square = (uint64_t)((int64_t)spectrum[2 * k] * spectrum[2 * k])
+		         + (uint64_t)((int64_t)spectrum[2 * k + 1] * spectrum[2 * k + 1]);
+		square >>= POWER_SHIFT;
+		power = (square > UINT32_MAX) ? UINT32_MAX : (uint32_t)square;
+
+		if (denoise->started == 0)
+		{
+			denoise->power[k] = power;
+			denoise->noise[k] = power;
+		}
+		denoise->power[k] += (power >> POWER_SMOOTH_SHIFT) - (denoise->power[k] >> POWER_SMOOTH_SHIFT);
+
+		// Noise floor: minimum of the smoothed power, rising slowly
+		noise = denoise->noise[k];
+		if (denoise->power[k] < noise)
+		{
+			noise -= (noise - denoise->power[k]) >> NOISE_FALL_SHIFT;
+		}
+		else if (denoise->power[k] < (uint64_t)noise * NOISE_LIKE)
+		{
+			noise += ((denoise->power[k] - noise) >> NOISE_FOLLOW_SHIFT) + 1;
+		}
+		else
+		{
+			noise += (noise >> NOISE_RISE_SHIFT) + 1;
+		}
+		denoise->noise[k] = noise;
+
+		// Wiener gain 1 - noise / power, both scaled down to 16 bits for the division
+		noise = ((uint64_t)noise * DENOISE_OVERSUBTRACTION > UINT32_MAX) ? UINT32_MAX : noise * DENOISE_OVERSUBTRACTION;
+		if (noise >= power)
+		{
+			gain = DENOISE_GAIN_FLOOR;
+		}
+		else
+		{
+			shift = (power > 0xFFFF) ? 16 - __CLZ(power) : 0;
+			gain = GAIN_ONE - (int32_t)(((noise >> shift) << 15) / (power >> shift));
+			if (gain < DENOISE_GAIN_FLOOR)
+			{
+				gain = DENOISE_GAIN_FLOOR;
+			}
+		}
+		gain = denoise->gain[k] + ((gain - denoise->gain[k]) >> GAIN_SMOOTH_SHIFT);
+		denoise->gain[k] = (uint16_t)gain;
+
+		spectrum[2 * k] = multiply(spectrum[2 * k], gain);
+		spectrum[2 * k + 1] = multiply(spectrum[2 * k + 1], gain);
+	}
+
+	denoise->started = 1;
+}
+
+#endif /* NOISE_SUPPRESSION == 1 */
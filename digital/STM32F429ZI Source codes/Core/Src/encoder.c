@@ -21,54 +21,107 @@
 #include "stm32f4xx_hal.h"
 #include "config.h"
 #include "links.h"
+#include "sections.h"
+#include "cycles.h"
+#include "pipeline.h"
+#include "codec.h"
+#include "vad.h"
+#include "comfort.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#if (CONGESTION_ADAPTATION == 1)
+#if (CONGESTION_LOW >= CONGESTION_HIGH) || (CONGESTION_HIGH >= TX_BUFFER_SIZE)
+#error "CONGESTION_LOW should be below CONGESTION_HIGH, itself below TX_BUFFER_SIZE"
+#endif
 
 /* Private variables ---------------------------------------------------------*/
 
-struct sampleStream_Info * ADC_stream;
-struct bitStream_Info * UART_stream;
-uint16_t maskSample;
+// Codecs used by CODEC_PCM under congestion, one step after another
+static const uint8_t congestionCodecs[] = { CODEC_PCM10, CODEC_PCM8 };
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
 
-static uint64_t mask(uint8_t bits);
-static HAL_StatusTypeDef sendTrueByte(uint8_t byte);
-static HAL_StatusTypeDef sendByte(uint8_t byte, uint8_t LSB);
-static uint64_t getSample();
-static void nextSample();
-static uint8_t sampleAvailable();
-static HAL_StatusTypeDef sendSyncSignal();
+static HAL_StatusTypeDef sendTrueByte(struct encoder_Info * encoder, uint8_t byte);
+static HAL_StatusTypeDef sendByte(struct encoder_Info * encoder, uint8_t byte, uint8_t mask);
+static HAL_StatusTypeDef encodeSamples(struct encoder_Info * encoder, const uint16_t * samples);
+static HAL_StatusTypeDef flushBits(struct encoder_Info * encoder);
+static HAL_StatusTypeDef sendSyncSignal(struct encoder_Info * encoder);
+static HAL_StatusTypeDef sendSilence(struct encoder_Info * encoder);
+static uint8_t adaptDepth(struct encoder_Info * encoder);
 
 /* Exported functions --------------------------------------------------------*/
 
 /**
  * @brief initializes a stream (an auto-completing bitStream according to a sampleStream)
  * 
+ * The stream starts with a synchronization signal, followed by the codec id.
+ * If DTX is 1, silent frames aren't sent (see vad.c).
+ *
+ * @param encoder[IN] pointer to the encoder_Info structure, used as a handle by other encoder functions
  * @param sampleStream[IN] pointer to the sampleStream_Info structure
  * @param bitStream[IN] pointer to the bitStream_Info structure
- * @return HAL status (HAL_OK if no errors occured).
+ * @return HAL status (HAL_ERROR if CODEC doesn't exist).
  */
-HAL_StatusTypeDef encoder_streamStart(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream)
+HAL_StatusTypeDef encoder_streamStart(struct encoder_Info * encoder, struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream)
 {
-	ADC_stream = sampleStream;
-	UART_stream = bitStream;
+	HAL_StatusTypeDef status;
 
-	maskSample = mask(WORD_LENGTH);
+	if ((encoder == NULL) || (sampleStream == NULL) || (bitStream == NULL))
+	{
+		return HAL_ERROR;
+	}
 
-	ADC_stream->state = ACTIVE;
-	UART_stream->state = ACTIVE;
+	status = pipeline_Start(&(encoder->pipeline), pipeline_emitterStages);
+	if (status != HAL_OK)
+	{
+		return status;
+	}
 
-	return sendSyncSignal();
+	encoder->codec = codec_Find(CODEC);
+	if ((encoder->codec == NULL) || (FRAME_SIZE % encoder->codec->samplesPerCode != 0))
+	{
+		return HAL_ERROR;
+	}
+
+	if (encoder->codec->reset != NULL)
+	{
+		encoder->codec->reset(encoder->codecState);
+	}
+
+	encoder->ADC_stream = sampleStream;
+	encoder->UART_stream = bitStream;
+	encoder->accumulator = 0;
+	encoder->bits = 0;
+	encoder->dropping = 0;
+	encoder->silentFrames = 0;
+	encoder->congestion = 0;
+	encoder->clearFrames = 0;
+	encoder->lastWaiting = 0;
+	vad_Start(&(encoder->vad));
+
+	Cycles_Init();
+	Cycles_Reset(&(encoder->cycles));
+
+	sampleStream->state = ACTIVE;
+	bitStream->state = ACTIVE;
+
+	return sendSyncSignal(encoder);
 }
 
 /**
  * @brief starts a stream without overwriting existing parameters.
  * 
+ * @param encoder[IN] pointer to the encoder_Info structure given to encoder_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  * @warning encoder_streamStart() must be called at least once before to
  * calling encoder_streamRestart()
  */
-HAL_StatusTypeDef encoder_streamRestart()
+HAL_StatusTypeDef encoder_streamRestart(struct encoder_Info * encoder)
 {
+	struct sampleStream_Info * ADC_stream = encoder->ADC_stream;
+	struct bitStream_Info * UART_stream = encoder->UART_stream;
 	/* Check that the parameters already exists 
 	 * (ie encoder_streamStart() was called before)
 	 */
@@ -79,24 +132,35 @@ HAL_StatusTypeDef encoder_streamRestart()
 	
 	ADC_stream->state = ACTIVE;
 	UART_stream->state = ACTIVE;
+	encoder->pipeline.length = 0;
+	encoder->dropping = 0;
+	encoder->silentFrames = 0;
 
-	return sendSyncSignal();
+	return sendSyncSignal(encoder);
 }
 
 /**
  * @brief updates the streams structures fields : take data from ADC buffer to put it into the UART buffer
  * 
+ * Samples are gathered in the frame of the pipeline. Every time it is full,
+ * the emitter stages process it and the whole frame is encoded. If DTX is 1,
+ * silent frames are replaced by a silence descriptor every DTX_KEEPALIVE_PERIOD
+ * frames, the first one included. If CONGESTION_ADAPTATION is 1, the bits
+ * per sample of CODEC_PCM follow the backlog of the UART buffer.
+ * 
+ * @param encoder[IN] pointer to the encoder_Info structure given to encoder_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  * @note should be called at the end of a ADC buffer update to update the UART buffer
  */
-HAL_StatusTypeDef encoder_streamUpdate()
+RAMFUNC HAL_StatusTypeDef encoder_streamUpdate(struct encoder_Info * encoder)
 {
+	struct sampleStream_Info * ADC_stream = encoder->ADC_stream;
+	struct bitStream_Info * UART_stream = encoder->UART_stream;
+	struct pipeline_Info * pipeline = &(encoder->pipeline);
 	HAL_StatusTypeDef status = HAL_OK;
-	uint8_t bit;
-	uint8_t bit_value;
-	uint8_t byte;
-	uint8_t LSB;
-	uint64_t sample;
+	uint16_t count;
+	uint16_t i;
+	uint8_t changed;
 	
 	/* Check that the parameters already exists 
 	 * (ie encoder_streamStart() was called before)
@@ -111,93 +175,76 @@ HAL_StatusTypeDef encoder_streamUpdate()
 		return HAL_BUSY;
 	}
 
-	uint64_t debug = 0;
-	while(sampleAvailable())
+	Cycles_Start(&(encoder->cycles));
+
+	do
 	{
-		debug++;
-		sample = getSample();
+		count = ring_Read(&(ADC_stream->ring), &(pipeline->frame[pipeline->length]), FRAME_SIZE - pipeline->length);
+		pipeline->length += count;
 
-		while (WORD_LENGTH - ADC_stream->bitsOut >= 8)
+		if (pipeline->length == FRAME_SIZE)
 		{
-			// We can fill a full uint8_t with the last new sample
-			byte = 0;
+			status = pipeline_Process(pipeline);
 
-			for(bit = 0; bit < 8; bit++)
+#if (DTX == 1)
+			if ((status == HAL_OK) && (vad_Process(&(encoder->vad), pipeline->frame) == 0))
 			{
-				bit_value = (sample & (0x01 << (WORD_LENGTH - 1 - ADC_stream->bitsOut))) >> (WORD_LENGTH - 1 - ADC_stream->bitsOut);
-				byte += bit_value << (8 - bit);
-				ADC_stream->bitsOut += 1;
+				if ((encoder->silentFrames == 0) || (encoder->silentFrames >= DTX_KEEPALIVE_PERIOD))
+				{
+					encoder->silentFrames = 0;
+					status = sendSilence(encoder);
+				}
+				encoder->silentFrames += 1;
+				pipeline->length = 0;
+				continue;
 			}
+#endif
 
-			// LSB = 7 because considered byte is fully inside a sample
-			LSB = 8 - 1;
-			status = sendByte(byte, LSB);
-			if (status != HAL_OK)
-			{
-				return status;
-			}
-		}
+			changed = adaptDepth(encoder);
 
-		// Check if the above process encoded an entire sample
-		if (WORD_LENGTH <= ADC_stream->bitsOut)
-		{
-			nextSample();
-			if (UART_stream->bytesSinceLastSyncSignal + 1 >= SYNC_PERIOD)
+			// After an overrun, a silence or a change of codec, the receiver is synchronized again before the frame
+			if ((status == HAL_OK) && (encoder->dropping || (encoder->silentFrames != 0) || changed))
 			{
-				status = sendSyncSignal();
-				if (status != HAL_OK)
+				if (encoder->dropping)
 				{
-					return status;
+					// The last bits belong to the frame lost by the overrun: not flushed
+					encoder->bits = 0;
 				}
+				encoder->dropping = 0;
+				encoder->silentFrames = 0;
+				status = sendSyncSignal(encoder);
 			}
-		}
-		// Check if we can complete a byte using next sample
-		else if (sampleAvailable())
-		{
-			// Start to fill the byte with the lasts bits of selected sample
-			byte = 0;
-			bit = 0;
 
-			while(WORD_LENGTH > ADC_stream->bitsOut)
+			for (i = 0; (i < FRAME_SIZE) && (status == HAL_OK); i += encoder->codec->samplesPerCode)
 			{
-				bit_value = (sample & (0x01 << (WORD_LENGTH - 1 - ADC_stream->bitsOut))) >> (WORD_LENGTH - 1 - ADC_stream->bitsOut);
-				byte += bit_value << (8 - bit);
-				ADC_stream->bitsOut += 1;
-				bit += 1;
+				status = encodeSamples(encoder, &(pipeline->frame[i]));
 			}
 
-			// Now we continue the same process with next sample
-			LSB = bit;
-			nextSample();
-			sample = getSample();
+			pipeline->length = 0;
+		}
+	} while ((count != 0) && (status == HAL_OK));
 
-			while(bit < 8)
-			{
-				bit_value = (sample & (0x01 << (WORD_LENGTH - 1 - ADC_stream->bitsOut))) >> (WORD_LENGTH - 1 - ADC_stream->bitsOut);
-				byte += bit_value << (8 - bit);
-				ADC_stream->bitsOut += 1;
-				bit += 1;
-			}
+	Cycles_Stop(&(encoder->cycles));
 
-			status = sendByte(byte, LSB);
-			if (status != HAL_OK)
-			{
-				return status;
-			}
-		}
+	if (status != HAL_OK)
+	{
+		return status;
 	}
 
-	encode_FinishedHandle();
+	encode_FinishedHandle(UART_stream);
 	return HAL_OK;
 }
 
 /**
  * @brief stops a running stream.
  * 
+ * @param encoder[IN] pointer to the encoder_Info structure given to encoder_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef encoder_streamStop()
+HAL_StatusTypeDef encoder_streamStop(struct encoder_Info * encoder)
 {
+	struct sampleStream_Info * ADC_stream = encoder->ADC_stream;
+	struct bitStream_Info * UART_stream = encoder->UART_stream;
 	/* Check that the parameters already exists 
 	 * (ie encoder_streamStart() was called before)
 	 */
@@ -213,191 +260,328 @@ HAL_StatusTypeDef encoder_streamStop()
 }
 
 /**
- * @brief checks if sample is available
+ * @brief gives the CPU cost of the encoder
  * 
- * @return 1 if a sample is available 0 else
+ * @param encoder[IN] pointer to the encoder_Info structure given to encoder_streamStart
+ * @return pointer to the measurements of encoder_streamUpdate duration (CPU cycles per call)
  */
-static uint8_t sampleAvailable()
+const struct cycles_Info * encoder_getCycles(struct encoder_Info * encoder)
 {
-	/* Check that the parameters already exists 
-	 * (ie encoder_streamStart() was called before)
-	 */
-	if (ADC_stream == NULL)
-	{
-		return 0;
-	}
-	
-	if (ADC_stream->lastSampleIn != ADC_stream->lastSampleOut)
-	{
-		return 1;
-	}
-	else
-	{
-		return 0;
-	}
+	return &(encoder->cycles);
 }
 
 /**
- * @brief changes ADC_stream metadata to consider a new sample (the next one)
+ * @brief encodes samples, appends the code to the bit accumulator and sends every completed byte
+ * 
+ * Codes are sent MSB first, one directly after another. A synchronization
+ * signal is sent when a code ends on a byte boundary and SYNC_PERIOD bytes
+ * were sent since the last one.
+ * Bits of variable-length codes are never modified: a byte whose 7 MSBs
+ * are the ones of SYNC_SIGNAL only carries these 7 bits, its LSB is stuffed
+ * (the opposite of the LSB of SYNC_SIGNAL) and the decoder drops it.
+ * 
+ * @param encoder[IN] pointer to the encoder_Info structure
+ * @param samples[IN] samplesPerCode samples of the codec (SAMPLE_SIZE LSBs)
+ * @return HAL status (HAL_OK if no errors occured).
  */
-static void nextSample()
+static RAMFUNC HAL_StatusTypeDef encodeSamples(struct encoder_Info * encoder, const uint16_t * samples)
 {
-	/* Check that the parameters already exists 
-	 * (ie encoder_streamStart() was called before)
-	 */
-	if (ADC_stream != NULL)
+	uint8_t codeBits = encoder->codec->codeBits;
+	uint32_t code = encoder->codec->encode(encoder->codecState, samples);
+	HAL_StatusTypeDef status;
+	uint8_t byte;
+	uint8_t mask;
+
+	if (codeBits == 0)
+	{
+		// Variable-length code: the marker bit gives its width
+		codeBits = 31 - __CLZ(code);
+		code ^= (uint32_t)1 << codeBits;
+	}
+
+	encoder->accumulator = (encoder->accumulator << codeBits) | code;
+	encoder->bits += codeBits;
+
+	while (encoder->bits >= 8)
 	{
-		ADC_stream->lastSampleOut += 1;
-		if (ADC_stream->lastSampleOut >= ADC_stream->length)
+		encoder->bits -= 8;
+		byte = (uint8_t)(encoder->accumulator >> encoder->bits);
+
+		if (encoder->codec->codeBits == 0)
 		{
-			ADC_stream->lastSampleOut = 0;
+			if ((byte >> 1) == (SYNC_SIGNAL >> 1))
+			{
+				// Stuffed LSB, the last bit is sent in the next byte
+				byte = SYNC_SIGNAL ^ 0x01;
+				encoder->bits += 1;
+			}
+
+			status = sendTrueByte(encoder, byte);
+			if (status != HAL_OK)
+			{
+				return status;
+			}
+			continue;
 		}
-		ADC_stream->bitsOut = 0;
+
+		/*
+		 * If the byte has to be modified, toggle the LSB of a code ending in it
+		 * (this code if it ends the byte, else the previous one), or the LSB
+		 * of the byte if no code ends in it. Codecs with a state never give
+		 * such a byte.
+		 */
+		if ((encoder->bits != 0) && (encoder->bits + 8 > codeBits) && (encoder->bits <= codeBits))
+		{
+			mask = 1 << (codeBits - encoder->bits);
+		}
+		else
+		{
+			mask = 0x01;
+		}
+
+		status = sendByte(encoder, byte, mask);
+		if (status != HAL_OK)
+		{
+			return status;
+		}
+	}
+
+	if ((encoder->bits == 0) && (encoder->bytesSinceLastSyncSignal + 1 >= SYNC_PERIOD))
+	{
+		return sendSyncSignal(encoder);
 	}
+
+	return HAL_OK;
 }
 
 /**
- * @brief returns the value of the next sample to encode
+ * @brief saves a byte into the UART buffer without modifying data
  * 
- * @return the sample, as a uint64 number. 0xFFFFFFFFFFFFFFFF in case of error
+ * If the buffer is full, this byte and the following ones are dropped until
+ * the next frame, which starts with a synchronization signal.
+ * 
+ * @param encoder[IN] pointer to the encoder_Info structure
+ * @param byte[IN] the data to save into the buffer
+ * @return HAL status (HAL_OK if no errors occured).
  */
-static uint64_t getSample()
+static RAMFUNC HAL_StatusTypeDef sendTrueByte(struct encoder_Info * encoder, uint8_t byte)
 {
+	struct bitStream_Info * UART_stream = encoder->UART_stream;
 	/* Check that the parameters already exists 
 	 * (ie encoder_streamStart() was called before)
 	 */
-	if (ADC_stream == NULL)
+	if (UART_stream == NULL)
 	{
-		return 0xFFFFFFFFFFFFFFFF;
+		return HAL_ERROR;
 	}
-	
-	if (ADC_stream->lastSampleOut + 1 < ADC_stream->length)
+
+	if (encoder->dropping)
 	{
-		return ((ADC_stream->stream)[1 + ADC_stream->lastSampleOut]) & maskSample;
+		// Waiting for the next frame
+		return HAL_OK;
 	}
-	else
+
+	if (ring_Write(&(UART_stream->ring), &byte, 1) == 0)
 	{
-		return ((ADC_stream->stream)[1 + ADC_stream->lastSampleOut - ADC_stream->length]) & maskSample;
+		// Overrun (UART too slow): the rest of the frame is dropped
+		encoder->dropping = 1;
+		Stream_ErrorHandle(UART_stream, BUFFER_OVERRUN);
+		return HAL_OK;
 	}
+
+	encoder->bytesSinceLastSyncSignal += 1;
+	return HAL_OK;
 }
 
 /**
- * @brief saves a byte into the UART buffer without modifying data
+ * @brief saves a byte into the UART buffer, but toggles one bit if byte == SYNC_SIGNAL
  * 
+ * @param encoder[IN] pointer to the encoder_Info structure
  * @param byte[IN] the data to save into the buffer
+ * @param mask[IN] the bit to toggle (preferably the least significant bit of a sample)
  * @return HAL status (HAL_OK if no errors occured).
  */
-static HAL_StatusTypeDef sendTrueByte(uint8_t byte)
+static RAMFUNC HAL_StatusTypeDef sendByte(struct encoder_Info * encoder, uint8_t byte, uint8_t mask)
 {
-	/* Check that the parameters already exists 
-	 * (ie encoder_streamStart() was called before)
-	 */
-	if (UART_stream == NULL)
+	if (byte == SYNC_SIGNAL)
 	{
-		return HAL_ERROR;
+		byte ^= mask;
 	}
 
-	UART_stream->lastByteIn += 1;
-	if (UART_stream->lastByteIn >= UART_stream->length)
+	return sendTrueByte(encoder, byte);
+}
+
+/**
+ * @brief sends the bits of the accumulator that weren't sent yet, padded with ones to a whole byte
+ * 
+ * Used before a synchronization signal, which drops the bits the decoder
+ * didn't use yet. Up to 7 ones never complete a code, whatever the codec:
+ * the padding is dropped, and the last code is decoded. The padded byte is
+ * stuffed like in encodeSamples, its 7 MSBs are enough to carry the bits.
+ * 
+ * @param encoder[IN] pointer to the encoder_Info structure
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+static RAMFUNC HAL_StatusTypeDef flushBits(struct encoder_Info * encoder)
+{
+	uint8_t byte;
+
+	if (encoder->bits == 0)
 	{
-		UART_stream->lastByteIn = 0;
+		return HAL_OK;
 	}
 
-	if (UART_stream->lastByteIn == UART_stream->lastByteOut)
+	byte = (uint8_t)((encoder->accumulator << (8 - encoder->bits)) | ((1 << (8 - encoder->bits)) - 1));
+	if ((byte >> 1) == (SYNC_SIGNAL >> 1))
 	{
-		// Overrun error (UART too slow)
-		return HAL_ERROR;
+		byte = SYNC_SIGNAL ^ 0x01;
 	}
 
-	UART_stream->stream[UART_stream->lastByteIn] = byte;
-	UART_stream->bytesSinceLastSyncSignal += 1;
-	return HAL_OK;
+	encoder->accumulator = 0;
+	encoder->bits = 0;
+	return sendTrueByte(encoder, byte);
 }
 
 /**
- * @brief saves a byte into the UART buffer, but toggles the LSB if byte == SYNC_SIGNAL
+ * @brief sends a synchronization byte instead of real data, then the codec id and header
+ * Bits of the current code that weren't sent yet are flushed before (see
+ * flushBits): after the header, the next bit is always the MSB of a code.
  * 
- * @param byte[IN] the data to save into the buffer
- * @param LSB[IN] the position of the least significant bit (between 0 and 7)
+ * @param encoder[IN] pointer to the encoder_Info structure
  * @return HAL status (HAL_OK if no errors occured).
  */
-static HAL_StatusTypeDef sendByte(uint8_t byte, uint8_t LSB)
-{
-	uint8_t mask;
+static RAMFUNC HAL_StatusTypeDef sendSyncSignal(struct encoder_Info * encoder) {
+	const struct codec_Info * codec = encoder->codec;
+	HAL_StatusTypeDef status = HAL_OK;
+	uint8_t header[CODEC_HEADER_SIZE];
+	uint8_t i;
 
-	if (LSB >= 8)
+	status = flushBits(encoder);
+	if (status != HAL_OK)
 	{
-		// Default value in case of error:
-		LSB = 8 - 1;
+		return status;
 	}
 
-	mask = 0x80 >> LSB;
+	status = sendTrueByte(encoder, SYNC_SIGNAL);
+	if (status != HAL_OK)
+	{
+		return status;
+	}
 
-	if (byte == SYNC_SIGNAL)
+	encoder->bytesSinceLastSyncSignal = 0;
+
+	status = sendTrueByte(encoder, codec->id);
+	if ((status != HAL_OK) || (codec->headerSize == 0))
 	{
-		if (byte & mask)
+		return status;
+	}
+
+	codec->getHeader(encoder->codecState, header);
+	for (i = 0; (i < codec->headerSize) && (status == HAL_OK); i++)
+	{
+		status = sendTrueByte(encoder, header[i]);
+	}
+
+	return status;
+}
+
+/**
+ * @brief removes or gives back 2 bits per sample, from the backlog of the UART buffer
+ *
+ * A step is removed when the bytes waiting in the UART buffer reach
+ * CONGESTION_HIGH and grew since the last frame (the link is slower than the
+ * codec), and given back once they stayed at most CONGESTION_LOW during
+ * CONGESTION_RECOVERY frames. The new codec is selected before the frame:
+ * its id follows the synchronization signal, the decoder follows it.
+ * Only CODEC_PCM has steps.
+ *
+ * @param encoder[IN] pointer to the encoder_Info structure
+ * @return 1 if the codec changed, 0 otherwise
+ */
+static RAMFUNC uint8_t adaptDepth(struct encoder_Info * encoder)
+{
+#if (CONGESTION_ADAPTATION == 1)
+	uint16_t waiting = ring_Count(&(encoder->UART_stream->ring));
+	uint8_t step = encoder->congestion;
+
+	if ((step == 0) && (encoder->codec->id != CODEC_PCM))
+	{
+		return 0;
+	}
+
+	if ((waiting >= CONGESTION_HIGH) && (waiting > encoder->lastWaiting))
+	{
+		if (step < sizeof(congestionCodecs))
 		{
-			// byte's LSB is a 1
-			byte &= ~mask;
+			step += 1;
 		}
-		else
+		encoder->clearFrames = 0;
+	}
+	else if (waiting <= CONGESTION_LOW)
+	{
+		encoder->clearFrames += 1;
+		if ((encoder->clearFrames >= CONGESTION_RECOVERY) && (step > 0))
 		{
-			// byte's LSB is a 0
-			byte |= mask;
+			step -= 1;
+			encoder->clearFrames = 0;
 		}
 	}
+	else
+	{
+		encoder->clearFrames = 0;
+	}
+	encoder->lastWaiting = waiting;
 
-	return sendTrueByte(byte);
+	if (step == encoder->congestion)
+	{
+		return 0;
+	}
+
+	encoder->congestion = step;
+	encoder->codec = codec_Find((step == 0) ? CODEC_PCM : congestionCodecs[step - 1]);
+	return 1;
+#else
+	return 0;
+#endif
 }
 
 /**
- * @brief sends a synchronization byte instead of real data
+ * @brief sends a synchronization byte, then a silence descriptor instead of a frame
+ * Bits of the current code that weren't sent yet are flushed before, like in sendSyncSignal.
  * 
+ * @param encoder[IN] pointer to the encoder_Info structure
  * @return HAL status (HAL_OK if no errors occured).
  */
-static HAL_StatusTypeDef sendSyncSignal() {
-	/* Check that the parameters already exists 
-	 * (ie encoder_streamStart() was called before)
-	 */
-	if ((UART_stream == NULL) || (ADC_stream == NULL))
-	{
-		return HAL_ERROR;
-	}
-	
+static RAMFUNC HAL_StatusTypeDef sendSilence(struct encoder_Info * encoder)
+{
 	HAL_StatusTypeDef status = HAL_OK;
+	uint8_t descriptor[COMFORT_DESCRIPTOR_SIZE];
+	uint8_t i;
 
-	status = sendTrueByte(SYNC_SIGNAL);
+	// Not sent after an overrun: the frame they belong to is already lost
+	status = flushBits(encoder);
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	if (ADC_stream->bitsOut != 0)
+	// Descriptors are short: sent even after an overrun
+	encoder->dropping = 0;
+
+	status = sendTrueByte(encoder, SYNC_SIGNAL);
+	if (status != HAL_OK)
 	{
-		nextSample();
+		return status;
 	}
-	UART_stream->bytesSinceLastSyncSignal = 0;
 
-	return HAL_OK;
-}
-
-/**
- * @brief creates a number in which n LSBs are ones
- * For example 00011111 in binary if n = 5
- * 
- * @param bits[IN] the number of ones
- * @return the mask
- */
-static uint64_t mask(uint8_t bits)
-{
-	uint8_t bit;
-	uint64_t mask_var = 0;
+	encoder->bytesSinceLastSyncSignal = 0;
 
-	for (bit = 0; bit < bits; bit++)
+	status = sendTrueByte(encoder, CODEC_SILENCE);
+	vad_getDescriptor(&(encoder->vad), descriptor);
+	for (i = 0; (i < COMFORT_DESCRIPTOR_SIZE) && (status == HAL_OK); i++)
 	{
-		mask_var <<= 1;
-		mask_var += 1;
+		status = sendTrueByte(encoder, descriptor[i]);
 	}
 
-	return mask_var;
+	return status;
 }
@@ -0,0 +1,129 @@
+/**
+  ******************************************************************************
+  * @file           : filter.c
+  * @brief          : Speech filters
+  *
+  * First emitter stage and receiver stage, each one a cascade of biquads
+  * (see biquad.c). Both ends remove the DC offset of the analog front end
+  * with a high-pass filter, before it biases the levels measured by the
+  * emitter stages and the VAD, or reaches the DAC. With SPEECH_EMPHASIS,
+  * the emitter boosts frequencies above 2kHz (high shelf, +6dB) before
+  * encoding, and the receiver applies the exact inverse filter after
+  * decoding: speech comes out unchanged, while the noise added by the codec
+  * is cut by up to 6dB where speech is weakest.
+  * Sections are listed in the tables below: edit them to change the
+  * shaping (BIQUAD_MAX_SECTIONS per end at most).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "filter.h"
+#include "biquad.h"
+#include "sections.h"
+
+#if (SPEECH_FILTER == 1)
+
+/* Private defines -----------------------------------------------------------*/
+
+/*
+ * Sections (b0, b1, b2, -a1, -a2 in Q30), from the formulas of the Audio EQ
+ * Cookbook (R. Bristow-Johnson), at each supported sampling frequency.
+ */
+
+#if (SAMPLING_FREQUENCY == 12000)
+
+// High-pass at 60Hz (Butterworth, -31dB at 10Hz, -0.5dB at 100Hz): b1 = -2 * b0 exactly, no gain at DC
+#define DC_BLOCK 1050152231, -2100304462, 1050152231, 2099786147, -1027080952
+
+// High shelf at 2kHz, +6dB (slope 1): +3dB at 2kHz, +5.9dB at 4kHz
+#define PRE_EMPHASIS 1687568015, -1340974611, 481779080, 465477970, -220108631
+
+// Inverse of PRE_EMPHASIS (its zeros are inside the unit circle): -6dB shelf
+#define DE_EMPHASIS 683185208, -296167716, 140047595, 853216292, -306539555
+
+#elif (SAMPLING_FREQUENCY == 16000)
+
+// High-pass at 60Hz (Butterworth, -31dB at 10Hz, -0.5dB at 100Hz): b1 = -2 * b0 exactly, no gain at DC
+#define DC_BLOCK 1056000606, -2112001212, 1056000606, 2111708058, -1038552543
+
+// High shelf at 2kHz, +6dB (slope 1): +3dB at 2kHz, +5.8dB at 4kHz, +6dB at 7kHz
+#define PRE_EMPHASIS 1784086262, -1941823148, 694680748, 839299745, -302501783
+
+// Inverse of PRE_EMPHASIS (its zeros are inside the unit circle): -6dB shelf
+#define DE_EMPHASIS 646225202, -505127616, 182058919, 1168674841, -418089522
+
+#else
+#error "Sections below are designed for SAMPLING_FREQUENCY = 12000 or 16000: set SPEECH_FILTER to 0"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+static const int32_t emitterSections[] =
+{
+	DC_BLOCK,
+#if (SPEECH_EMPHASIS == 1)
+	PRE_EMPHASIS,
+#endif
+};
+
+static const int32_t receiverSections[] =
+{
+	DC_BLOCK,
+#if (SPEECH_EMPHASIS == 1)
+	DE_EMPHASIS,
+#endif
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief resets the filters of the emitter
+ *
+ * @param state[IN] pointer to a biquad_Info structure
+ * @return HAL status (HAL_ERROR if the table has more than BIQUAD_MAX_SECTIONS sections)
+ */
+HAL_StatusTypeDef filter_StartEmitter(void * state)
+{
+	return biquad_Init(state, emitterSections, sizeof(emitterSections) / (BIQUAD_COEFFICIENTS * sizeof(int32_t)));
+}
+
+/**
+ * @brief resets the filters of the receiver
+ *
+ * @param state[IN] pointer to a biquad_Info structure
+ * @return HAL status (HAL_ERROR if the table has more than BIQUAD_MAX_SECTIONS sections)
+ */
+HAL_StatusTypeDef filter_StartReceiver(void * state)
+{
+	return biquad_Init(state, receiverSections, sizeof(receiverSections) / (BIQUAD_COEFFICIENTS * sizeof(int32_t)));
+}
+
+/**
+ * @brief filters a frame
+ *
+ * @param state[IN] pointer to the biquad_Info structure given to filter_StartEmitter or filter_StartReceiver
+ * @param frame[IN] samples (SAMPLE_SIZE bits, centered on 0), filtered in place
+ * @param length[IN] number of samples
+ * @return HAL status (always HAL_OK)
+ */
+RAMFUNC HAL_StatusTypeDef filter_Process(void * state, int16_t * frame, uint16_t length)
+{
+	biquad_Process(state, frame, length);
+	return HAL_OK;
+}
+
+#endif /* SPEECH_FILTER == 1 */
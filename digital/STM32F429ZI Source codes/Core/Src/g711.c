@@ -0,0 +1,240 @@
+/**
+  ******************************************************************************
+  * @file           : g711.c
+  * @brief          : G.711 mu-law and A-law codecs
+  *
+  * Each sample is compressed to one byte: a sign, a segment (3 bits, the
+  * position of the most significant bit) and 4 bits below it. Small samples
+  * keep a fine resolution, large ones a coarse one, for a roughly constant
+  * signal to noise ratio. Codes are byte-aligned and independent: a lost
+  * byte only costs one sample.
+  * Samples are scaled to 16 bits. The segment is found with one CLZ
+  * instruction, codes are expanded by tables of 256 samples.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "g711.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SAMPLE_OFFSET (1 << (SAMPLE_SIZE - 1))   // Mid-scale, 0 once centered
+#define SAMPLE_SHIFT (16 - SAMPLE_SIZE)          // Samples are scaled to 16 bits
+#define SEGMENTS 8
+#define MULAW_BIAS 0x84
+#define MULAW_CLIP 8159                          // Largest magnitude, 14 bits
+#define MULAW_SEGMENT_BIT 5                      // MSB of biased magnitudes of segment 0 (at least 0x21)
+#define ALAW_SEGMENT_BIT 4                       // MSB of the largest magnitudes of segment 0 (0x10 to 0x1F)
+
+#if (SAMPLE_SIZE > 16)
+#error "SAMPLE_SIZE should not be above 16"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+// Sample of each code (16 bits)
+static const int16_t muLawSamples[256] =
+{
+	-32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956,
+	-23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764,
+	-15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412,
+	-11900, -11388, -10876, -10364, -9852, -9340, -8828, -8316,
+	-7932, -7676, -7420, -7164, -6908, -6652, -6396, -6140,
+	-5884, -5628, -5372, -5116, -4860, -4604, -4348, -4092,
+	-3900, -3772, -3644, -3516, -3388, -3260, -3132, -3004,
+	-2876, -2748, -2620, -2492, -2364, -2236, -2108, -1980,
+	-1884, -1820, -1756, -1692, -1628, -1564, -1500, -1436,
+	-1372, -1308, -1244, -1180, -1116, -1052, -988, -924,
+	-876, -844, -812, -780, -748, -716, -684, -652,
+	-620, -588, -556, -524, -492, -460, -428, -396,
+	-372, -356, -340, -324, -308, -292, -276, -260,
+	-244, -228, -212, -196, -180, -164, -148, -132,
+	-120, -112, -104, -96, -88, -80, -72, -64,
+	-56, -48, -40, -32, -24, -16, -8, 0,
+	32124, 31100, 30076, 29052, 28028, 27004, 25980, 24956,
+	23932, 22908, 21884, 20860, 19836, 18812, 17788, 16764,
+	15996, 15484, 14972, 14460, 13948, 13436, 12924, 12412,
+	11900, 11388, 10876, 10364, 9852, 9340, 8828, 8316,
+	7932, 7676, 7420, 7164, 6908, 6652, 6396, 6140,
+	5884, 5628, 5372, 5116, 4860, 4604, 4348, 4092,
+	3900, 3772, 3644, 3516, 3388, 3260, 3132, 3004,
+	2876, 2748, 2620, 2492, 2364, 2236, 2108, 1980,
+	1884, 1820, 1756, 1692, 1628, 1564, 1500, 1436,
+	1372, 1308, 1244, 1180, 1116, 1052, 988, 924,
+	876, 844, 812, 780, 748, 716, 684, 652,
+	620, 588, 556, 524, 492, 460, 428, 396,
+	372, 356, 340, 324, 308, 292, 276, 260,
+	244, 228, 212, 196, 180, 164, 148, 132,
+	120, 112, 104, 96, 88, 80, 72, 64,
+	56, 48, 40, 32, 24, 16, 8, 0
+};
+
+static const int16_t aLawSamples[256] =
+{
+	-5504, -5248, -6016, -5760, -4480, -4224, -4992, -4736,
+	-7552, -7296, -8064, -7808, -6528, -6272, -7040, -6784,
+	-2752, -2624, -3008, -2880, -2240, -2112, -2496, -2368,
+	-3776, -3648, -4032, -3904, -3264, -3136, -3520, -3392,
+	-22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
+	-30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+	-11008, -10496, -12032, -11520, -8960, -8448, -9984, -9472,
+	-15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+	-344, -328, -376, -360, -280, -264, -312, -296,
+	-472, -456, -504, -488, -408, -392, -440, -424,
+	-88, -72, -120, -104, -24, -8, -56, -40,
+	-216, -200, -248, -232, -152, -136, -184, -168,
+	-1376, -1312, -1504, -1440, -1120, -1056, -1248, -1184,
+	-1888, -1824, -2016, -1952, -1632, -1568, -1760, -1696,
+	-688, -656, -752, -720, -560, -528, -624, -592,
+	-944, -912, -1008, -976, -816, -784, -880, -848,
+	5504, 5248, 6016, 5760, 4480, 4224, 4992, 4736,
+	7552, 7296, 8064, 7808, 6528, 6272, 7040, 6784,
+	2752, 2624, 3008, 2880, 2240, 2112, 2496, 2368,
+	3776, 3648, 4032, 3904, 3264, 3136, 3520, 3392,
+	22016, 20992, 24064, 23040, 17920, 16896, 19968, 18944,
+	30208, 29184, 32256, 31232, 26112, 25088, 28160, 27136,
+	11008, 10496, 12032, 11520, 8960, 8448, 9984, 9472,
+	15104, 14592, 16128, 15616, 13056, 12544, 14080, 13568,
+	344, 328, 376, 360, 280, 264, 312, 296,
+	472, 456, 504, 488, 408, 392, 440, 424,
+	88, 72, 120, 104, 24, 8, 56, 40,
+	216, 200, 248, 232, 152, 136, 184, 168,
+	1376, 1312, 1504, 1440, 1120, 1056, 1248, 1184,
+	1888, 1824, 2016, 1952, 1632, 1568, 1760, 1696,
+	688, 656, 752, 720, 560, 528, 624, 592,
+	944, 912, 1008, 976, 816, 784, 880, 848
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint8_t findSegment(uint16_t magnitude, uint8_t firstBit);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief gives the mu-law code of a sample
+ *
+ * @param state[IN] unused (stateless codec)
+ * @param samples[IN] the sample (SAMPLE_SIZE LSBs)
+ * @return the code (8 LSBs)
+ */
+RAMFUNC uint32_t g711_encodeMuLaw(void * state, const uint16_t * samples)
+{
+	int32_t sample = (((int32_t)samples[0] - SAMPLE_OFFSET) << SAMPLE_SHIFT) >> 2;
+	uint8_t mask = 0xFF;
+	uint8_t segment;
+
+	if (sample < 0)
+	{
+		sample = -sample;
+		mask = 0x7F;
+	}
+	if (sample > MULAW_CLIP)
+	{
+		sample = MULAW_CLIP;
+	}
+	sample += MULAW_BIAS >> 2;
+
+	segment = findSegment((uint16_t)sample, MULAW_SEGMENT_BIT);
+	if (segment >= SEGMENTS)
+	{
+		return 0x7F ^ mask;
+	}
+	return (uint8_t)(((segment << 4) | ((sample >> (segment + 1)) & 0x0F)) ^ mask);
+}
+
+/**
+ * @brief gives the sample of a mu-law code
+ *
+ * @param state[IN] unused (stateless codec)
+ * @param code[IN] the code (8 LSBs)
+ * @param samples[OUT] the sample (SAMPLE_SIZE LSBs)
+ */
+RAMFUNC void g711_decodeMuLaw(void * state, uint32_t code, uint16_t * samples)
+{
+	// Rounded towards 0, like the magnitudes of the encoder: a shift would put negative samples one step further
+	samples[0] = (uint16_t)((muLawSamples[code & 0xFF] / (1 << SAMPLE_SHIFT)) + SAMPLE_OFFSET);
+}
+
+/**
+ * @brief gives the A-law code of a sample
+ *
+ * @param state[IN] unused (stateless codec)
+ * @param samples[IN] the sample (SAMPLE_SIZE LSBs)
+ * @return the code (8 LSBs)
+ */
+RAMFUNC uint32_t g711_encodeALaw(void * state, const uint16_t * samples)
+{
+	int32_t sample = (((int32_t)samples[0] - SAMPLE_OFFSET) << SAMPLE_SHIFT) >> 3;
+	uint8_t mask = 0xD5;
+	uint8_t segment;
+	uint8_t code;
+
+	if (sample < 0)
+	{
+		sample = -sample - 1;
+		mask = 0x55;
+	}
+
+	segment = findSegment((uint16_t)sample, ALAW_SEGMENT_BIT);
+	if (segment >= SEGMENTS)
+	{
+		return 0x7F ^ mask;
+	}
+	code = segment << 4;
+	if (segment < 2)
+	{
+		code |= (sample >> 1) & 0x0F;
+	}
+	else
+	{
+		code |= (sample >> segment) & 0x0F;
+	}
+
+	return code ^ mask;
+}
+
+/**
+ * @brief gives the sample of an A-law code
+ *
+ * @param state[IN] unused (stateless codec)
+ * @param code[IN] the code (8 LSBs)
+ * @param samples[OUT] the sample (SAMPLE_SIZE LSBs)
+ */
+RAMFUNC void g711_decodeALaw(void * state, uint32_t code, uint16_t * samples)
+{
+	samples[0] = (uint16_t)((aLawSamples[code & 0xFF] >> SAMPLE_SHIFT) + SAMPLE_OFFSET);
+}
+
+/**
+ * @brief gives the segment of a magnitude
+ *
+ * Segment n holds the magnitudes whose MSB is bit (firstBit + n), segment 0
+ * also holds the smaller ones.
+ *
+ * @param magnitude[IN] the magnitude, biased for mu-law
+ * @param firstBit[IN] MSB of the magnitudes of segment 0
+ * @return the segment (0 to 7), SEGMENTS or more if the magnitude exceeds every segment
+ */
+static RAMFUNC uint8_t findSegment(uint16_t magnitude, uint8_t firstBit)
+{
+	// Position of the MSB (magnitude | 1: CLZ of 0 is 32)
+	uint8_t msb = 31 - __CLZ((uint32_t)magnitude | 1);
+
+	return (msb > firstBit) ? (msb - firstBit) : 0;
+}
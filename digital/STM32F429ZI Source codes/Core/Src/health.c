@@ -0,0 +1,291 @@
+/**
+  ******************************************************************************
+  * @file           : health.c
+  * @brief          : Health API
+  *
+  * Every HEALTH_PERIOD ms, the main loop checks that each stage of the audio
+  * path made progress since the last check: samples captured and bytes sent
+  * on emitters, bytes received and samples played on receivers. A stalled
+  * stage is recovered alone (see Health_StallHandle in links.c). If it is
+  * still stalled after HEALTH_ATTEMPTS checks, the independent watchdog
+  * (IWDG) isn't refreshed anymore and resets the module. The cause is kept
+  * in CCM RAM across the reset.
+  * As the watchdog is only refreshed by the main loop, it also resets the
+  * module if interrupts or deferred work never let the main loop run.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "health.h"
+#include "links.h"
+#include "ring.h"
+#include "sections.h"
+
+#if (HEALTH_MONITOR == 1)
+
+/* Private defines -----------------------------------------------------------*/
+
+#define LSI_FREQUENCY 32000   // Typical, between 17kHz and 47kHz
+#define IWDG_DIVIDER 64       // 2ms per count at 32kHz
+#define IWDG_RELOAD ((HEALTH_WATCHDOG_TIMEOUT * (LSI_FREQUENCY / IWDG_DIVIDER)) / 1000)
+
+#define IWDG_KEY_ENABLE 0xCCCC
+#define IWDG_KEY_ACCESS 0x5555
+#define IWDG_KEY_RELOAD 0xAAAA
+
+#define RECORD_MAGIC 0x4D696357   // Tells a record written before a reset from random RAM content
+
+#if (HEALTH_PERIOD < 1) || (HEALTH_ATTEMPTS < 1)
+#error "HEALTH_PERIOD and HEALTH_ATTEMPTS should be at least 1"
+#endif
+
+#if (IWDG_RELOAD < 1) || (IWDG_RELOAD > 0xFFF)
+#error "HEALTH_WATCHDOG_TIMEOUT should be between 2 and 8190"
+#endif
+
+// The RTOS control task calls Health_Check every HEALTH_PERIOD ms, and LSI may run 50% faster than typical
+#if (HEALTH_WATCHDOG_TIMEOUT < 3 * HEALTH_PERIOD)
+#error "HEALTH_WATCHDOG_TIMEOUT should be at least 3 times HEALTH_PERIOD"
+#endif
+
+/* Private types -------------------------------------------------------------*/
+
+/**
+ * @brief kept across resets, written just before the watchdog resets the module
+ */
+struct record_Info
+{
+	uint32_t magic;              /** RECORD_MAGIC if the record is valid */
+	enum resetCause pending;     /** Cause of the coming watchdog reset, RESET_STARVED if none was recorded */
+	uint32_t watchdogResets;     /** Watchdog resets since power-on */
+};
+
+/* Private variables ---------------------------------------------------------*/
+
+static struct record_Info record NOINIT;
+static enum resetCause resetCause CCMDATA = RESET_POWER;
+static uint8_t escalated CCMDATA;   /** 1 once the watchdog stopped being refreshed */
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint32_t getProgress(struct link_Info * link, enum healthStage stage, uint8_t * expected);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief reads the cause of the last reset and starts the independent watchdog
+ *
+ * Should be called once at boot, before the main loop (right after the link
+ * started if FAST_BOOT is 1). The watchdog can't be stopped afterwards:
+ * Health_Check should be called from the main loop.
+ * It is frozen while a debugger halts the core.
+ */
+void Health_Init()
+{
+	if ((record.magic != RECORD_MAGIC) || __HAL_RCC_GET_FLAG(RCC_FLAG_PORRST) || __HAL_RCC_GET_FLAG(RCC_FLAG_BORRST))
+	{
+		// Power-on or brown-out: CCM RAM content can't be trusted
+		record.magic = RECORD_MAGIC;
+		record.watchdogResets = 0;
+		resetCause = RESET_POWER;
+	}
+	else if (__HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST))
+	{
+		resetCause = record.pending;
+		record.watchdogResets += 1;
+	}
+	else
+	{
+		resetCause = RESET_POWER;
+	}
+	record.pending = RESET_STARVED;
+	__HAL_RCC_CLEAR_RESET_FLAGS();
+
+	escalated = 0;
+	__HAL_DBGMCU_FREEZE_IWDG();
+
+	IWDG->KR = IWDG_KEY_ENABLE;
+	IWDG->KR = IWDG_KEY_ACCESS;
+	IWDG->PR = IWDG_PR_PR_2;   // Divider 64
+	IWDG->RLR = IWDG_RELOAD;
+	while (IWDG->SR != 0)
+	{
+		// Wait for the registers update (a few LSI cycles)
+	}
+	IWDG->KR = IWDG_KEY_RELOAD;
+}
+
+/**
+ * @brief clears the progress of a link, to be called once it started
+ *
+ * @param link[IN] pointer to the link_Info structure given to emitter_start or receiver_start
+ */
+void Health_Start(struct link_Info * link)
+{
+	struct health_Info * health = &(link->health);
+	uint8_t expected;
+	uint8_t i;
+
+	for (i = 0; i < HEALTH_STAGES; i++)
+	{
+		health->progress[i] = getProgress(link, i, &expected);
+		health->stalls[i] = 0;
+		health->recoveries[i] = 0;
+	}
+	health->lastCheck = HAL_GetTick();
+	health->enabled = 1;
+}
+
+/**
+ * @brief stops checking the progress of a link, to be called before it stops
+ *
+ * @param link[IN] pointer to the link_Info structure given to Health_Start
+ */
+void Health_Stop(struct link_Info * link)
+{
+	link->health.enabled = 0;
+}
+
+/**
+ * @brief refreshes the watchdog, and checks the progress of every stage every HEALTH_PERIOD ms
+ *
+ * A stage without progress is recovered by Health_StallHandle. If it doesn't
+ * progress after HEALTH_ATTEMPTS recoveries, the cause is recorded and the
+ * watchdog isn't refreshed anymore: the module resets within
+ * HEALTH_WATCHDOG_TIMEOUT ms. A stopped link (Health_Stop) isn't checked. Reception never leads to a reset, since the
+ * emitter may just be off.
+ * Returns immediately between two checks: it can be called on every main loop iteration.
+ *
+ * @param link[IN] pointer to the link_Info structure given to Health_Start
+ */
+void Health_Check(struct link_Info * link)
+{
+	struct health_Info * health = &(link->health);
+	uint32_t progress;
+	uint8_t expected;
+	uint8_t i;
+
+	if (escalated != 0)
+	{
+		return;
+	}
+
+	// The watchdog only resets the module if this function stops being called
+	IWDG->KR = IWDG_KEY_RELOAD;
+
+	if ((health->enabled == 0) || (HAL_GetTick() - health->lastCheck < HEALTH_PERIOD))
+	{
+		return;
+	}
+	health->lastCheck = HAL_GetTick();
+
+	for (i = 0; i < HEALTH_STAGES; i++)
+	{
+		progress = getProgress(link, i, &expected);
+		if ((progress != health->progress[i]) || (expected == 0))
+		{
+			health->progress[i] = progress;
+			health->stalls[i] = 0;
+			continue;
+		}
+
+		health->stalls[i] += 1;
+		if ((health->stalls[i] > HEALTH_ATTEMPTS) && (i != STAGE_RECEIVE))
+		{
+			// Recovery didn't help: let the watchdog reset the module
+			record.pending = (enum resetCause)(RESET_CAPTURE_STALL + i);
+			escalated = 1;
+			return;
+		}
+
+		health->recoveries[i] += 1;
+		Health_StallHandle(link, i);
+	}
+}
+
+/**
+ * @brief gives the cause of the last reset, read by Health_Init
+ *
+ * @return RESET_POWER, or the stage that stalled before a watchdog reset
+ */
+enum resetCause Health_GetResetCause()
+{
+	return resetCause;
+}
+
+/**
+ * @brief gives the number of watchdog resets since power-on
+ *
+ * @return number of resets
+ */
+uint32_t Health_GetWatchdogResets()
+{
+	return record.watchdogResets;
+}
+
+/**
+ * @brief reads the progress counter of a stage
+ *
+ * @param link[IN] pointer to the link_Info structure
+ * @param stage[IN] the stage
+ * @param expected[OUT] 1 if the stage should have progressed since the last check, 0 if it may be idle
+ * @return the counter, only compared with its previous value
+ */
+static uint32_t getProgress(struct link_Info * link, enum healthStage stage, uint8_t * expected)
+{
+	*expected = 0;
+#if EMITTER_SUPPORT
+	if (link->hadc != NULL)
+	{
+		if (stage == STAGE_CAPTURE)
+		{
+			// TIM2 starts a conversion on every edge
+			*expected = 1;
+			return link->sampleStream.ring.head;
+		}
+		if (stage == STAGE_SEND)
+		{
+			*expected = (link->bitStream.state == BUSY) || (ring_Count(&(link->bitStream.ring)) != 0);
+			return link->bitStream.ring.tail;
+		}
+	}
+#endif
+#if RECEIVER_SUPPORT
+	if (link->hdac != NULL)
+	{
+		if (stage == STAGE_RECEIVE)
+		{
+			*expected = 1;
+			return link->bitStream.ring.head;
+		}
+		if (stage == STAGE_PLAY)
+		{
+#if (DAC_INTERPOLATION > 1)
+			// DMA plays the buffer even when no sample arrives
+			*expected = 1;
+			return DAC_getCycles(&(link->DAC_output))->count;
+#else
+			*expected = (ring_Count(&(link->sampleStream.ring)) != 0);
+			return link->sampleStream.ring.tail;
+#endif
+		}
+	}
+#endif
+	return 0;
+}
+
+#endif
@@ -0,0 +1,457 @@
+/**
+  ******************************************************************************
+  * @file           : howl.c
+  * @brief          : Acoustic feedback suppression
+  *
+  * Emitter pipeline stage stopping howling: a speaker of the boat feeding
+  * the microphone back builds up a loud tone at the frequency where the loop
+  * gain is highest. On each frame, a quarter of the bins between 400Hz and
+  * 5.5kHz (HOWL_GROUPS groups) goes through the Goertzel algorithm, so the
+  * cost of a frame doesn't depend on what is detected. A bin is a howling
+  * peak when it is a local maximum, HOWL_PEAK_RATIO times above the mean of
+  * the spectrum: speech harmonics move with the pitch, a howl stays.
+  * After HOWL_PERSISTENCE checks in a row, a notch biquad is deployed at the
+  * frequency of the peak, refined between the two highest bins. Notches
+  * are released HOWL_RELEASE checks after their peak was last seen in the
+  * input of the stage (before the notches).
+  * Fixed point only: Q30 cosine table, samples scaled to 16 bits.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "howl.h"
+#include "biquad.h"
+#include "sections.h"
+
+#if (HOWL_SUPPRESSION == 1)
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SCALE_SHIFT (16 - SAMPLE_SIZE)           // Samples are scaled to 16 bits
+#define POWER_SHIFT 18                           // Power of a bin, scaled to 32 bits
+#define TONE_MIN 256                             // Quietest howl (amplitude scaled to 16 bits): -42dBFS
+#define POWER_MIN ((uint32_t)(((uint64_t)(FRAME_SIZE / 2 * TONE_MIN) * (FRAME_SIZE / 2 * TONE_MIN)) >> POWER_SHIFT))
+#define POSITION_SHIFT 8                         // Notch frequencies are given in 1/256 of a bin
+#define NOTCH_RADIUS 32440                       // Poles at 0.99 (Q15): notches 38Hz wide at -3dB
+#define NOTCH_SPAN ((1 << POSITION_SHIFT) / 5)   // Peaks closer to a notch (20Hz) are already notched
+
+#if (FRAME_SIZE != 120) && (FRAME_SIZE != 160)
+#error "The cosine tables below are designed for FRAME_SIZE = 120 or 160 (SAMPLING_FREQUENCY = 12000 or 16000): set HOWL_SUPPRESSION to 0"
+#endif
+
+#if (SAMPLE_SIZE > 16)
+#error "SAMPLE_SIZE should not be above 16"
+#endif
+
+#if (HOWL_NOTCHES < 1) || (HOWL_NOTCHES > BIQUAD_MAX_SECTIONS)
+#error "HOWL_NOTCHES should be between 1 and BIQUAD_MAX_SECTIONS"
+#endif
+
+#if (HOWL_BINS % HOWL_GROUPS != 0)
+#error "HOWL_GROUPS should divide HOWL_BINS"
+#endif
+
+#if (HOWL_PERSISTENCE < 1) || (HOWL_PERSISTENCE > 255) || (HOWL_RELEASE < 1) || (HOWL_RELEASE > 65535)
+#error "HOWL_PERSISTENCE should be between 1 and 255, HOWL_RELEASE between 1 and 65535"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+/*
+ * quarterCosine[i] = cos(2 * pi * i / (4 * FRAME_SIZE)) in Q30, for i from 0
+ * to a quarter of a turn (included): bin k of a frame is at i = 4 * k (see
+ * cosine() above a quarter of a turn). Bins are 100Hz apart at both frame sizes.
+ */
+#if (FRAME_SIZE == 120)
+static const int32_t quarterCosine[FRAME_SIZE + 1] =
+{
+	 1073741824,  1073649834,  1073373879,  1072914008,  1072270298,  1071442860,  1070431836,  1069237399,
+	 1067859754,  1066299136,  1064555814,  1062630085,  1060522280,  1058232761,  1055761918,  1053110176,
+	 1050277989,  1047265842,  1044074252,  1040703765,  1037154959,  1033428441,  1029524851,  1025444857,
+	 1021189159,  1016758484,  1012153594,  1007375276,  1002424350,   997301663,   992008094,   986544550,
+	  980911966,   975111308,   969143570,   963009773,   956710970,   950248240,   943622690,   936835454,
+	  929887697,   922780608,   915515405,   908093334,   900515665,   892783698,   884898757,   876862193,
+	  868675383,   860339730,   851856663,   843227634,   834454122,   825537631,   816479688,   807281846,
+	  797945680,   788472791,   778864800,   769123355,   759250125,   749246801,   739115098,   728856751,
+	  718473518,   707967178,   697339532,   686592400,   675727625,   664747066,   653652607,   642446148,
+	  631129609,   619704929,   608174066,   596538995,   584801711,   572964224,   561028562,   548996771,
+	  536870912,   524653063,   512345318,   499949784,   487468587,   474903865,   462257770,   449532470,
+	  436730145,   423852988,   410903207,   397883019,   384794656,   371640360,   358422386,   345142998,
+	  331804471,   318409092,   304959154,   291456964,   277904834,   264305086,   250660051,   236972066,
+	  223243478,   209476638,   195673906,   181837645,   167970228,   154074030,   140151432,   126204820,
+	  112236583,    98249115,    84244813,    70226075,    56195305,    42154906,    28107284,    14054846,
+	          0
+};
+#else
+static const int32_t quarterCosine[FRAME_SIZE + 1] =
+{
+	 1073741824,  1073690079,  1073534850,  1073276151,  1072914008,  1072448455,  1071879537,  1071207309,
+	 1070431836,  1069553193,  1068571464,  1067486743,  1066299136,  1065008757,  1063615730,  1062120190,
+	 1060522280,  1058822155,  1057019979,  1055115925,  1053110176,  1051002926,  1048794379,  1046484747,
+	 1044074252,  1041563127,  1038951614,  1036239965,  1033428441,  1030517313,  1027506862,  1024397377,
+	 1021189159,  1017882516,  1014477768,  1010975242,  1007375276,  1003678218,   999884423,   995994256,
+	  992008094,   987926320,   983749328,   979477520,   975111308,   970651112,   966097364,   961450500,
+	  956710970,   951879231,   946955747,   941940994,   936835454,   931639620,   926353993,   920979082,
+	  915515405,   909963489,   904323869,   898597088,   892783698,   886884260,   880899342,   874829522,
+	  868675383,   862437520,   856116533,   849713032,   843227634,   836660964,   830013654,   823286346,
+	  816479688,   809594337,   802630954,   795590213,   788472791,   781279374,   774010656,   766667337,
+	  759250125,   751759735,   744196889,   736562315,   728856751,   721080937,   713235624,   705321568,
+	  697339532,   689290285,   681174602,   672993266,   664747066,   656436797,   648063258,   639627258,
+	  631129609,   622571130,   613952647,   605274990,   596538995,   587745505,   578895366,   569989432,
+	  561028562,   552013618,   542945470,   533824992,   524653063,   515430567,   506158392,   496837433,
+	  487468587,   478052759,   468590854,   459083786,   449532470,   439937828,   430300783,   420622265,
+	  410903207,   401144545,   391347219,   381512175,   371640360,   361732726,   351790227,   341813821,
+	  331804471,   321763141,   311690799,   301588415,   291456964,   281297421,   271110766,   260897982,
+	  250660051,   240397961,   230112701,   219805262,   209476638,   199127824,   188759818,   178373619,
+	  167970228,   157550647,   147115882,   136666937,   126204820,   115730538,   105245103,    94749524,
+	   84244813,    73731982,    63212044,    52686014,    42154906,    31619735,    21081517,    10541266,
+	          0
+};
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint32_t goertzel(const int16_t * frame, int32_t cosine);
+static void check(struct howl_State * howl, uint8_t index, uint32_t mean);
+static void deploy(struct howl_State * howl, uint8_t index);
+static void release(struct howl_State * howl, uint8_t notch);
+static int32_t cosine(uint16_t position);
+static uint32_t squareRoot(uint32_t value);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief resets a howling suppressor: no notch
+ *
+ * @param state[IN] pointer to a howl_State structure
+ * @return HAL status (always HAL_OK)
+ */
+HAL_StatusTypeDef howl_Start(void * state)
+{
+	struct howl_State * howl = state;
+	uint8_t i;
+
+	for (i = 0; i < HOWL_BINS; i++)
+	{
+		howl->power[i] = 0;
+		howl->persistence[i] = 0;
+	}
+
+	howl->group = 0;
+	howl->deployed = 0;
+	return biquad_Init(&(howl->notches), howl->coefficients, 0);
+}
+
+/**
+ * @brief checks a group of bins for howling, then runs the frame through the notches
+ *
+ * @param state[IN] pointer to a howl_State structure
+ * @param frame[IN] FRAME_SIZE samples (SAMPLE_SIZE bits, centered on 0), filtered in place
+ * @param length[IN] number of samples (FRAME_SIZE)
+ * @return HAL status (HAL_ERROR if length isn't FRAME_SIZE)
+ */
+RAMFUNC HAL_StatusTypeDef howl_Process(void * state, int16_t * frame, uint16_t length)
+{
+	struct howl_State * howl = state;
+	uint64_t sum = 0;
+	uint8_t i;
+
+	if (length != FRAME_SIZE)
+	{
+		return HAL_ERROR;
+	}
+
+	for (i = howl->group; i < HOWL_BINS; i += HOWL_GROUPS)
+	{
+		howl->power[i] = goertzel(frame, cosine((HOWL_FIRST_BIN + i) << POSITION_SHIFT));
+	}
+
+	// Mean of the spectrum, bins of other groups being a few frames old
+	for (i = 0; i < HOWL_BINS; i++)
+	{
+		sum += howl->power[i];
+	}
+
+	for (i = howl->group; i < HOWL_BINS; i += HOWL_GROUPS)
+	{
+		check(howl, i, (uint32_t)(sum / HOWL_BINS));
+	}
+
+	howl->group = (howl->group + 1) % HOWL_GROUPS;
+
+	biquad_Process(&(howl->notches), frame, FRAME_SIZE);
+	return HAL_OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief gives the power of a bin of a frame (Goertzel algorithm)
+ *
+ * @param frame[IN] FRAME_SIZE samples (SAMPLE_SIZE bits, centered on 0)
+ * @param cosine[IN] cosine of the angle of the bin (Q30)
+ * @return the power, scaled down by POWER_SHIFT bits (saturated)
+ */
+static RAMFUNC uint32_t goertzel(const int16_t * frame, int32_t cosine)
+{
+	int32_t s0, s1 = 0, s2 = 0;
+	int64_t power;
+	uint16_t i;
+
+	// s[n] = x[n] + 2 * cos * s[n - 1] - s[n - 2]
+	for (i = 0; i < FRAME_SIZE; i++)
+	{
+		s0 = (int32_t)frame[i] * (1 << SCALE_SHIFT) + (int32_t)(((int64_t)cosine * s1) >> 29) - s2;
+		s2 = s1;
+		s1 = s0;
+	}
+
+	power = (int64_t)s1 * s1 + (int64_t)s2 * s2 - (((int64_t)cosine * s1) >> 29) * s2;
+	power >>= POWER_SHIFT;
+	return (power > UINT32_MAX) ? UINT32_MAX : (uint32_t)power;
+}
+
+/**
+ * @brief looks for a howling peak in a bin, deploys or releases its notch
+ *
+ * @param howl[IN] pointer to the howl_State structure
+ * @param index[IN] position of the bin (0 is HOWL_FIRST_BIN)
+ * @param mean[IN] mean power of the bins
+ */
+static RAMFUNC void check(struct howl_State * howl, uint8_t index, uint32_t mean)
+{
+	uint32_t power = howl->power[index];
+	int32_t distance;
+	uint8_t peak;
+	uint8_t k;
+
+	peak = (power >= POWER_MIN) && (power > (uint64_t)mean * HOWL_PEAK_RATIO)
+	       && ((index == 0) || (power >= howl->power[index - 1]))
+	       && ((index == HOWL_BINS - 1) || (power >= howl->power[index + 1]));
+
+	// Notches less than a bin away: the peak is still there, or their own bin has cleared
+	k = 0;
+	while (k < howl->notches.sections)
+	{
+		distance = (int32_t)howl->position[k] - ((HOWL_FIRST_BIN + index) << POSITION_SHIFT);
+		if ((distance > -(1 << POSITION_SHIFT)) && (distance < (1 << POSITION_SHIFT)))
+		{
+			if (peak)
+			{
+				howl->clear[k] = 0;
+			}
+			else if ((distance >= -(1 << (POSITION_SHIFT - 1))) && (distance < (1 << (POSITION_SHIFT - 1))))
+			{
+				howl->clear[k] += 1;
+				if (howl->clear[k] >= HOWL_RELEASE)
+				{
+					release(howl, k);
+					continue;
+				}
+			}
+		}
+		k++;
+	}
+
+	// Peaks drifting by a bin keep their count
+	if (!peak)
+	{
+		howl->persistence[index] = 0;
+		return;
+	}
+
+	k = howl->persistence[index];
+	if ((index > 0) && (howl->persistence[index - 1] > k))
+	{
+		k = howl->persistence[index - 1];
+	}
+	if ((index < HOWL_BINS - 1) && (howl->persistence[index + 1] > k))
+	{
+		k = howl->persistence[index + 1];
+	}
+	howl->persistence[index] = k + 1;
+
+	if (howl->persistence[index] >= HOWL_PERSISTENCE)
+	{
+		deploy(howl, index);
+	}
+}
+
+/**
+ * @brief deploys a notch at the frequency of a howling peak
+ *
+ * The frequency is refined between the peak and its highest neighbor: for a
+ * tone between two bins, the magnitude of each one is proportional to its
+ * distance to the other. Nothing is deployed if a notch is already there
+ * (a tone the notch removes from the output, not from the input). Closing a
+ * loop at a frequency often makes it howl at the next one: the peak then
+ * gets its own notch. When every notch is used, the one whose peak has been
+ * gone for the longest is moved, if any.
+ *
+ * @param howl[IN] pointer to the howl_State structure
+ * @param index[IN] position of the bin of the peak (0 is HOWL_FIRST_BIN)
+ */
+static RAMFUNC void deploy(struct howl_State * howl, uint8_t index)
+{
+	int32_t * coefficients;
+	int32_t * state;
+	int32_t c;
+	uint32_t magnitude, neighbor;
+	uint16_t position = (HOWL_FIRST_BIN + index) << POSITION_SHIFT;
+	uint8_t notch = howl->notches.sections;
+	uint8_t i;
+
+	howl->persistence[index] = 0;
+	magnitude = squareRoot(howl->power[index]);
+	if ((index > 0) && ((index == HOWL_BINS - 1) || (howl->power[index - 1] > howl->power[index + 1])))
+	{
+		neighbor = squareRoot(howl->power[index - 1]);
+		position -= (uint16_t)((neighbor << POSITION_SHIFT) / (magnitude + neighbor));
+	}
+	else
+	{
+		neighbor = squareRoot(howl->power[index + 1]);
+		position += (uint16_t)((neighbor << POSITION_SHIFT) / (magnitude + neighbor));
+	}
+
+	for (i = 0; i < howl->notches.sections; i++)
+	{
+		if ((howl->position[i] > position - NOTCH_SPAN) && (howl->position[i] < position + NOTCH_SPAN))
+		{
+			return;
+		}
+	}
+
+	if (notch >= HOWL_NOTCHES)
+	{
+		for (i = 0; i < HOWL_NOTCHES; i++)
+		{
+			if ((howl->clear[i] > 0) && ((notch >= HOWL_NOTCHES) || (howl->clear[i] > howl->clear[notch])))
+			{
+				notch = i;
+			}
+		}
+		if (notch >= HOWL_NOTCHES)
+		{
+			return;
+		}
+	}
+
+	// Zeros on the unit circle, poles at NOTCH_RADIUS: b0, b1, b2, -a1, -a2
+	c = cosine(position);
+	coefficients = &(howl->coefficients[BIQUAD_COEFFICIENTS * notch]);
+	coefficients[0] = BIQUAD_ONE;
+	coefficients[1] = -2 * c;
+	coefficients[2] = BIQUAD_ONE;
+	coefficients[3] = (int32_t)(((int64_t)c * NOTCH_RADIUS) >> 14);
+	coefficients[4] = -(NOTCH_RADIUS * NOTCH_RADIUS);
+
+	state = &(howl->notches.state[4 * notch]);
+	for (i = 0; i < 4; i++)
+	{
+		state[i] = 0;
+	}
+
+	howl->position[notch] = position;
+	howl->clear[notch] = 0;
+	if (notch == howl->notches.sections)
+	{
+		howl->notches.sections = notch + 1;
+	}
+	howl->deployed += 1;
+}
+
+/**
+ * @brief removes a notch, the next ones keep their order and their state
+ *
+ * @param howl[IN] pointer to the howl_State structure
+ * @param notch[IN] position of the notch in the cascade
+ */
+static RAMFUNC void release(struct howl_State * howl, uint8_t notch)
+{
+	uint8_t i;
+
+	howl->notches.sections -= 1;
+
+	for (; notch < howl->notches.sections; notch++)
+	{
+		for (i = 0; i < BIQUAD_COEFFICIENTS; i++)
+		{
+			howl->coefficients[BIQUAD_COEFFICIENTS * notch + i] = howl->coefficients[BIQUAD_COEFFICIENTS * (notch + 1) + i];
+		}
+		for (i = 0; i < 4; i++)
+		{
+			howl->notches.state[4 * notch + i] = howl->notches.state[4 * (notch + 1) + i];
+		}
+		howl->position[notch] = howl->position[notch + 1];
+		howl->clear[notch] = howl->clear[notch + 1];
+	}
+}
+
+/**
+ * @brief gives the cosine of a frequency, interpolated in the table
+ *
+ * @param position[IN] frequency (1/256 of a bin), below half of the sampling frequency
+ * @return the cosine of its angle (Q30)
+ */
+static RAMFUNC int32_t cosine(uint16_t position)
+{
+	uint16_t i = position >> (POSITION_SHIFT - 2);
+	int32_t fraction = position & ((1 << (POSITION_SHIFT - 2)) - 1);
+	int32_t a, b;
+
+	// cos(pi - x) = -cos(x)
+	a = (i <= FRAME_SIZE) ? quarterCosine[i] : -quarterCosine[2 * FRAME_SIZE - i];
+	b = (i + 1 <= FRAME_SIZE) ? quarterCosine[i + 1] : -quarterCosine[2 * FRAME_SIZE - i - 1];
+
+	return a + (int32_t)(((int64_t)(b - a) * fraction) >> (POSITION_SHIFT - 2));
+}
+
+/**
+ * @brief gives the integer square root of a value (bit by bit)
+ *
+ * @param value[IN] the value
+ * @return the square root, rounded down
+ */
+static RAMFUNC uint32_t squareRoot(uint32_t value)
+{
+	uint32_t root = 0;
+	uint32_t bit = (uint32_t)1 << 30;
+
+	while (bit > value)
+	{
+		bit >>= 2;
+	}
+
+	while (bit != 0)
+	{
+		if (value >= root + bit)
+		{
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+#endif /* HOWL_SUPPRESSION == 1 */
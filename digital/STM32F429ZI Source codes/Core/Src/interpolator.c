@@ -0,0 +1,116 @@
+/**
+  ******************************************************************************
+  * @file           : interpolator.c
+  * @brief          : Polyphase interpolation filter API
+  *
+  * Upsamples the decoded stream by DAC_INTERPOLATION: every input sample
+  * gives DAC_INTERPOLATION output samples, each one computed by its own
+  * sub-filter (phase) of a low-pass FIR. Only real input samples are
+  * multiplied, the zeros inserted by upsampling are never computed.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "interpolator.h"
+#include "sections.h"
+
+#if (DAC_INTERPOLATION > 1)
+
+/* Private defines -----------------------------------------------------------*/
+
+#if (DAC_INTERPOLATION != 4) || (INTERPOLATION_TAPS_PER_PHASE != 8)
+#error "Filter coefficients below are designed for DAC_INTERPOLATION = 4 and INTERPOLATION_TAPS_PER_PHASE = 8"
+#endif
+
+#define SAMPLE_OFFSET (1 << (SAMPLE_SIZE - 1))
+
+/* Private variables ---------------------------------------------------------*/
+
+/*
+ * 32-tap low-pass FIR (Kaiser window, beta = 5, cutoff 5.5kHz at 48kHz) in Q15.
+ * coefficients[phase][tap] = h[phase + DAC_INTERPOLATION * tap]
+ * Each phase sums to exactly 32768 so that DC gain is 1 on every output sample.
+ * Response of these coefficients: -0.8dB at 4kHz, -3.5dB at 5kHz, -6dB at
+ * 5.5kHz. Images of the 12kHz stream: -22dB at 7kHz, -54dB at 8kHz, at least
+ * 59dB down from 9kHz (sidelobes of -59dB at 10.65kHz and -60.6dB at 16kHz).
+ */
+static const int16_t coefficients[DAC_INTERPOLATION][INTERPOLATION_TAPS_PER_PHASE] =
+{
+	{   -97,    790,  -2471,   6180,  29265,  -749,  -388,   238 },
+	{  -174,   1196,  -4256,  15311,  24015, -4140,   921,  -105 },
+	{  -105,    921,  -4140,  24015,  15311, -4256,  1196,  -174 },
+	{   238,   -388,   -749,  29265,   6180, -2471,   790,   -97 }
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief clears the filter history (the output starts from mid-scale)
+ * 
+ * @param interpolator[IN] pointer to the interpolator_Info structure
+ */
+void interpolator_init(struct interpolator_Info * interpolator)
+{
+	uint8_t i;
+
+	for (i = 0; i < 2 * INTERPOLATION_TAPS_PER_PHASE; i++)
+	{
+		interpolator->history[i] = 0;
+	}
+	interpolator->position = 0;
+}
+
+/**
+ * @brief computes DAC_INTERPOLATION output samples from one input sample
+ * 
+ * @param interpolator[IN] pointer to the interpolator_Info structure
+ * @param sample[IN] new input sample (unsigned, SAMPLE_SIZE bits)
+ * @param output[OUT] array of DAC_INTERPOLATION samples (unsigned, SAMPLE_SIZE bits)
+ * @note Costs DAC_INTERPOLATION * INTERPOLATION_TAPS_PER_PHASE multiply-accumulates
+ */
+RAMFUNC void interpolator_process(struct interpolator_Info * interpolator, uint16_t sample, uint16_t * output)
+{
+	uint8_t phase;
+	uint8_t tap;
+	int32_t accumulator;
+	int16_t * window;
+
+	// Most recent sample goes first, in both copies of the history
+	if (interpolator->position == 0)
+	{
+		interpolator->position = INTERPOLATION_TAPS_PER_PHASE;
+	}
+	interpolator->position -= 1;
+
+	interpolator->history[interpolator->position] = (int16_t)sample - SAMPLE_OFFSET;
+	interpolator->history[interpolator->position + INTERPOLATION_TAPS_PER_PHASE] = (int16_t)sample - SAMPLE_OFFSET;
+
+	window = &(interpolator->history[interpolator->position]);
+
+	for (phase = 0; phase < DAC_INTERPOLATION; phase++)
+	{
+		accumulator = 1 << 14; // Rounding
+		for (tap = 0; tap < INTERPOLATION_TAPS_PER_PHASE; tap++)
+		{
+			accumulator += (int32_t)coefficients[phase][tap] * window[tap];
+		}
+
+		output[phase] = (uint16_t)__USAT((accumulator >> 15) + SAMPLE_OFFSET, SAMPLE_SIZE);
+	}
+}
+
+#endif /* DAC_INTERPOLATION > 1 */
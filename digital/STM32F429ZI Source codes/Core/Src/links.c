@@ -22,6 +22,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_hal.h"
+#include "links.h"
 #include "decoder.h"
 #include "encoder.h"
 #include "uart.h"
@@ -30,28 +31,50 @@
 #include "dac.h"
 #include "types.h"
 #include "timer.h"
+#include "scheduler.h"
+#include "priority.h"
+#include "boot.h"
+#include "sections.h"
 
-/* Private variables ---------------------------------------------------------*/
+/* Private defines -----------------------------------------------------------*/
 
-struct peripherals_Info
-{
-	UART_HandleTypeDef * huart;
-	DAC_HandleTypeDef * hdac;
-	ADC_HandleTypeDef * hadc;
-	TIM_HandleTypeDef * htim;
-	uint32_t DAC_Channel;
-};
+#if (MAX_LINKS < 1)
+#error "MAX_LINKS should be at least 1"
+#endif
 
-struct peripherals_Info peripherals;
+// Events posted by interrupts (bits of link_Info.events)
+#define EVENT_ENCODE 0x01        // New samples in the ADC stream
+#define EVENT_DECODE 0x02        // New bytes in the UART stream
+#define EVENT_FIRST_HALF 0x04    // DAC DMA reached the middle of its buffer: the first half is to be filled
+#define EVENT_RESYNC 0x08        // UART reception stopped on an error (receiver)
+#define EVENT_RESTART 0x10       // The link was halted by Error_Handler and should be restarted
+#define EVENT_DAC_RESTART 0x20   // DAC DMA underrun: the DAC stopped (receiver)
+#define EVENT_SECOND_HALF 0x40   // DAC DMA reached the end of its buffer: the second half is to be filled
+#define EVENT_RECOVER 0x80       // First of HEALTH_STAGES bits: the stage stalled (see health.c)
 
-struct sampleStream_Info sampleStream;
-struct bitStream_Info bitStream;
+/* Private variables ---------------------------------------------------------*/
+
+/*
+ * Running emitters/receivers. HAL callbacks only give a peripheral handle:
+ * this registry is used to find the link owning the peripheral.
+ */
+static struct link_Info * links[MAX_LINKS] CCMDATA;
 
 /* Private function prototypes -----------------------------------------------*/
 
-static void Error_Handler(void);
-static HAL_StatusTypeDef receiver_restart();
-static HAL_StatusTypeDef emitter_restart();
+static void Error_Handler(struct link_Info * link);
+static void emitter_halt(struct link_Info * link);
+static void receiver_halt(struct link_Info * link);
+static HAL_StatusTypeDef receiver_restart(struct link_Info * link);
+static HAL_StatusTypeDef emitter_restart(struct link_Info * link);
+static void restartLink(struct link_Info * link);
+static HAL_StatusTypeDef receiver_resync(struct link_Info * link);
+static HAL_StatusTypeDef receiver_restartDAC(struct link_Info * link);
+static void countError(struct link_Info * link, enum errorKind kind);
+static HAL_StatusTypeDef recoverStage(struct link_Info * link, enum healthStage stage);
+static HAL_StatusTypeDef registerLink(struct link_Info * link);
+static void unregisterLink(struct link_Info * link);
+static struct link_Info * findLink(const void * handle);
 
 /* Exported functions --------------------------------------------------------*/
 
@@ -61,52 +84,81 @@ static HAL_StatusTypeDef emitter_restart();
 
 /**
  * @brief emitter_start does everything necessary to automatically receive analog values and send them via serial.
+ * @param link[in] pointer to a link_Info structure (in SRAM), used as a handle by emitter_stop
  * @param huart[in] pointer to a USART_HandleTypeDef structure that contains the configuration information for the specified USART module.
  * @param hadc[in] pointer to a ADC_HandleTypeDef structure that contains the configuration information for the specified ADC.
  * @param htim[in] pointer to a TIM_HandleTypeDef structure that contains the configuration information for TIM module.
  * @return HAL status (HAL_OK if no errors occured).
  * @note Non blocking function
  */
-HAL_StatusTypeDef emitter_start(UART_HandleTypeDef * huart, ADC_HandleTypeDef * hadc, TIM_HandleTypeDef * htim)
+HAL_StatusTypeDef emitter_start(struct link_Info * link, UART_HandleTypeDef * huart, ADC_HandleTypeDef * hadc, TIM_HandleTypeDef * htim)
 {
 	HAL_StatusTypeDef status = HAL_OK;
-#if (MODULE_TYPE == MICROW_EMITTER)
-	peripherals.huart = huart;
-	peripherals.hadc = hadc;
-	peripherals.htim = htim;
+#if EMITTER_SUPPORT
+	uint8_t i;
 
-	status = streamInit(&sampleStream, &bitStream, hadc, huart);
-	if (status != HAL_OK)
+	if (link == NULL)
 	{
-		return status;
+		return HAL_ERROR;
 	}
 
-	status = UARTTx_streamStart(&bitStream);
+	link->huart = huart;
+	link->hadc = hadc;
+	link->hdac = NULL;
+	link->htim = htim;
+
+	status = streamInit(&(link->sampleStream), &(link->bitStream), hadc, NULL, 0, huart);
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = encoder_streamStart(&sampleStream, &bitStream);
-	if (status != HAL_OK)
+	link->events = 0;
+	for (i = 0; i < ERROR_KINDS; i++)
 	{
-		return status;
+		link->errors[i] = 0;
 	}
+	Scheduler_Init();
 
-	status = ADC_streamStart(&sampleStream);
+	// Callbacks may occur as soon as peripherals start
+	status = registerLink(link);
 	if (status != HAL_OK)
 	{
+		streamFree(&(link->sampleStream), &(link->bitStream));
 		return status;
 	}
 
-	status = Timer_Start(htim);
+	status = UARTTx_streamStart(&(link->bitStream));
+	if (status == HAL_OK)
+	{
+		status = encoder_streamStart(&(link->encoder), &(link->sampleStream), &(link->bitStream));
+	}
+	if (status == HAL_OK)
+	{
+		status = ADC_streamStart(&(link->sampleStream));
+	}
+	if (status == HAL_OK)
+	{
+		status = Timer_Start(htim);
+	}
+
 	if (status != HAL_OK)
 	{
+		// Like emitter_stop: nothing is left running, the buffers are given back and emitter_start can be called again
+		emitter_halt(link);
+		unregisterLink(link);
+		streamFree(&(link->sampleStream), &(link->bitStream));
 		return status;
 	}
 #else
 	status = HAL_ERROR;
 #endif
+	if (status == HAL_OK)
+	{
+		Health_Start(link);
+		Boot_Mark(BOOT_STARTED);
+	}
+
 	if (ERROR_LED && (status == HAL_OK))
 	{
 		HAL_GPIO_WritePin(GPIOG, GPIO_PIN_14, GPIO_PIN_RESET);
@@ -117,32 +169,43 @@ HAL_StatusTypeDef emitter_start(UART_HandleTypeDef * huart, ADC_HandleTypeDef *
 
 /**
  * @brief emitter_stop does everything necessary to stop the emitter
+ * @param link[in] pointer to the link_Info structure given to emitter_start
  * @return HAL status (HAL_OK if no errors occured).
  * @note Non blocking function
  */
-HAL_StatusTypeDef emitter_stop()
+HAL_StatusTypeDef emitter_stop(struct link_Info * link)
 {
 	HAL_StatusTypeDef status = HAL_OK;
-#if (MODULE_TYPE == MICROW_EMITTER)
-	status = ADC_streamStop();
+#if EMITTER_SUPPORT
+	if ((link == NULL) || (link->hadc == NULL))
+	{
+		// Not an emitter
+		return HAL_ERROR;
+	}
+
+	Health_Stop(link);
+
+	status = ADC_streamStop(&(link->sampleStream));
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = encoder_streamStop();
+	status = encoder_streamStop(&(link->encoder));
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = UARTTx_streamStop();
+	status = UARTTx_streamStop(&(link->bitStream));
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = streamFree(&sampleStream, &bitStream);
+	unregisterLink(link);
+
+	status = streamFree(&(link->sampleStream), &(link->bitStream));
 	if (status != HAL_OK)
 	{
 		return status;
@@ -156,6 +219,7 @@ HAL_StatusTypeDef emitter_stop()
 
 /**
  * @brief receiver_start does everything necessary to automatically receive a serial stream and convert received values into an analog signal.
+ * @param link[in] pointer to a link_Info structure (in SRAM), used as a handle by receiver_stop
  * @param huart[in] pointer to a USART_HandleTypeDef structure that contains the configuration information for the specified USART module.
  * @param hdac[in] pointer to a DAC_HandleTypeDef structure that contains the configuration information for the specified DAC.
  * @param DAC_Channel[in] The selected DAC channel. This parameter can be one of the following values: DAC_CHANNEL_1 or DAC_CHANNEL_2
@@ -163,47 +227,93 @@ HAL_StatusTypeDef emitter_stop()
  * @return HAL status (HAL_OK if no errors occured).
  * @note Non blocking function
  */
-HAL_StatusTypeDef receiver_start(UART_HandleTypeDef * huart, DAC_HandleTypeDef * hdac, uint32_t DAC_Channel, TIM_HandleTypeDef * htim)
+HAL_StatusTypeDef receiver_start(struct link_Info * link, UART_HandleTypeDef * huart, DAC_HandleTypeDef * hdac, uint32_t DAC_Channel, TIM_HandleTypeDef * htim)
 {
 	HAL_StatusTypeDef status = HAL_OK;
-#if (MODULE_TYPE == MICROW_RECEIVER)
-	peripherals.huart = huart;
-	peripherals.hdac = hdac;
-	peripherals.DAC_Channel = DAC_Channel;
-	peripherals.htim = htim;
+#if RECEIVER_SUPPORT
+	uint8_t i;
 
-	status = streamInit(&sampleStream, &bitStream, hdac, DAC_Channel, huart);
-	if (status != HAL_OK)
+	if (link == NULL)
 	{
-		return status;
+		return HAL_ERROR;
 	}
 
-	status = Timer_Start(htim);
+	link->huart = huart;
+	link->hadc = NULL;
+	link->hdac = hdac;
+	link->DAC_Channel = DAC_Channel;
+	link->htim = htim;
+
+	status = streamInit(&(link->sampleStream), &(link->bitStream), NULL, hdac, DAC_Channel, huart);
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = DAC_streamStart(&sampleStream);
-	if (status != HAL_OK)
+	link->events = 0;
+	for (i = 0; i < ERROR_KINDS; i++)
 	{
-		return status;
+		link->errors[i] = 0;
 	}
+	Scheduler_Init();
 
-	status = decoder_streamStart(&bitStream, &sampleStream);
+	// Callbacks may occur as soon as peripherals start
+	status = registerLink(link);
 	if (status != HAL_OK)
 	{
+		streamFree(&(link->sampleStream), &(link->bitStream));
 		return status;
 	}
 
-	status = UARTRx_streamStart(&bitStream);
+#if (DAC_INTERPOLATION > 1)
+	// The timer only triggers the DAC, DMA callbacks feed the interpolator
+	status = DAC_streamStart(&(link->DAC_output), &(link->sampleStream));
+	if (status == HAL_OK)
+	{
+		status = Timer_StartTrigger(htim);
+	}
+	if (status == HAL_OK)
+	{
+		// Without timer interrupts: the DAC converts its first sample on the next trigger
+		Boot_Mark(BOOT_FIRST_SAMPLE);
+	}
+#else
+	status = Timer_Start(htim);
+	if (status == HAL_OK)
+	{
+		status = DAC_streamStart(&(link->DAC_output), &(link->sampleStream));
+	}
+#endif
+
+	if (status == HAL_OK)
+	{
+		status = decoder_streamStart(&(link->decoder), &(link->bitStream), &(link->sampleStream));
+	}
+	if (status == HAL_OK)
+	{
+		// Silence descriptors received by the decoder start the noise played by the DAC
+		link->decoder.comfort = &(link->DAC_output.comfort);
+		status = UARTRx_streamStart(&(link->bitStream));
+	}
+
 	if (status != HAL_OK)
 	{
+		// Like receiver_stop: nothing is left running, the buffers are given back and receiver_start can be called again
+		receiver_halt(link);
+		Timer_Stop(htim);
+		unregisterLink(link);
+		streamFree(&(link->sampleStream), &(link->bitStream));
 		return status;
 	}
 #else
 	status = HAL_ERROR;
 #endif
+	if (status == HAL_OK)
+	{
+		Health_Start(link);
+		Boot_Mark(BOOT_STARTED);
+	}
+
 	if (ERROR_LED && (status == HAL_OK))
 	{
 		HAL_GPIO_WritePin(GPIOG, GPIO_PIN_14, GPIO_PIN_RESET);
@@ -214,32 +324,43 @@ HAL_StatusTypeDef receiver_start(UART_HandleTypeDef * huart, DAC_HandleTypeDef *
 
 /**
  * @brief receiver_stop does everything necessary to stop the receiver
+ * @param link[in] pointer to the link_Info structure given to receiver_start
  * @return HAL status (HAL_OK if no errors occured).
  * @note Non blocking function
  */
-HAL_StatusTypeDef receiver_stop()
+HAL_StatusTypeDef receiver_stop(struct link_Info * link)
 {
 	HAL_StatusTypeDef status = HAL_OK;
-#if (MODULE_TYPE == MICROW_RECEIVER)
-	status = UARTRx_streamStop();
+#if RECEIVER_SUPPORT
+	if ((link == NULL) || (link->hdac == NULL))
+	{
+		// Not a receiver
+		return HAL_ERROR;
+	}
+
+	Health_Stop(link);
+
+	status = UARTRx_streamStop(&(link->bitStream));
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = decoder_streamStop();
+	status = decoder_streamStop(&(link->decoder));
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = DAC_streamStop();
+	status = DAC_streamStop(&(link->DAC_output));
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = streamFree(&sampleStream, &bitStream);
+	unregisterLink(link);
+
+	status = streamFree(&(link->sampleStream), &(link->bitStream));
 	if (status != HAL_OK)
 	{
 		return status;
@@ -252,26 +373,67 @@ HAL_StatusTypeDef receiver_stop()
 
 
 /*=============================================================================
-                  ##### Restart functions #####
+                  ##### Recovery functions #####
 =============================================================================*/
 
 /**
- * @brief emitter_restart starts the emitter without changing existing configuration
+ * @brief emitter_halt stops every lower level API of the emitter. Buffers and
+ * configuration are kept for emitter_restart.
+ * @param link[in] pointer to the link_Info structure given to emitter_start
+ */
+static void emitter_halt(struct link_Info * link)
+{
+#if EMITTER_SUPPORT
+	ADC_streamStop(&(link->sampleStream));
+	encoder_streamStop(&(link->encoder));
+	UARTTx_streamStop(&(link->bitStream));
+	HAL_UART_AbortTransmit(link->huart);
+#endif
+}
+
+/**
+ * @brief receiver_halt stops every lower level API of the receiver. Buffers and
+ * configuration are kept for receiver_restart.
+ * @param link[in] pointer to the link_Info structure given to receiver_start
+ */
+static void receiver_halt(struct link_Info * link)
+{
+#if RECEIVER_SUPPORT
+	UARTRx_streamStop(&(link->bitStream));
+	decoder_streamStop(&(link->decoder));
+	DAC_streamStop(&(link->DAC_output));
+#endif
+}
+
+/**
+ * @brief emitter_restart starts a halted emitter again, with the same buffers and configuration
+ * @param link[in] pointer to the link_Info structure given to emitter_start
  * @return HAL status (HAL_OK if no errors occured).
  * @note Non blocking function
  */
-static HAL_StatusTypeDef emitter_restart()
+static HAL_StatusTypeDef emitter_restart(struct link_Info * link)
 {
 	HAL_StatusTypeDef status = HAL_OK;
-#if (MODULE_TYPE == MICROW_EMITTER)
+#if EMITTER_SUPPORT
+	// Nothing else uses the rings while the emitter is halted
+	ring_Reset(&(link->sampleStream.ring));
+	ring_Reset(&(link->bitStream.ring));
+	link->bitStream.transferLength = 0;
+
+	// Queues a synchronization signal, then sends it
+	status = encoder_streamRestart(&(link->encoder));
+	if (status != HAL_OK)
+	{
+		return status;
+	}
 
-	status = emitter_stop();
+	status = UARTTx_streamUpdate(&(link->bitStream));
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = emitter_start(peripherals.huart, peripherals.hadc, peripherals.htim);
+	status = ADC_streamRestart(&(link->sampleStream));
 #else
 	status = HAL_ERROR;
 #endif
@@ -279,28 +441,284 @@ static HAL_StatusTypeDef emitter_restart()
 }
 
 /**
- * @brief receiver_restart starts the receiver without changing existing configuration
+ * @brief receiver_restart starts a halted receiver again, with the same buffers and configuration
+ * @param link[in] pointer to the link_Info structure given to receiver_start
  * @return HAL status (HAL_OK if no errors occured).
  * @note Non blocking function
  */
-static HAL_StatusTypeDef receiver_restart()
+static HAL_StatusTypeDef receiver_restart(struct link_Info * link)
 {
 	HAL_StatusTypeDef status = HAL_OK;
-#if (MODULE_TYPE == MICROW_RECEIVER)
+#if RECEIVER_SUPPORT
+	// Nothing else uses the rings while the receiver is halted
+	ring_Reset(&(link->sampleStream.ring));
+	ring_Reset(&(link->bitStream.ring));
 
-	status = receiver_stop();
+	status = decoder_streamRestart(&(link->decoder));
 	if (status != HAL_OK)
 	{
 		return status;
 	}
 
-	status = receiver_start(peripherals.huart, peripherals.hdac, peripherals.DAC_Channel, peripherals.htim);
+	status = DAC_streamRestart(&(link->DAC_output));
+	if (status != HAL_OK)
+	{
+		return status;
+	}
+
+	status = UARTRx_streamRestart(&(link->bitStream));
 #else
 	status = HAL_ERROR;
 #endif
 	return status;
 }
 
+/**
+ * @brief restartLink restarts a link halted by Error_Handler. If it fails, the
+ * link stays halted: there is no further attempt.
+ * @param link[in] pointer to the link_Info structure
+ */
+static void restartLink(struct link_Info * link)
+{
+	HAL_StatusTypeDef status;
+
+	if (link->hdac != NULL)
+	{
+		status = receiver_restart(link);
+	}
+	else
+	{
+		status = emitter_restart(link);
+	}
+
+	if (status != HAL_OK)
+	{
+		// Last resort failed: halt what may have started, the error LED stays on
+		receiver_halt(link);
+		emitter_halt(link);
+	}
+	else if (ERROR_LED)
+	{
+		HAL_GPIO_WritePin(GPIOG, GPIO_PIN_14, GPIO_PIN_RESET);
+	}
+}
+
+/**
+ * @brief receiver_resync resumes UART reception after it stopped on an error
+ *
+ * Bytes received before the error are decoded, then the decoder drops every
+ * byte up to the next synchronization signal: a lost byte would shift every
+ * following sample.
+ *
+ * @param link[in] pointer to the link_Info structure given to receiver_start
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+static RAMFUNC HAL_StatusTypeDef receiver_resync(struct link_Info * link)
+{
+	HAL_StatusTypeDef status = HAL_OK;
+#if RECEIVER_SUPPORT
+	if (link->bitStream.state == INACTIVE)
+	{
+		// Halted meanwhile, receiver_restart will resume reception
+		return HAL_OK;
+	}
+
+	status = decoder_streamUpdate(&(link->decoder));
+	if (status != HAL_OK)
+	{
+		return status;
+	}
+
+	decoder_streamResync(&(link->decoder));
+
+	status = UARTRx_streamRestart(&(link->bitStream));
+#else
+	status = HAL_ERROR;
+#endif
+	return status;
+}
+
+/**
+ * @brief receiver_restartDAC restarts the DAC alone after a DMA underrun
+ *
+ * Samples already decoded stay in the ring and are converted once the DAC restarts.
+ *
+ * @param link[in] pointer to the link_Info structure given to receiver_start
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+static HAL_StatusTypeDef receiver_restartDAC(struct link_Info * link)
+{
+	HAL_StatusTypeDef status = HAL_OK;
+#if RECEIVER_SUPPORT
+	if (link->sampleStream.state == INACTIVE)
+	{
+		// Halted meanwhile, receiver_restart will restart the DAC
+		return HAL_OK;
+	}
+
+	status = DAC_streamStop(&(link->DAC_output));
+	if (status == HAL_OK)
+	{
+		status = DAC_streamRestart(&(link->DAC_output));
+	}
+#else
+	status = HAL_ERROR;
+#endif
+	return status;
+}
+
+/**
+ * @brief countError adds an error to link_Info.errors
+ *
+ * Errors are reported by interrupts of every priority: the counter is
+ * incremented in a critical section, so that no report is lost.
+ *
+ * @param link[in] pointer to the link_Info structure that encountered the error
+ * @param kind[in] the kind of error
+ */
+static RAMFUNC void countError(struct link_Info * link, enum errorKind kind)
+{
+	uint32_t state;
+
+	state = Priority_EnterCritical();
+	link->errors[kind] += 1;
+	Priority_ExitCritical(state);
+}
+
+/**
+ * @brief recoverStage restarts the peripheral of a stage that stopped progressing,
+ * other stages keep running
+ * @param link[in] pointer to the link_Info structure
+ * @param stage[in] the stalled stage
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+static HAL_StatusTypeDef recoverStage(struct link_Info * link, enum healthStage stage)
+{
+	HAL_StatusTypeDef status = HAL_OK;
+#if EMITTER_SUPPORT
+	if ((stage == STAGE_CAPTURE) && (link->hadc != NULL))
+	{
+		// TIM2 is stopped first: its interrupt starts the ADC too
+		Timer_Stop(link->htim);
+		ADC_streamStop(&(link->sampleStream));
+		status = ADC_streamRestart(&(link->sampleStream));
+		if (status == HAL_OK)
+		{
+			status = Timer_Start(link->htim);
+		}
+	}
+
+	if ((stage == STAGE_SEND) && (link->hadc != NULL))
+	{
+		// For example a transfer complete interrupt was missed: the stream stays BUSY
+		HAL_UART_AbortTransmit(link->huart);
+		status = UARTTx_streamRestart(&(link->bitStream));
+	}
+#endif
+#if RECEIVER_SUPPORT
+	if ((stage == STAGE_RECEIVE) && (link->hdac != NULL))
+	{
+		HAL_UART_AbortReceive(link->huart);
+		status = receiver_resync(link);
+	}
+
+	if ((stage == STAGE_PLAY) && (link->hdac != NULL))
+	{
+		status = receiver_restartDAC(link);
+	}
+#endif
+	return status;
+}
+
+/*=============================================================================
+                  ##### Registry functions #####
+=============================================================================*/
+
+/**
+ * @brief adds a link to the list of running links
+ * @param link[in] pointer to the link_Info structure
+ * @return HAL status (HAL_ERROR if MAX_LINKS links are already running).
+ */
+static HAL_StatusTypeDef registerLink(struct link_Info * link)
+{
+	HAL_StatusTypeDef status = HAL_ERROR;
+	uint32_t state;
+	uint8_t i;
+
+	// Error_Handler may unregister a link from an interrupt meanwhile
+	state = Priority_EnterCritical();
+
+	for (i = 0; (i < MAX_LINKS) && (status != HAL_OK); i++)
+	{
+		if (links[i] == link)
+		{
+			status = HAL_OK;
+		}
+	}
+
+	for (i = 0; (i < MAX_LINKS) && (status != HAL_OK); i++)
+	{
+		if (links[i] == NULL)
+		{
+			links[i] = link;
+			status = HAL_OK;
+		}
+	}
+
+	Priority_ExitCritical(state);
+	return status;
+}
+
+/**
+ * @brief removes a link from the list of running links
+ * @param link[in] pointer to the link_Info structure
+ */
+static void unregisterLink(struct link_Info * link)
+{
+	uint32_t state;
+	uint8_t i;
+
+	state = Priority_EnterCritical();
+
+	for (i = 0; i < MAX_LINKS; i++)
+	{
+		if (links[i] == link)
+		{
+			links[i] = NULL;
+		}
+	}
+
+	Priority_ExitCritical(state);
+}
+
+/**
+ * @brief finds the running link owning a peripheral or a stream
+ * @param handle[in] pointer to a HAL handle (UART, ADC, DAC) or to a stream structure of the link
+ * @return pointer to the link_Info structure, NULL if no running link owns the handle
+ */
+static RAMFUNC struct link_Info * findLink(const void * handle)
+{
+	struct link_Info * link;
+	uint8_t i;
+
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	for (i = 0; i < MAX_LINKS; i++)
+	{
+		link = links[i];
+		if ((link != NULL) && ((handle == link->huart) || (handle == link->hadc) || (handle == link->hdac)
+				|| (handle == &(link->sampleStream)) || (handle == &(link->bitStream))))
+		{
+			return link;
+		}
+	}
+
+	return NULL;
+}
+
 /*=============================================================================
                   ##### HAL Callback functions #####
 =============================================================================*/
@@ -310,50 +728,195 @@ static HAL_StatusTypeDef receiver_restart()
  * Those functions are called by HAL when a specific event happens.
  */
  
-void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef * hadc)
+RAMFUNC void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef * hadc)
 {
 	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(hadc);
 
-	status = ADC_streamUpdate();
+	if (link == NULL)
+	{
+		return;
+	}
 
-	if (status != HAL_OK)
+	status = ADC_streamUpdate(&(link->sampleStream));
+
+	// HAL_BUSY: a conversion ended after the stream was stopped, its sample is dropped
+	if ((status != HAL_OK) && (status != HAL_BUSY))
 	{
-		Error_Handler();
+		Error_Handler(link);
 	}
 }
 
 void HAL_ADC_ErrorCallback(ADC_HandleTypeDef * hadc)
 {
-	Error_Handler();
+	// Overrun: HAL cleared it, the next timer edge starts a new conversion
+	Stream_ErrorHandle(hadc, PERIPHERAL_FAILURE);
 }
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef * huart)
+RAMFUNC void HAL_UART_RxCpltCallback(UART_HandleTypeDef * huart)
 {
 	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(huart);
+
+	if (link == NULL)
+	{
+		return;
+	}
 
-	status = UARTRx_streamUpdate();
+	status = UARTRx_streamUpdate(&(link->bitStream));
 
 	if (status != HAL_OK)
 	{
-		Error_Handler();
+		Error_Handler(link);
 	}
 }
 
-void HAL_UART_TxCpltCallback(UART_HandleTypeDef * huart)
+RAMFUNC void HAL_UART_TxCpltCallback(UART_HandleTypeDef * huart)
 {
 	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(huart);
 
-	status = UARTTx_streamRestart();
+	if (link == NULL)
+	{
+		return;
+	}
+
+	status = UARTTx_streamRestart(&(link->bitStream));
 
 	if (status != HAL_OK)
 	{
-		Error_Handler();
+		Error_Handler(link);
 	}
 }
 
 void HAL_UART_ErrorCallback(UART_HandleTypeDef * huart)
 {
-	Error_Handler();
+	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(huart);
+	uint32_t error = huart->ErrorCode;
+
+	if (link == NULL)
+	{
+		return;
+	}
+
+	// Reading SR then DR clears ORE, FE, NE and PE
+	__HAL_UART_CLEAR_OREFLAG(huart);
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+
+	if (error & HAL_UART_ERROR_ORE)
+	{
+		Stream_ErrorHandle(huart, LINE_OVERRUN);
+	}
+	if (error & HAL_UART_ERROR_FE)
+	{
+		Stream_ErrorHandle(huart, LINE_FRAMING);
+	}
+	if (error & HAL_UART_ERROR_NE)
+	{
+		Stream_ErrorHandle(huart, LINE_NOISE);
+	}
+	if (error & HAL_UART_ERROR_PE)
+	{
+		Stream_ErrorHandle(huart, LINE_PARITY);
+	}
+	if (error & HAL_UART_ERROR_DMA)
+	{
+		Stream_ErrorHandle(huart, PERIPHERAL_FAILURE);
+	}
+
+#if RECEIVER_SUPPORT
+	if (link->hdac != NULL)
+	{
+		// HAL aborted the reception
+#if (DEFERRED_PROCESSING == 1)
+		Scheduler_Post(&(link->events), EVENT_RESYNC);
+#else
+		status = receiver_resync(link);
+#endif
+	}
+#endif
+#if EMITTER_SUPPORT
+	if ((link->hadc != NULL) && (error & HAL_UART_ERROR_DMA))
+	{
+		// HAL aborted the transfer: its bytes are dropped, the receiver waits for the next sync. signal
+		status = UARTTx_streamRestart(&(link->bitStream));
+	}
+#endif
+
+	if ((status != HAL_OK) && (status != HAL_BUSY))
+	{
+		Error_Handler(link);
+	}
+}
+
+RAMFUNC void HAL_DAC_ConvHalfCpltCallbackCh1(DAC_HandleTypeDef * hdac)
+{
+	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(hdac);
+
+	if (link == NULL)
+	{
+		return;
+	}
+
+#if RECEIVER_SUPPORT && (DEFERRED_PROCESSING == 1)
+	Scheduler_Post(&(link->events), EVENT_FIRST_HALF);
+#elif RECEIVER_SUPPORT
+	status = DAC_streamUpdate(&(link->DAC_output));
+#endif
+
+	if (status != HAL_OK)
+	{
+		Error_Handler(link);
+	}
+}
+
+RAMFUNC void HAL_DAC_ConvCpltCallbackCh1(DAC_HandleTypeDef * hdac)
+{
+	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(hdac);
+
+	if (link == NULL)
+	{
+		return;
+	}
+
+#if RECEIVER_SUPPORT && (DEFERRED_PROCESSING == 1)
+	Scheduler_Post(&(link->events), EVENT_SECOND_HALF);
+#elif RECEIVER_SUPPORT
+	status = DAC_streamUpdate(&(link->DAC_output));
+#endif
+
+	if (status != HAL_OK)
+	{
+		Error_Handler(link);
+	}
+}
+
+void HAL_DAC_DMAUnderrunCallbackCh1(DAC_HandleTypeDef * hdac)
+{
+	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(hdac);
+
+	if (link == NULL)
+	{
+		return;
+	}
+
+	Stream_ErrorHandle(hdac, PERIPHERAL_FAILURE);
+
+#if RECEIVER_SUPPORT && (DEFERRED_PROCESSING == 1)
+	// HAL disabled the DMA request: the DAC is restarted by PendSV, which may be interpolating meanwhile
+	Scheduler_Post(&(link->events), EVENT_DAC_RESTART);
+#elif RECEIVER_SUPPORT
+	status = receiver_restartDAC(link);
+#endif
+
+	if (status != HAL_OK)
+	{
+		Error_Handler(link);
+	}
 }
 
 /*=============================================================================
@@ -361,12 +924,21 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef * huart)
 =============================================================================*/
 
 /**
- * @brief Error_Handler is called whenever an unexpected error happen
- * @note Its behaviour if configurable thants to defines in config.h
+ * @brief Error_Handler is called whenever an error can't be recovered by lower level APIs
+ * @param link[in] pointer to the link_Info structure that encountered the error (other links keep running).
+ * Nothing is done if NULL.
+ * @note Its behaviour if configurable thants to defines in config.h. In RESTART mode, the
+ * link is halted at once and restarted with the same buffers (in PendSV if DEFERRED_PROCESSING is 1).
+ * If the restart fails, the link stays halted.
  */
-static void Error_Handler()
+static void Error_Handler(struct link_Info * link)
 {
-	HAL_StatusTypeDef status = HAL_OK;
+	if (link == NULL)
+	{
+		return;
+	}
+
+	countError(link, FATAL_ERROR);
 
 	if (ERROR_LED)
 	{
@@ -378,30 +950,28 @@ static void Error_Handler()
 		HAL_Delay(ERROR_DELAY);
 	}
 
-	if ((ERROR_HANDLING == STOP) || (ERROR_HANDLING == RESTART))
+	if (ERROR_HANDLING == STOP)
 	{
-		receiver_stop();
-		emitter_stop();
+		receiver_stop(link);
+		emitter_stop(link);
 	}
 
 	if (ERROR_HANDLING == RESTART)
 	{
-		if (MODULE_TYPE == MICROW_RECEIVER)
+		if (link->hdac != NULL)
 		{
-			status = receiver_restart();
+			receiver_halt(link);
 		}
 		else
 		{
-			status = emitter_restart();
-		}
-		if (status != HAL_OK)
-		{
-			/*
-			 * Oh no ! Error_Handler has encountered an error !
-			 * No problem, let's call Error_Handler for help
-			 */
-			Error_Handler();
+			emitter_halt(link);
 		}
+
+#if (DEFERRED_PROCESSING == 1)
+		Scheduler_Post(&(link->events), EVENT_RESTART);
+#else
+		restartLink(link);
+#endif
 	}
 
 	if (ERROR_HANDLING == INFINITE_LOOP)
@@ -414,71 +984,259 @@ static void Error_Handler()
 }
 
 /**
- * @brief Timer_RisingEdgeHandle will be called by low-level MicroW APIs on every rising edge of the timer
+ * @brief Stream_ErrorHandle will be called by MicroW APIs when an error can be recovered
+ * without stopping the link. The error is counted in link_Info.errors.
+ * 
+ * Lower level APIs drop data up to the next synchronization point by themselves
+ * (see errorKind). If UART reception stopped on a receiver, it is resumed here.
+ * 
+ * @param stream[in] pointer to a stream structure of the link, or to one of its HAL handles
+ * @param kind[in] the kind of error
  */
-void Timer_RisingEdgeHandle()
+RAMFUNC void Stream_ErrorHandle(const void * stream, enum errorKind kind)
 {
 	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(stream);
 
-	if (sampleStream.state == ACTIVE)
+	if ((link == NULL) || (kind >= ERROR_KINDS))
 	{
-		if (MODULE_TYPE == MICROW_EMITTER)
+		return;
+	}
+
+	countError(link, kind);
+
+#if RECEIVER_SUPPORT
+	if ((kind == BUFFER_OVERRUN) && (stream == &(link->bitStream)))
+	{
+		// The bit ring is full: UART reception stopped
+#if (DEFERRED_PROCESSING == 1)
+		Scheduler_Post(&(link->events), EVENT_RESYNC);
+#else
+		status = receiver_resync(link);
+#endif
+	}
+#endif
+
+	if (status != HAL_OK)
+	{
+		Error_Handler(link);
+	}
+}
+
+/**
+ * @brief Health_StallHandle will be called by health API when a stage of the link didn't progress
+ * during HEALTH_PERIOD. The stage is recovered in PendSV (directly if DEFERRED_PROCESSING is 0).
+ * @param link[in] pointer to the link_Info structure given to Health_Start
+ * @param stage[in] the stalled stage
+ */
+void Health_StallHandle(struct link_Info * link, enum healthStage stage)
+{
+	if ((link == NULL) || (stage >= HEALTH_STAGES))
+	{
+		return;
+	}
+
+#if (DEFERRED_PROCESSING == 1)
+	Scheduler_Post(&(link->events), EVENT_RECOVER << stage);
+#else
+	if (recoverStage(link, stage) != HAL_OK)
+	{
+		Error_Handler(link);
+	}
+#endif
+}
+
+/**
+ * @brief Timer_RisingEdgeHandle will be called by low-level MicroW APIs on every rising edge of the timer
+ * @param htim[in] pointer to the TIM_HandleTypeDef structure of the timer. Every link sampled by this timer is updated.
+ */
+RAMFUNC void Timer_RisingEdgeHandle(TIM_HandleTypeDef * htim)
+{
+	HAL_StatusTypeDef status;
+	struct link_Info * link;
+	uint8_t i;
+
+	for (i = 0; i < MAX_LINKS; i++)
+	{
+		link = links[i];
+		if ((link == NULL) || (link->htim != htim) || (link->sampleStream.state != ACTIVE))
 		{
-			status = ADC_streamRestart();
+			continue;
 		}
-		else
+
+		status = HAL_OK;
+#if EMITTER_SUPPORT
+		if (link->hadc != NULL)
 		{
-			status = DAC_streamUpdate();
+			status = ADC_streamRestart(&(link->sampleStream));
 		}
-	}
+#endif
+#if RECEIVER_SUPPORT
+		if (link->hdac != NULL)
+		{
+			status = DAC_streamUpdate(&(link->DAC_output));
+		}
+#endif
 
-	if (status != HAL_OK)
-	{
-		Error_Handler();
+		if (status != HAL_OK)
+		{
+			Error_Handler(link);
+		}
+		else
+		{
+			Boot_Mark(BOOT_FIRST_SAMPLE);
+		}
 	}
 }
 
 /**
  * @brief ADC_FinishedHandle will be called by ADC API when a new value has been successfully stored
+ * @param sampleStream[in] pointer to the sampleStream_Info structure that received the value
  */
-void ADC_FinishedHandle()
+RAMFUNC void ADC_FinishedHandle(struct sampleStream_Info * sampleStream)
 {
 	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(sampleStream);
+
+	if (link == NULL)
+	{
+		return;
+	}
 
-	status = encoder_streamUpdate();
+#if EMITTER_SUPPORT && (DEFERRED_PROCESSING == 1)
+	Scheduler_Post(&(link->events), EVENT_ENCODE);
+#elif EMITTER_SUPPORT
+	status = encoder_streamUpdate(&(link->encoder));
+#endif
 
 	if (status != HAL_OK)
 	{
-		Error_Handler();
+		Error_Handler(link);
 	}
 }
 
 /**
  * @brief encode_FinishedHandle will be called by encoder API when the UART buffer out has been updated
+ * @param bitStream[in] pointer to the bitStream_Info structure that has been updated
  */
-void encode_FinishedHandle()
+RAMFUNC void encode_FinishedHandle(struct bitStream_Info * bitStream)
 {
 	HAL_StatusTypeDef status = HAL_OK;
 
-	status = UARTTx_streamUpdate();
+	status = UARTTx_streamUpdate(bitStream);
 
 	if ((status != HAL_OK) && (status != HAL_BUSY))
 	{
-		Error_Handler();
+		Error_Handler(findLink(bitStream));
 	}
 }
 
 /**
  * @brief UARTRx_FinishedHandle will be called by UART API when the UART buffer in has been updated
+ * @param bitStream[in] pointer to the bitStream_Info structure that has been updated
  */
-void UARTRx_FinishedHandle()
+RAMFUNC void UARTRx_FinishedHandle(struct bitStream_Info * bitStream)
 {
 	HAL_StatusTypeDef status = HAL_OK;
+	struct link_Info * link = findLink(bitStream);
 
-	status = decoder_streamUpdate();
+	if (link == NULL)
+	{
+		return;
+	}
+
+#if RECEIVER_SUPPORT && (DEFERRED_PROCESSING == 1)
+	Scheduler_Post(&(link->events), EVENT_DECODE);
+#elif RECEIVER_SUPPORT
+	status = decoder_streamUpdate(&(link->decoder));
+#endif
 
 	if (status != HAL_OK)
 	{
-		Error_Handler();
+		Error_Handler(link);
+	}
+}
+
+/**
+ * @brief Scheduler_PendingHandle will be called by PendSV, after interrupts posted events
+ * 
+ * Runs the work posted by interrupts (encoding, decoding, interpolation) for
+ * every running link. As PendSV has the lowest priority, any other interrupt
+ * can preempt it: ring buffers are only written by one side, so interrupts
+ * keep moving data meanwhile.
+ */
+RAMFUNC void Scheduler_PendingHandle()
+{
+	HAL_StatusTypeDef status;
+	struct link_Info * link;
+	uint32_t events;
+	uint8_t stage;
+	uint8_t i;
+
+	for (i = 0; i < MAX_LINKS; i++)
+	{
+		link = links[i];
+		if (link == NULL)
+		{
+			continue;
+		}
+
+		events = Scheduler_Take(&(link->events));
+		status = HAL_OK;
+
+		if (events & EVENT_RESTART)
+		{
+			// Other events were posted before the link was halted
+			restartLink(link);
+			continue;
+		}
+
+#if EMITTER_SUPPORT
+		if (events & EVENT_ENCODE)
+		{
+			status = encoder_streamUpdate(&(link->encoder));
+		}
+#endif
+#if RECEIVER_SUPPORT
+		if (events & EVENT_DAC_RESTART)
+		{
+			status = receiver_restartDAC(link);
+		}
+#endif
+
+		for (stage = 0; (stage < HEALTH_STAGES) && (status == HAL_OK); stage++)
+		{
+			if (events & (EVENT_RECOVER << stage))
+			{
+				status = recoverStage(link, stage);
+			}
+		}
+
+#if RECEIVER_SUPPORT
+#if (DAC_INTERPOLATION > 1)
+		// Each half played since the last run is filled: a late PendSV doesn't skip a block
+		if ((events & (EVENT_FIRST_HALF | EVENT_SECOND_HALF)) && (status == HAL_OK))
+		{
+			status = DAC_streamFill(&(link->DAC_output), ((events & EVENT_FIRST_HALF) ? DAC_FIRST_HALF : 0)
+			                        | ((events & EVENT_SECOND_HALF) ? DAC_SECOND_HALF : 0));
+		}
+#endif
+
+		if ((events & EVENT_DECODE) && (status == HAL_OK))
+		{
+			status = decoder_streamUpdate(&(link->decoder));
+		}
+
+		if ((events & EVENT_RESYNC) && (status == HAL_OK))
+		{
+			status = receiver_resync(link);
+		}
+#endif
+
+		// HAL_BUSY: the stream was stopped meanwhile
+		if ((status != HAL_OK) && (status != HAL_BUSY))
+		{
+			Error_Handler(link);
+		}
 	}
 }
@@ -0,0 +1,337 @@
+/**
+  ******************************************************************************
+  * @file           : lossless.c
+  * @brief          : Lossless codec
+  *
+  * Each sample is predicted by a fixed polynomial predictor: x[n-1] (order
+  * 1) or 2 * x[n-1] - x[n-2] (order 2), and the residual is sent with a Rice code:
+  * its quotient by 2^k in unary (ones ended by a zero), then its k LSBs. The
+  * parameter k follows the mean of the recent residuals, on both sides: the
+  * decoder gets the same residuals, so it always has the same k. After
+  * SYNC_PERIOD bytes, the header gives the last two samples, the order and
+  * k, so every block between two synchronization signals can be decoded on
+  * its own. The encoder tries both orders on every sample, and uses the best
+  * one over the last block for the next one: order 2 follows smooth voiced
+  * sounds closely, order 1 amplifies the background noise less.
+  * Decoded samples are exactly the captured ones: codes are never modified
+  * to avoid SYNC_SIGNAL, bits are stuffed instead (see encoder.c).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "codec.h"
+#include "lossless.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SAMPLE_MASK ((1 << SAMPLE_SIZE) - 1)     // SAMPLE_SIZE LSBs are ones
+#define SAMPLE_OFFSET (1 << (SAMPLE_SIZE - 1))   // Mid-scale
+#define K_MAX (SAMPLE_SIZE - 1)                  // Residuals have SAMPLE_SIZE bits once mapped
+#define ESCAPE 8                                 // Quotients from ESCAPE on are sent as ESCAPE ones, then the mapped residual
+#define COUNT_START 4                            // Residuals assumed in sum after a header
+#define COUNT_MAX 16                             // sum and count are halved there: k follows the last residuals
+
+// Codes should fit in CODEC_MAX_CODE_BITS (see codec.h): ESCAPE - 1 ones, a zero and K_MAX bits, or ESCAPE ones and the residual
+#if (SAMPLE_SIZE > 16)
+#error "SAMPLE_SIZE should not be above 16"
+#endif
+
+// The encoder and the decoder keep the state and the header of any codec in buffers of the codec.h sizes
+#if (LOSSLESS_HEADER_SIZE > CODEC_HEADER_SIZE)
+#error "LOSSLESS_HEADER_SIZE should not be above CODEC_HEADER_SIZE"
+#endif
+
+_Static_assert(sizeof(struct lossless_State) <= CODEC_STATE_SIZE, "struct lossless_State should not be larger than CODEC_STATE_SIZE");
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint16_t predict(struct lossless_State * lossless, uint8_t order);
+static uint32_t map(uint16_t sample, uint16_t prediction);
+static void update(struct lossless_State * lossless, uint16_t sample, uint32_t mapped);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief resets the state: mid-scale history
+ *
+ * @param state[IN] pointer to a lossless_State structure
+ */
+void lossless_reset(void * state)
+{
+	struct lossless_State * lossless = state;
+
+	lossless->history[0] = SAMPLE_OFFSET;
+	lossless->history[1] = SAMPLE_OFFSET;
+	lossless->k = 0;
+	lossless->count = COUNT_START;
+	lossless->sum = 0;
+	lossless->order = 2;
+	lossless->cost[0] = 0;
+	lossless->cost[1] = 0;
+}
+
+/**
+ * @brief gives the Rice code of a sample
+ *
+ * @param state[IN] pointer to a lossless_State structure
+ * @param samples[IN] the sample (SAMPLE_SIZE LSBs)
+ * @return the code, with a marker bit above its MSB (variable-length code)
+ */
+RAMFUNC uint32_t lossless_encode(void * state, const uint16_t * samples)
+{
+	struct lossless_State * lossless = state;
+	uint16_t sample = samples[0] & SAMPLE_MASK;
+	const uint8_t k = lossless->k;
+	uint32_t mappedOrders[2];
+	uint32_t mapped;
+	uint32_t quotient;
+	uint32_t code;
+	uint8_t width;
+
+	mappedOrders[0] = map(sample, predict(lossless, 1));
+	mappedOrders[1] = map(sample, predict(lossless, 2));
+	lossless->cost[0] += mappedOrders[0];
+	lossless->cost[1] += mappedOrders[1];
+	mapped = mappedOrders[lossless->order - 1];
+
+	quotient = mapped >> k;
+	if (quotient < ESCAPE)
+	{
+		code = ((((uint32_t)1 << quotient) - 1) << (k + 1)) | (mapped & (((uint32_t)1 << k) - 1));
+		width = quotient + 1 + k;
+	}
+	else
+	{
+		code = ((((uint32_t)1 << ESCAPE) - 1) << SAMPLE_SIZE) | mapped;
+		width = ESCAPE + SAMPLE_SIZE;
+	}
+
+	update(lossless, sample, mapped);
+	return code | ((uint32_t)1 << width);
+}
+
+/**
+ * @brief gives the width of the next code
+ *
+ * @param state[IN] pointer to a lossless_State structure
+ * @param bits[IN] received bits, the next code starting at the MSB of the count LSBs
+ * @param count[IN] number of received bits (up to 31)
+ * @return the width of the code, 0 if it isn't complete yet
+ */
+RAMFUNC uint8_t lossless_measure(void * state, uint32_t bits, uint8_t count)
+{
+	struct lossless_State * lossless = state;
+	uint8_t ones;
+	uint8_t width;
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	// Ones from the MSB (the LSBs shifted in are zeros)
+	ones = __CLZ(~(bits << (32 - count)));
+	if (ones >= ESCAPE)
+	{
+		width = ESCAPE + SAMPLE_SIZE;
+	}
+	else if (ones == count)
+	{
+		return 0;
+	}
+	else
+	{
+		width = ones + 1 + lossless->k;
+	}
+
+	return (width <= count) ? width : 0;
+}
+
+/**
+ * @brief gives the sample of a Rice code
+ *
+ * @param state[IN] pointer to a lossless_State structure
+ * @param code[IN] the code, with a marker bit above its MSB
+ * @param samples[OUT] the sample (SAMPLE_SIZE LSBs)
+ */
+RAMFUNC void lossless_decode(void * state, uint32_t code, uint16_t * samples)
+{
+	struct lossless_State * lossless = state;
+	const uint8_t k = lossless->k;
+	uint8_t width = 31 - __CLZ(code);
+	uint8_t ones;
+	uint32_t mapped;
+	int32_t residual;
+	uint16_t sample;
+
+	code ^= (uint32_t)1 << width;
+	ones = __CLZ(~(code << (32 - width)));
+	if (ones >= ESCAPE)
+	{
+		mapped = code & SAMPLE_MASK;
+	}
+	else
+	{
+		mapped = ((uint32_t)ones << k) | (code & (((uint32_t)1 << k) - 1));
+	}
+
+	residual = (mapped & 1) ? -(int32_t)((mapped + 1) >> 1) : (int32_t)(mapped >> 1);
+	sample = (uint16_t)(predict(lossless, lossless->order) + residual) & SAMPLE_MASK;
+
+	update(lossless, sample, mapped);
+	samples[0] = sample;
+}
+
+/**
+ * @brief gives the last two samples, the order and the Rice parameter of the encoder
+ *
+ * The order with the smallest residuals since the last header is used up
+ * to the next one. The mean of the residuals restarts from k, like on the
+ * decoder. Every byte is below 0x80: a header is never taken for a
+ * synchronization signal.
+ *
+ * @param state[IN] pointer to a lossless_State structure
+ * @param header[OUT] LOSSLESS_HEADER_SIZE bytes
+ */
+RAMFUNC void lossless_getHeader(void * state, uint8_t * header)
+{
+	struct lossless_State * lossless = state;
+	uint64_t packed;
+	uint8_t i;
+
+	lossless->order = (lossless->cost[0] <= lossless->cost[1]) ? 1 : 2;
+	lossless->cost[0] = 0;
+	lossless->cost[1] = 0;
+
+	packed = ((uint64_t)lossless->history[0] << 22) | ((uint64_t)lossless->history[1] << 6)
+	         | ((uint64_t)(lossless->order - 1) << 5) | lossless->k;
+
+	for (i = 0; i < LOSSLESS_HEADER_SIZE; i++)
+	{
+		header[i] = (uint8_t)(packed >> (7 * (LOSSLESS_HEADER_SIZE - 1 - i))) & 0x7F;
+	}
+
+	lossless->count = COUNT_START;
+	lossless->sum = (uint32_t)COUNT_START << lossless->k;
+}
+
+/**
+ * @brief sets the last two samples, the order and the Rice parameter of the decoder
+ *
+ * @param state[IN] pointer to a lossless_State structure
+ * @param header[IN] LOSSLESS_HEADER_SIZE bytes given by lossless_getHeader
+ */
+RAMFUNC void lossless_setHeader(void * state, const uint8_t * header)
+{
+	struct lossless_State * lossless = state;
+	uint64_t packed = 0;
+	uint8_t i;
+
+	for (i = 0; i < LOSSLESS_HEADER_SIZE; i++)
+	{
+		packed = (packed << 7) | header[i];
+	}
+
+	lossless->history[0] = (uint16_t)(packed >> 22) & SAMPLE_MASK;
+	lossless->history[1] = (uint16_t)(packed >> 6) & SAMPLE_MASK;
+	lossless->order = ((packed >> 5) & 0x01) + 1;
+	lossless->k = (uint8_t)(packed & 0x1F);
+	if (lossless->k > K_MAX)
+	{
+		lossless->k = K_MAX;
+	}
+
+	lossless->count = COUNT_START;
+	lossless->sum = (uint32_t)COUNT_START << lossless->k;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief predicts the next sample: the last one (order 1), or the linear extrapolation of the last two (order 2)
+ *
+ * @param lossless[IN] pointer to the lossless_State structure
+ * @param order[IN] the order (1 or 2)
+ * @return the prediction, clamped to the range of samples
+ */
+static RAMFUNC uint16_t predict(struct lossless_State * lossless, uint8_t order)
+{
+	int32_t prediction = lossless->history[0];
+
+	if (order == 2)
+	{
+		prediction = 2 * prediction - (int32_t)lossless->history[1];
+	}
+
+	if (prediction < 0)
+	{
+		prediction = 0;
+	}
+	else if (prediction > SAMPLE_MASK)
+	{
+		prediction = SAMPLE_MASK;
+	}
+
+	return (uint16_t)prediction;
+}
+
+/**
+ * @brief gives the residual of a sample modulo 2^SAMPLE_SIZE, mapped to unsigned (0, -1, 1, -2...)
+ *
+ * @param sample[IN] the sample
+ * @param prediction[IN] its prediction
+ * @return the mapped residual, below 2^SAMPLE_SIZE
+ */
+static RAMFUNC uint32_t map(uint16_t sample, uint16_t prediction)
+{
+	int32_t residual = (int32_t)((uint32_t)(sample - prediction) << (32 - SAMPLE_SIZE)) >> (32 - SAMPLE_SIZE);
+
+	return (residual >= 0) ? ((uint32_t)residual << 1) : (((uint32_t)(-residual) << 1) - 1);
+}
+
+/**
+ * @brief updates the history and the Rice parameter with a coded sample, like the decoder does
+ *
+ * k is the smallest parameter with count * 2^k at least sum: the mean of
+ * the recent residuals, rounded up to a power of two.
+ *
+ * @param lossless[IN] pointer to the lossless_State structure
+ * @param sample[IN] the sample
+ * @param mapped[IN] its residual, mapped to unsigned
+ */
+static RAMFUNC void update(struct lossless_State * lossless, uint16_t sample, uint32_t mapped)
+{
+	uint8_t k = 0;
+
+	lossless->history[1] = lossless->history[0];
+	lossless->history[0] = sample;
+
+	lossless->sum += mapped;
+	lossless->count += 1;
+	if (lossless->count >= COUNT_MAX)
+	{
+		lossless->sum >>= 1;
+		lossless->count >>= 1;
+	}
+
+	while ((k < K_MAX) && (((uint32_t)lossless->count << k) < lossless->sum))
+	{
+		k++;
+	}
+	lossless->k = k;
+}
@@ -25,6 +25,13 @@
 /* USER CODE BEGIN Includes */
 #include "links.h"
 #include "config.h"
+#include "power.h"
+#include "timer.h"
+#include "role.h"
+#include "priority.h"
+#include "rtos.h"
+#include "health.h"
+#include "boot.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -54,7 +61,8 @@ DMA_HandleTypeDef hdma_usart1_rx;
 DMA_HandleTypeDef hdma_usart1_tx;
 
 /* USER CODE BEGIN PV */
-
+DMA_HandleTypeDef hdma_dac1; /** DAC channel 1 DMA (DMA1 stream 5), not in the CubeMX project: see HAL_DAC_MspInit */
+static struct link_Info link; /** Emitter or receiver, depending on Role_Get() (SRAM, accessed by DMA) */
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -66,12 +74,29 @@ static void MX_DAC_Init(void);
 static void MX_USART1_UART_Init(void);
 static void MX_TIM2_Init(void);
 /* USER CODE BEGIN PFP */
-
+#if (FAST_BOOT == 1)
+static void deferredInit(void);
+#endif
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+#if (FAST_BOOT == 1)
+/**
+  * @brief Setup the audio path doesn't need, done once it runs
+  * @retval None
+  */
+static void deferredInit(void)
+{
+  // Reads the cause of the last reset, then starts the watchdog
+  Health_Init();
 
+  if (Power_GateUnused() != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+#endif
 /* USER CODE END 0 */
 
 /**
@@ -81,7 +106,7 @@ static void MX_TIM2_Init(void);
 int main(void)
 {
   /* USER CODE BEGIN 1 */
-
+  Boot_Init();
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -90,28 +115,82 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-
+#if (FAST_BOOT == 0)
+  // Reads the cause of the last reset, then starts the watchdog
+  Health_Init();
+#endif
   /* USER CODE END Init */
 
   /* Configure the system clock */
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  // The clock frequency and peripherals depend on the role
+  Role_Init();
 
+  if (Power_ClockConfig() != HAL_OK)
+  {
+    Error_Handler();
+  }
+  Boot_Mark(BOOT_CLOCK);
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
   MX_DMA_Init();
-  MX_ADC1_Init();
-  MX_DAC_Init();
   MX_USART1_UART_Init();
   MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
-#if (MODULE_TYPE == MICROW_EMITTER)
-  emitter_start(&huart1, &hadc1, &htim2);
+  // Only the converter of this role is initialized: "Do Not Generate Function Call"
+  // is set for MX_ADC1_Init and MX_DAC_Init (CubeMX Project Manager, Advanced Settings)
+  if (Role_Get() == MICROW_EMITTER)
+  {
+    MX_ADC1_Init();
+  }
+  else
+  {
+    // DMA1 only feeds the DAC (stream 5, see HAL_DAC_MspInit), its priority is set by Priority_Init()
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+    MX_DAC_Init();
+  }
+
+#if (FAST_BOOT == 0)
+  if (Power_GateUnused() != HAL_OK)
+  {
+    Error_Handler();
+  }
+#endif
+
+  // Overwrites the priorities set by CubeMX (see config.h)
+  if (Priority_Init() != HAL_OK)
+  {
+    Error_Handler();
+  }
+  Boot_Mark(BOOT_PERIPHERALS);
+
+#if (RTOS_SUPPORT == 1)
+#if (FAST_BOOT == 1)
+  // Rtos_Start never returns: the setup can't wait for the link
+  deferredInit();
+#endif
+  // The control task starts the link, deferred work runs in the audio task. Never returns
+  Rtos_Start(&link);
 #else
-  receiver_start(&huart1, &hdac, DAC_CHANNEL_1, &htim2);
+  if (Role_Get() == MICROW_EMITTER)
+  {
+    emitter_start(&link, &huart1, &hadc1, &htim2);
+  }
+  else
+  {
+    receiver_start(&link, &huart1, &hdac, DAC_CHANNEL_1, &htim2);
+  }
+
+#if (FAST_BOOT == 1)
+  // The audio path is running: the remaining setup is done meanwhile
+  deferredInit();
+#endif
+  Boot_Mark(BOOT_READY);
 #endif
   /* USER CODE END 2 */
 
@@ -122,6 +201,8 @@ int main(void)
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
+    Power_Sleep();
+    Health_Check(&link);
   }
   /* USER CODE END 3 */
 }
@@ -258,7 +339,15 @@ static void MX_DAC_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN DAC_Init 2 */
-
+#if (DAC_INTERPOLATION > 1)
+  /** The DAC takes a new value from DMA on every TIM2 trigger output
+  */
+  sConfig.DAC_Trigger = DAC_TRIGGER_T2_TRGO;
+  if (HAL_DAC_ConfigChannel(&hdac, &sConfig, DAC_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+#endif
   /* USER CODE END DAC_Init 2 */
 
 }
@@ -303,7 +392,30 @@ static void MX_TIM2_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN TIM2_Init 2 */
-
+  /** The period depends on the clock selected by Power_ClockConfig()
+  */
+  if ((Role_Get() == MICROW_RECEIVER) && (DAC_INTERPOLATION > 1))
+  {
+    /** Trigger the DAC DAC_INTERPOLATION times per sampling period
+    */
+    htim2.Init.Period = (Timer_GetClock(&htim2) / (SAMPLING_FREQUENCY * DAC_INTERPOLATION)) - 1;
+  }
+  else
+  {
+    htim2.Init.Period = (Timer_GetClock(&htim2) / SAMPLING_FREQUENCY) - 1;
+  }
+  if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if ((Role_Get() == MICROW_RECEIVER) && (DAC_INTERPOLATION > 1))
+  {
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+    if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
+    {
+      Error_Handler();
+    }
+  }
   /* USER CODE END TIM2_Init 2 */
 
 }
@@ -386,7 +498,39 @@ static void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 4 */
+#if (RTOS_SUPPORT == 1)
+/**
+  * @brief  Starts or stops the link, called by the control task (see rtos.c)
+  * @param  command: RTOS_START or RTOS_STOP
+  * @retval None
+  */
+void Rtos_ControlHandle(uint32_t command)
+{
+  if (command == RTOS_STOP)
+  {
+    if (Role_Get() == MICROW_EMITTER)
+    {
+      emitter_stop(&link);
+    }
+    else
+    {
+      receiver_stop(&link);
+    }
+  }
 
+  if (command == RTOS_START)
+  {
+    if (Role_Get() == MICROW_EMITTER)
+    {
+      emitter_start(&link, &huart1, &hadc1, &htim2);
+    }
+    else
+    {
+      receiver_start(&link, &huart1, &hdac, DAC_CHANNEL_1, &htim2);
+    }
+  }
+}
+#endif
 /* USER CODE END 4 */
 
 /**
@@ -0,0 +1,246 @@
+/**
+  ******************************************************************************
+  * @file           : pipeline.c
+  * @brief          : Frame pipeline API
+  *
+  * Samples are gathered in frames of FRAME_SIZE samples (10ms by default),
+  * then every stage of a constant table processes the whole frame in turn:
+  * filters, codecs, concealment... On the emitter, the frame comes from the
+  * ADC and goes to the encoder. On the receiver, it comes from the decoder
+  * and goes to the DAC.
+  * Stages are chosen at compile time by editing the tables below: adding a
+  * stage doesn't change the encoder, the decoder or links.c. There is one
+  * indirect call per stage and per frame, and the cost of each stage is
+  * measured on every frame.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "pipeline.h"
+#include "cycles.h"
+#include "filter.h"
+#include "howl.h"
+#include "denoise.h"
+#include "agc.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SAMPLE_OFFSET (1 << (SAMPLE_SIZE - 1))   // Mid-scale, 0 once centered
+#define STATE_WORDS ((PIPELINE_STATE_SIZE + 3) / 4)
+
+#if (FRAME_SIZE < 1)
+#error "FRAME_SIZE should be at least 1"
+#endif
+
+#if (PIPELINE_MAX_STAGES < 1) || (PIPELINE_STATE_SIZE < 1)
+#error "PIPELINE_MAX_STAGES and PIPELINE_STATE_SIZE should be at least 1"
+#endif
+
+/* Stage tables --------------------------------------------------------------*/
+
+/*
+ * Stages run in table order on every frame. To add a stage, insert its
+ * stage_Info entry before PIPELINE_END (at most PIPELINE_MAX_STAGES stages,
+ * states of all stages fitting in PIPELINE_STATE_SIZE bytes).
+ */
+
+// Between the ADC and the encoder
+const struct stage_Info pipeline_emitterStages[] =
+{
+#if (SPEECH_FILTER == 1)
+	{ "Speech filter", filter_StartEmitter, filter_Process, sizeof(struct biquad_Info) },
+#endif
+#if (HOWL_SUPPRESSION == 1)
+	{ "Howling suppression", howl_Start, howl_Process, sizeof(struct howl_State) },
+#endif
+#if (NOISE_SUPPRESSION == 1)
+	{ "Noise suppression", denoise_Start, denoise_Process, sizeof(struct denoise_State) },
+#endif
+#if (AGC == 1)
+	{ "Automatic gain control", agc_Start, agc_Process, sizeof(struct agc_State) },
+#endif
+	PIPELINE_END
+};
+
+// Between the decoder and the DAC
+const struct stage_Info pipeline_receiverStages[] =
+{
+#if (SPEECH_FILTER == 1)
+	{ "Speech filter", filter_StartReceiver, filter_Process, sizeof(struct biquad_Info) },
+#endif
+	PIPELINE_END
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief gives a state to every stage of a table and resets them
+ *
+ * @param pipeline[IN] pointer to the pipeline_Info structure, used as a handle by other pipeline functions
+ * @param stages[IN] stage table, terminated by PIPELINE_END
+ * @return HAL status (HAL_ERROR if the table has more than PIPELINE_MAX_STAGES stages
+ * or if their states don't fit in PIPELINE_STATE_SIZE bytes).
+ */
+HAL_StatusTypeDef pipeline_Start(struct pipeline_Info * pipeline, const struct stage_Info * stages)
+{
+	HAL_StatusTypeDef status;
+	uint16_t used = 0;
+	uint16_t words;
+	uint8_t i;
+
+	if ((pipeline == NULL) || (stages == NULL))
+	{
+		return HAL_ERROR;
+	}
+
+	pipeline->stages = stages;
+	pipeline->stageCount = 0;
+	pipeline->length = 0;
+
+	Cycles_Init();
+
+	for (i = 0; stages[i].process != NULL; i++)
+	{
+		if (i >= PIPELINE_MAX_STAGES)
+		{
+			return HAL_ERROR;
+		}
+
+		// States are word-aligned
+		words = (stages[i].stateSize + 3) / 4;
+		if (used + words > STATE_WORDS)
+		{
+			return HAL_ERROR;
+		}
+
+		pipeline->states[i] = (words != 0) ? &(pipeline->stateMemory[used]) : NULL;
+		used += words;
+
+		Cycles_Reset(&(pipeline->cycles[i]));
+
+		if (stages[i].start != NULL)
+		{
+			status = stages[i].start(pipeline->states[i]);
+			if (status != HAL_OK)
+			{
+				return status;
+			}
+		}
+	}
+
+	pipeline->stageCount = i;
+	return HAL_OK;
+}
+
+/**
+ * @brief runs every stage on the frame
+ *
+ * Samples are centered on 0 before the first stage, then brought back to
+ * SAMPLE_SIZE unsigned bits after the last one (saturating stages overflows).
+ * Nothing is done if the table is empty.
+ *
+ * @param pipeline[IN] pointer to the pipeline_Info structure given to pipeline_Start
+ * @return HAL status (HAL_OK if no errors occured).
+ * @note frame should contain FRAME_SIZE samples. length isn't modified: it's
+ * up to the caller to reset it once the frame has been used
+ */
+RAMFUNC HAL_StatusTypeDef pipeline_Process(struct pipeline_Info * pipeline)
+{
+	HAL_StatusTypeDef status;
+	int16_t * frame = (int16_t *)pipeline->frame;
+	int32_t value;
+	uint16_t i;
+	uint8_t stage;
+
+	if (pipeline->stageCount == 0)
+	{
+		return HAL_OK;
+	}
+
+	for (i = 0; i < FRAME_SIZE; i++)
+	{
+		frame[i] = (int16_t)((int32_t)pipeline->frame[i] - SAMPLE_OFFSET);
+	}
+
+	for (stage = 0; stage < pipeline->stageCount; stage++)
+	{
+		Cycles_Start(&(pipeline->cycles[stage]));
+		status = pipeline->stages[stage].process(pipeline->states[stage], frame, FRAME_SIZE);
+		Cycles_Stop(&(pipeline->cycles[stage]));
+
+		if (status != HAL_OK)
+		{
+			return status;
+		}
+	}
+
+	for (i = 0; i < FRAME_SIZE; i++)
+	{
+		value = frame[i];
+		if (value < -SAMPLE_OFFSET)
+		{
+			value = -SAMPLE_OFFSET;
+		}
+		else if (value > SAMPLE_OFFSET - 1)
+		{
+			value = SAMPLE_OFFSET - 1;
+		}
+		pipeline->frame[i] = (uint16_t)(value + SAMPLE_OFFSET);
+	}
+
+	return HAL_OK;
+}
+
+/**
+ * @brief gives the CPU cost of a stage
+ *
+ * @param pipeline[IN] pointer to the pipeline_Info structure given to pipeline_Start
+ * @param stage[IN] position of the stage in its table
+ * @return pointer to the measurements of the stage (CPU cycles per frame), NULL if there's no such stage
+ */
+const struct cycles_Info * pipeline_getCycles(struct pipeline_Info * pipeline, uint8_t stage)
+{
+	if (stage >= pipeline->stageCount)
+	{
+		return NULL;
+	}
+
+	return &(pipeline->cycles[stage]);
+}
+
+/**
+ * @brief gives the state of a stage, to read what it measured (gains, levels...)
+ *
+ * @param pipeline[IN] pointer to the pipeline_Info structure given to pipeline_Start
+ * @param process[IN] process function of the stage (first stage using it)
+ * @return pointer to the state of the stage, NULL if the pipeline doesn't run it or if it has no state
+ */
+void * pipeline_findState(struct pipeline_Info * pipeline, HAL_StatusTypeDef (* process)(void * state, int16_t * frame, uint16_t length))
+{
+	uint8_t stage;
+
+	for (stage = 0; stage < pipeline->stageCount; stage++)
+	{
+		if (pipeline->stages[stage].process == process)
+		{
+			return pipeline->states[stage];
+		}
+	}
+
+	return NULL;
+}
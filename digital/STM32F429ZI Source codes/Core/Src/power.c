@@ -0,0 +1,215 @@
+/**
+  ******************************************************************************
+  * @file           : power.c
+  * @brief          : Power API
+  *
+  * When POWER_MODE is LOW_POWER, the system clock is lowered to the minimum
+  * frequency meeting the CPU budget of the module, peripherals used by the
+  * other module type are turned off, and the CPU sleeps between interrupts.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "power.h"
+#include "role.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SYSCLK_MAX 180000000
+#define SYSCLK_STEP 1000000         // The PLL is fed by HSI / 8 = 2MHz, SYSCLK is set by 1MHz steps
+#define SYSCLK_MIN 13000000         // Lowest frequency reachable with PLLP = 8 (VCO >= 100MHz)
+#define VCO_MIN 100000000
+#define FLASH_WAIT_STATE_STEP 30000000  // One flash wait state every 30MHz (2.7V to 3.6V)
+
+#define EMITTER_TIMER_RATE SAMPLING_FREQUENCY
+#define RECEIVER_TIMER_RATE (SAMPLING_FREQUENCY * DAC_INTERPOLATION)
+
+#if (CPU_LOAD_MAX < 1) || (CPU_LOAD_MAX > 100)
+#error "CPU_LOAD_MAX should be between 1 and 100"
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief computes the lowest system clock meeting the CPU budget of the module
+ *
+ * The frequency gives at least the cycles per sample of the role (see Role_Get) while
+ * keeping the CPU load under CPU_LOAD_MAX. It is also a multiple of twice the
+ * timer rate, so that TIM2 (clocked at SYSCLK or SYSCLK/2) divides it exactly.
+ * The result is only as good as the budget: EMITTER_CYCLES_PER_SAMPLE and
+ * RECEIVER_CYCLES_PER_SAMPLE should be measured on the build (see config.h).
+ *
+ * @return the system clock frequency (Hz)
+ */
+uint32_t Power_GetMinSysclk()
+{
+	uint32_t cyclesPerSample;
+	uint32_t timerRate;
+	uint32_t required;
+	uint32_t sysclk;
+
+	if (Role_Get() == MICROW_EMITTER)
+	{
+		cyclesPerSample = EMITTER_CYCLES_PER_SAMPLE;
+		timerRate = EMITTER_TIMER_RATE;
+	}
+	else
+	{
+		cyclesPerSample = RECEIVER_CYCLES_PER_SAMPLE;
+		timerRate = RECEIVER_TIMER_RATE;
+	}
+	required = (cyclesPerSample * SAMPLING_FREQUENCY / CPU_LOAD_MAX) * 100;
+
+	for (sysclk = SYSCLK_MIN; sysclk < SYSCLK_MAX; sysclk += SYSCLK_STEP)
+	{
+		if ((sysclk >= required) && (sysclk % (2 * timerRate) == 0))
+		{
+			return sysclk;
+		}
+	}
+
+	return SYSCLK_MAX;
+}
+
+/**
+ * @brief configures clocks according to POWER_MODE
+ *
+ * Should be called after SystemClock_Config(), before peripherals initialization
+ * (UART baud rate and ADC clock depend on bus frequencies).
+ * Nothing is changed if POWER_MODE is FULL_SPEED.
+ *
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+HAL_StatusTypeDef Power_ClockConfig()
+{
+	HAL_StatusTypeDef status = HAL_OK;
+#if (POWER_MODE == LOW_POWER)
+	RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+	RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+	uint32_t sysclk = Power_GetMinSysclk();
+	uint32_t PLLP = RCC_PLLP_DIV2;
+
+	// The PLL can't be modified while it drives SYSCLK, HSI takes over meanwhile
+	RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+	                            |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+	RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+	RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
+	RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+	status = HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0);
+	if (status != HAL_OK)
+	{
+		return status;
+	}
+
+	RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_OFF;
+	status = HAL_RCC_OscConfig(&RCC_OscInitStruct);
+	if (status != HAL_OK)
+	{
+		return status;
+	}
+
+	// Over-drive is only needed above 168MHz, voltage scale 1 above 144MHz
+	if (sysclk <= 168000000)
+	{
+		status = HAL_PWREx_DisableOverDrive();
+		if (status != HAL_OK)
+		{
+			return status;
+		}
+	}
+
+	if (sysclk <= 120000000)
+	{
+		__HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE3);
+	}
+	else if (sysclk <= 144000000)
+	{
+		__HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE2);
+	}
+	else
+	{
+		__HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+	}
+
+	// SYSCLK = 2MHz * PLLN / PLLP, with the smallest PLLP keeping the VCO above 100MHz
+	while (sysclk * PLLP < VCO_MIN)
+	{
+		PLLP += 2;
+	}
+
+	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+	RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+	RCC_OscInitStruct.PLL.PLLM = 8;
+	RCC_OscInitStruct.PLL.PLLN = (sysclk / 1000000) * PLLP / 2;
+	RCC_OscInitStruct.PLL.PLLP = PLLP;
+	RCC_OscInitStruct.PLL.PLLQ = 4;
+	status = HAL_RCC_OscConfig(&RCC_OscInitStruct);
+	if (status != HAL_OK)
+	{
+		return status;
+	}
+
+	// Keep PCLK1 <= 45MHz and PCLK2 <= 90MHz, timers run at twice PCLK1
+	RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+	if (sysclk <= 90000000)
+	{
+		RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;
+		RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+	}
+	else
+	{
+		RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+		RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
+	}
+	status = HAL_RCC_ClockConfig(&RCC_ClkInitStruct, (sysclk - 1) / FLASH_WAIT_STATE_STEP);
+#endif
+	return status;
+}
+
+/**
+ * @brief turns off peripherals that the module role doesn't use
+ *
+ * The ADC (emitter) or the DAC (receiver) of the other role, and DMA1 on
+ * the emitter (only used by the DAC), are never initialized (see main.c).
+ * The flash interface clock is also stopped while the CPU sleeps: DMA only reaches SRAM.
+ * Nothing is changed if POWER_MODE is FULL_SPEED.
+ *
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+HAL_StatusTypeDef Power_GateUnused()
+{
+	HAL_StatusTypeDef status = HAL_OK;
+#if (POWER_MODE == LOW_POWER)
+	__HAL_RCC_FLITF_CLK_SLEEP_DISABLE();
+#endif
+	return status;
+}
+
+/**
+ * @brief waits for the next interrupt
+ *
+ * The CPU clock is stopped until an interrupt occurs (sleep mode),
+ * peripherals and DMA keep running. Returns immediately if POWER_MODE is FULL_SPEED.
+ */
+void Power_Sleep()
+{
+#if (POWER_MODE == LOW_POWER)
+	HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+#endif
+}
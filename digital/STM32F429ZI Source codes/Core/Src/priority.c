@@ -0,0 +1,123 @@
+/**
+  ******************************************************************************
+  * @file           : priority.c
+  * @brief          : Priority API
+  *
+  * Interrupts are sorted in three levels, set in config.h:
+  * - the sample clock (TIM2), whose latency is the sampling jitter, preempts
+  *   everything else;
+  * - the serial line (USART1 and its DMA streams) and SysTick, which have a
+  *   deadline of one byte;
+  * - the converters (ADC, DAC DMA and underrun), which have a deadline of one
+  *   sample.
+  * Deferred work (PendSV) stays below all of them, see scheduler.c.
+  * CubeMX priorities are kept in the generated code and overwritten here, so
+  * the whole plan lives in one table.
+  * Data shared by interrupts of different levels (other than ring buffers,
+  * which have a single writer per index) is modified in critical sections of
+  * a few instructions.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "priority.h"
+#include "scheduler.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#if (SAMPLE_CLOCK_PRIORITY >= SERIAL_PRIORITY) || (SAMPLE_CLOCK_PRIORITY >= CONVERTER_PRIORITY)
+#error "SAMPLE_CLOCK_PRIORITY should be the highest priority (lowest value)"
+#endif
+
+#if (SERIAL_PRIORITY >= SCHEDULER_PRIORITY) || (CONVERTER_PRIORITY >= SCHEDULER_PRIORITY)
+#error "SERIAL_PRIORITY and CONVERTER_PRIORITY should be above the scheduler (lower than 15)"
+#endif
+
+/* Private types -------------------------------------------------------------*/
+
+struct priority_Info
+{
+	IRQn_Type IRQn;
+	uint32_t priority;
+};
+
+/* Private variables ---------------------------------------------------------*/
+
+/*
+ * Priority of every interrupt used by MicroW (preemption priority, no sub-priority:
+ * HAL_Init selects NVIC_PRIORITYGROUP_4)
+ */
+static const struct priority_Info priorities[] =
+{
+	{ TIM2_IRQn, SAMPLE_CLOCK_PRIORITY },      // Starts ADC conversions, or refreshes the DAC
+	{ USART1_IRQn, SERIAL_PRIORITY },
+	{ DMA2_Stream2_IRQn, SERIAL_PRIORITY },    // USART1 reception
+	{ DMA2_Stream7_IRQn, SERIAL_PRIORITY },    // USART1 transmission
+	{ ADC_IRQn, CONVERTER_PRIORITY },
+	{ DMA1_Stream5_IRQn, CONVERTER_PRIORITY }, // DAC channel 1
+	{ TIM6_DAC_IRQn, CONVERTER_PRIORITY },     // DAC underrun
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief applies the interrupt priority plan
+ *
+ * Should be called after peripherals initialization (their MSP functions set
+ * CubeMX priorities), before the links are started.
+ *
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+HAL_StatusTypeDef Priority_Init()
+{
+	uint8_t i;
+
+	for (i = 0; i < sizeof(priorities) / sizeof(priorities[0]); i++)
+	{
+		HAL_NVIC_SetPriority(priorities[i].IRQn, priorities[i].priority, 0);
+	}
+
+	// Also kept by later clock changes (HAL_RCC_ClockConfig)
+	return HAL_InitTick(TICK_PRIORITY);
+}
+
+/**
+ * @brief masks every interrupt, including the sample clock
+ *
+ * The sample clock is delayed by the length of the critical section: it
+ * should only contain a few instructions. Critical sections can be nested.
+ *
+ * @return the previous mask, to give to Priority_ExitCritical
+ */
+RAMFUNC uint32_t Priority_EnterCritical()
+{
+	uint32_t state = __get_PRIMASK();
+
+	__disable_irq();
+	return state;
+}
+
+/**
+ * @brief ends a critical section started by Priority_EnterCritical
+ *
+ * @param state[IN] value returned by Priority_EnterCritical
+ */
+RAMFUNC void Priority_ExitCritical(uint32_t state)
+{
+	__set_PRIMASK(state);
+}
@@ -0,0 +1,238 @@
+/**
+  ******************************************************************************
+  * @file           : ring.c
+  * @brief          : Ring buffer API
+  *
+  * Lock-free ring buffer for one producer and one consumer, for example an
+  * interrupt filling the buffer and another one emptying it.
+  * The producer only writes head, the consumer only writes tail. A memory
+  * barrier makes sure that data is written (or read) before the other side
+  * can see the new counter value.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "ring.h"
+#include "sections.h"
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief initializes an empty ring buffer
+ *
+ * @param ring[IN] pointer to the ring_Info structure, used as a handle by other ring functions
+ * @param buffer[IN] storage of size * elementSize bytes
+ * @param size[IN] number of elements (a power of two, below RING_SIZE_MAX)
+ * @param elementSize[IN] size of one element (bytes)
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+HAL_StatusTypeDef ring_Init(struct ring_Info * ring, void * buffer, uint16_t size, uint8_t elementSize)
+{
+	if ((ring == NULL) || (buffer == NULL) || (elementSize == 0) || !RING_VALID_SIZE(size))
+	{
+		return HAL_ERROR;
+	}
+
+	ring->buffer = (uint8_t *)buffer;
+	ring->mask = size - 1;
+	ring->elementSize = elementSize;
+	ring_Reset(ring);
+
+	return HAL_OK;
+}
+
+/**
+ * @brief empties a ring buffer
+ *
+ * @param ring[IN] pointer to the ring_Info structure given to ring_Init
+ * @warning neither the producer nor the consumer should be using the ring meanwhile
+ */
+void ring_Reset(struct ring_Info * ring)
+{
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+/**
+ * @brief gives the number of elements that can be read
+ *
+ * @param ring[IN] pointer to the ring_Info structure given to ring_Init
+ * @return number of elements
+ */
+RAMFUNC uint16_t ring_Count(const struct ring_Info * ring)
+{
+	return (uint16_t)(ring->head - ring->tail);
+}
+
+/**
+ * @brief gives the number of elements that can be written
+ *
+ * @param ring[IN] pointer to the ring_Info structure given to ring_Init
+ * @return number of elements
+ */
+RAMFUNC uint16_t ring_Space(const struct ring_Info * ring)
+{
+	return (uint16_t)(ring->mask + 1 - ring_Count(ring));
+}
+
+/*=============================================================================
+                      ##### Producer functions #####
+=============================================================================*/
+
+/**
+ * @brief copies elements into the ring buffer
+ *
+ * @param ring[IN] pointer to the ring_Info structure given to ring_Init
+ * @param data[IN] elements to write
+ * @param count[IN] number of elements to write
+ * @return number of elements written (below count if the ring is full)
+ */
+RAMFUNC uint16_t ring_Write(struct ring_Info * ring, const void * data, uint16_t count)
+{
+	const uint8_t * source = (const uint8_t *)data;
+	uint16_t written = 0;
+	uint16_t length;
+	void * span;
+
+	// At most two spans: before and after the end of the buffer
+	while (written < count)
+	{
+		span = ring_WriteSpan(ring, &length);
+		if (length == 0)
+		{
+			break;
+		}
+		if (length > count - written)
+		{
+			length = count - written;
+		}
+
+		memcpy(span, &(source[written * ring->elementSize]), length * ring->elementSize);
+		ring_Commit(ring, length);
+		written += length;
+	}
+
+	return written;
+}
+
+/**
+ * @brief gives the contiguous free area following the last written element
+ *
+ * Useful to let a peripheral (DMA) or a function write directly into the
+ * buffer. Elements become readable once ring_Commit is called.
+ *
+ * @param ring[IN] pointer to the ring_Info structure given to ring_Init
+ * @param length[OUT] number of elements that can be written at the returned address
+ * @return address of the first free element
+ */
+RAMFUNC void * ring_WriteSpan(struct ring_Info * ring, uint16_t * length)
+{
+	uint16_t position = ring->head & ring->mask;
+	uint16_t contiguous = ring->mask + 1 - position;
+	uint16_t space = ring_Space(ring);
+
+	*length = (space < contiguous) ? space : contiguous;
+	return &(ring->buffer[position * ring->elementSize]);
+}
+
+/**
+ * @brief makes elements written with ring_WriteSpan readable
+ *
+ * @param ring[IN] pointer to the ring_Info structure given to ring_Init
+ * @param count[IN] number of elements written (not above the length given by ring_WriteSpan)
+ */
+RAMFUNC void ring_Commit(struct ring_Info * ring, uint16_t count)
+{
+	// Data must be in memory before the consumer sees the new head
+	__DMB();
+	ring->head += count;
+}
+
+/*=============================================================================
+                      ##### Consumer functions #####
+=============================================================================*/
+
+/**
+ * @brief copies elements out of the ring buffer
+ *
+ * @param ring[IN] pointer to the ring_Info structure given to ring_Init
+ * @param data[OUT] destination of the elements
+ * @param count[IN] maximum number of elements to read
+ * @return number of elements read (below count if the ring is empty)
+ */
+RAMFUNC uint16_t ring_Read(struct ring_Info * ring, void * data, uint16_t count)
+{
+	uint8_t * destination = (uint8_t *)data;
+	uint16_t read = 0;
+	uint16_t length;
+	void * span;
+
+	// At most two spans: before and after the end of the buffer
+	while (read < count)
+	{
+		span = ring_ReadSpan(ring, &length);
+		if (length == 0)
+		{
+			break;
+		}
+		if (length > count - read)
+		{
+			length = count - read;
+		}
+
+		memcpy(&(destination[read * ring->elementSize]), span, length * ring->elementSize);
+		ring_Release(ring, length);
+		read += length;
+	}
+
+	return read;
+}
+
+/**
+ * @brief gives the contiguous readable area starting at the oldest element
+ *
+ * Useful to let a peripheral (DMA) or a function read directly from the
+ * buffer. Elements stay in the ring until ring_Release is called.
+ *
+ * @param ring[IN] pointer to the ring_Info structure given to ring_Init
+ * @param length[OUT] number of elements that can be read at the returned address
+ * @return address of the oldest element
+ */
+RAMFUNC void * ring_ReadSpan(struct ring_Info * ring, uint16_t * length)
+{
+	uint16_t position = ring->tail & ring->mask;
+	uint16_t contiguous = ring->mask + 1 - position;
+	uint16_t count = ring_Count(ring);
+
+	// Data must not be read before the head it belongs to
+	__DMB();
+	*length = (count < contiguous) ? count : contiguous;
+	return &(ring->buffer[position * ring->elementSize]);
+}
+
+/**
+ * @brief gives back to the producer elements read with ring_ReadSpan
+ *
+ * @param ring[IN] pointer to the ring_Info structure given to ring_Init
+ * @param count[IN] number of elements read (not above the length given by ring_ReadSpan)
+ */
+RAMFUNC void ring_Release(struct ring_Info * ring, uint16_t count)
+{
+	// Data must be read before the producer sees the new tail
+	__DMB();
+	ring->tail += count;
+}
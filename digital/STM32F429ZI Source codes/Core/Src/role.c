@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file           : role.c
+  * @brief          : Role API
+  *
+  * When MODULE_TYPE is MICROW_RUNTIME, the same image runs on both modules:
+  * the role is read once at boot from a strap pin (internal pull-up), after
+  * SystemClock_Config() but before Power_ClockConfig() and the peripherals.
+  * Only the peripherals and buffers of this role are then initialized.
+  * Role-specific images don't use this file (see role.h).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "role.h"
+#include "cycles.h"
+#include "sections.h"
+
+#if (MODULE_TYPE == MICROW_RUNTIME)
+
+/* Private defines -----------------------------------------------------------*/
+
+#define STRAP_SETTLING_TIME 20   // Microseconds waited for the pull-up (40kOhm) to charge the pin and 50pF of wiring: about 10 RC
+
+/* Private variables ---------------------------------------------------------*/
+
+static uint8_t role CCMDATA = MICROW_EMITTER;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief reads the role of the module on the strap pin
+ *
+ * The pin is left open (read high thanks to the pull-up) on emitters, and
+ * tied to ground on receivers. It is put back in analog mode afterwards,
+ * its lowest power state.
+ * Should be called once, after SystemClock_Config() (the wait is counted in
+ * cycles of SystemCoreClock), before Power_ClockConfig() and peripherals initialization.
+ */
+void Role_Init()
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	uint32_t start;
+
+	ROLE_STRAP_CLK_ENABLE();
+
+	GPIO_InitStruct.Pin = ROLE_STRAP_PIN;
+	GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct.Pull = GPIO_PULLUP;
+	HAL_GPIO_Init(ROLE_STRAP_PORT, &GPIO_InitStruct);
+
+	Cycles_Init();
+	start = DWT->CYCCNT;
+	while (DWT->CYCCNT - start < STRAP_SETTLING_TIME * (SystemCoreClock / 1000000))
+	{
+		// Wait for the pull-up
+	}
+
+	if (HAL_GPIO_ReadPin(ROLE_STRAP_PORT, ROLE_STRAP_PIN) == GPIO_PIN_SET)
+	{
+		role = MICROW_EMITTER;
+	}
+	else
+	{
+		role = MICROW_RECEIVER;
+	}
+
+	HAL_GPIO_DeInit(ROLE_STRAP_PORT, ROLE_STRAP_PIN);
+}
+
+/**
+ * @brief gives the role read by Role_Init
+ *
+ * @return MICROW_EMITTER or MICROW_RECEIVER
+ */
+RAMFUNC uint8_t Role_Get()
+{
+	return role;
+}
+
+#endif
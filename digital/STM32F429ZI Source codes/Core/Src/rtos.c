@@ -0,0 +1,256 @@
+/**
+  ******************************************************************************
+  * @file           : rtos.c
+  * @brief          : RTOS API
+  *
+  * When RTOS_SUPPORT is 1, deferred work runs in FreeRTOS tasks instead of
+  * PendSV, which FreeRTOS needs for context switches:
+  * - the audio task (highest priority) runs Scheduler_PendingHandle when
+  *   interrupts post events;
+  * - the control task starts and stops the link on request (Rtos_Control),
+  *   and checks its health every HEALTH_PERIOD ms (see health.c);
+  * - the telemetry task takes a snapshot of the link health periodically.
+  * MicroW interrupts stay above configMAX_SYSCALL_INTERRUPT_PRIORITY: kernel
+  * critical sections never delay the sample clock. As they can't call
+  * FreeRTOS functions, Scheduler_Post pends RTOS_WAKE_IRQn, whose handler
+  * notifies the audio task.
+  * The idle task sleeps between ticks (tickless idle), like Power_Sleep.
+  * FreeRTOS sources (kernel and GCC/ARM_CM4F port, no heap file: every
+  * object is static) aren't part of this repository: add them to the build,
+  * they are configured by FreeRTOSConfig.h.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "rtos.h"
+
+#if (RTOS_SUPPORT == 1)
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "links.h"
+#include "scheduler.h"
+#include "timer.h"
+#include "health.h"
+#include "agc.h"
+#include "howl.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define AUDIO_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#define CONTROL_TASK_PRIORITY 2
+#define TELEMETRY_TASK_PRIORITY 1
+
+// Stack sizes (words): the audio task runs the encoder or the decoder and the pipeline
+#define AUDIO_STACK_SIZE 512
+#define CONTROL_STACK_SIZE 256
+#define TELEMETRY_STACK_SIZE 128
+
+#if (SERIAL_PRIORITY >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY) || (CONVERTER_PRIORITY >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY)
+#error "MicroW interrupts should be above configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY (lower values)"
+#endif
+
+#if (TELEMETRY_PERIOD < 1)
+#error "TELEMETRY_PERIOD should be at least 1"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+static struct link_Info * rtosLink;
+static struct telemetry_Info telemetry;
+
+// Tasks are statically allocated (configSUPPORT_DYNAMIC_ALLOCATION is 0)
+static TaskHandle_t audioTask;
+static TaskHandle_t controlTask;
+static StaticTask_t audioTCB;
+static StaticTask_t controlTCB;
+static StaticTask_t telemetryTCB;
+static StaticTask_t idleTCB;
+static StackType_t audioStack[AUDIO_STACK_SIZE];
+static StackType_t controlStack[CONTROL_STACK_SIZE];
+static StackType_t telemetryStack[TELEMETRY_STACK_SIZE];
+static StackType_t idleStack[configMINIMAL_STACK_SIZE];
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void audioTaskFunction(void * parameters);
+static void controlTaskFunction(void * parameters);
+static void telemetryTaskFunction(void * parameters);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief creates the tasks, requests the link start and starts the scheduler
+ *
+ * Should be called at the end of main, instead of starting the link and of
+ * the main loop. The link is started by the control task (see Rtos_ControlHandle).
+ *
+ * @param link[IN] pointer to the link_Info structure of the module, watched by the telemetry task
+ * @note Never returns
+ */
+void Rtos_Start(struct link_Info * link)
+{
+	rtosLink = link;
+
+	audioTask = xTaskCreateStatic(audioTaskFunction, "audio", AUDIO_STACK_SIZE, NULL,
+			AUDIO_TASK_PRIORITY, audioStack, &audioTCB);
+	controlTask = xTaskCreateStatic(controlTaskFunction, "control", CONTROL_STACK_SIZE, NULL,
+			CONTROL_TASK_PRIORITY, controlStack, &controlTCB);
+	xTaskCreateStatic(telemetryTaskFunction, "telemetry", TELEMETRY_STACK_SIZE, NULL,
+			TELEMETRY_TASK_PRIORITY, telemetryStack, &telemetryTCB);
+
+	Rtos_Control(RTOS_START);
+	vTaskStartScheduler();
+
+	while (1)
+	{
+		// Only reached if the scheduler couldn't start
+	}
+}
+
+/**
+ * @brief requests commands to the control task
+ *
+ * @param command[IN] RTOS_START and/or RTOS_STOP bits. Can be called before the scheduler starts.
+ * @note Should be called from a task, not from an interrupt
+ */
+void Rtos_Control(uint32_t command)
+{
+	xTaskNotify(controlTask, command, eSetBits);
+}
+
+/**
+ * @brief gives the last snapshot of the telemetry task
+ *
+ * @return pointer to the snapshot
+ */
+const struct telemetry_Info * Rtos_GetTelemetry()
+{
+	return &telemetry;
+}
+
+/**
+ * @brief wakes the audio task, pended by Scheduler_Post
+ */
+RAMFUNC void RTOS_WAKE_IRQHandler(void)
+{
+	BaseType_t woken = pdFALSE;
+
+	vTaskNotifyGiveFromISR(audioTask, &woken);
+	portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief gives the memory of the idle task to FreeRTOS (configSUPPORT_STATIC_ALLOCATION is 1)
+ */
+void vApplicationGetIdleTaskMemory(StaticTask_t ** idleTCBBuffer, StackType_t ** idleStackBuffer,
+		uint32_t * idleStackSize)
+{
+	*idleTCBBuffer = &idleTCB;
+	*idleStackBuffer = idleStack;
+	*idleStackSize = configMINIMAL_STACK_SIZE;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief runs the work deferred by interrupts, in place of PendSV
+ *
+ * @param parameters[IN] unused
+ */
+static RAMFUNC void audioTaskFunction(void * parameters)
+{
+	while (1)
+	{
+		// Several events posted meanwhile give one notification
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		Scheduler_MeasureLatency();
+		Scheduler_PendingHandle();
+	}
+}
+
+/**
+ * @brief gives commands received by Rtos_Control to the application, and checks the link health
+ *
+ * @param parameters[IN] unused
+ */
+static void controlTaskFunction(void * parameters)
+{
+	uint32_t commands;
+
+	while (1)
+	{
+		commands = 0;
+		xTaskNotifyWait(0, 0xFFFFFFFF, &commands, pdMS_TO_TICKS(HEALTH_PERIOD));
+
+		// Stop before start: both bits restart the link
+		if (commands & RTOS_STOP)
+		{
+			Rtos_ControlHandle(RTOS_STOP);
+		}
+		if (commands & RTOS_START)
+		{
+			Rtos_ControlHandle(RTOS_START);
+		}
+
+		// Refreshes the watchdog, which resets the module if this task starves
+		Health_Check(rtosLink);
+	}
+}
+
+/**
+ * @brief takes a snapshot of the link health every TELEMETRY_PERIOD ms
+ *
+ * @param parameters[IN] unused
+ */
+static void telemetryTaskFunction(void * parameters)
+{
+	TickType_t wakeTime = xTaskGetTickCount();
+	struct agc_State * agc = NULL;
+	struct howl_State * howl = NULL;
+	uint8_t i;
+
+	while (1)
+	{
+		vTaskDelayUntil(&wakeTime, pdMS_TO_TICKS(TELEMETRY_PERIOD));
+
+		for (i = 0; i < ERROR_KINDS; i++)
+		{
+			telemetry.errors[i] = rtosLink->errors[i];
+		}
+		telemetry.sampleLatency = Timer_GetLatency()->max;
+		telemetry.audioLatency = Scheduler_GetLatency()->max;
+		telemetry.audioStackFree = uxTaskGetStackHighWaterMark(audioTask);
+
+#if EMITTER_SUPPORT && (AGC == 1)
+		agc = (rtosLink->hadc != NULL) ? pipeline_findState(&(rtosLink->encoder.pipeline), agc_Process) : NULL;
+#endif
+		telemetry.agcGain = (agc != NULL) ? agc->gain : 0;
+		telemetry.limitedBlocks = (agc != NULL) ? agc->limitedBlocks : 0;
+
+#if EMITTER_SUPPORT && (HOWL_SUPPRESSION == 1)
+		howl = (rtosLink->hadc != NULL) ? pipeline_findState(&(rtosLink->encoder.pipeline), howl_Process) : NULL;
+#endif
+		telemetry.howlNotches = (howl != NULL) ? howl->notches.sections : 0;
+		telemetry.howlDeployed = (howl != NULL) ? howl->deployed : 0;
+		telemetry.count += 1;
+	}
+}
+
+#endif
@@ -0,0 +1,142 @@
+/**
+  ******************************************************************************
+  * @file           : scheduler.c
+  * @brief          : Scheduler API
+  *
+  * Interrupts only move data and post events: the work they would have done
+  * (encoding, decoding, interpolation) runs later in PendSV, the interrupt
+  * with the lowest priority. The sampling timer, UART and DMA interrupts are
+  * then never delayed by codec work.
+  * Events are bits of a word owned by the caller (one word per link), set by
+  * Scheduler_Post and atomically cleared by Scheduler_Take. Posting an event
+  * that is already pending does nothing: the consumer empties its whole ring.
+  * When RTOS_SUPPORT is 1, FreeRTOS owns PendSV: events wake the audio task
+  * instead (see rtos.c).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "scheduler.h"
+#include "cycles.h"
+#include "sections.h"
+#if (RTOS_SUPPORT == 1)
+#include "rtos.h"
+#endif
+
+#if (RTOS_SUPPORT == 1) && (DEFERRED_PROCESSING == 0)
+#error "DEFERRED_PROCESSING should be 1 when RTOS_SUPPORT is 1"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+/*
+ * Time between the first event posted and the beginning of the deferred work
+ * (PendSV handler or audio task)
+ */
+static struct cycles_Info latency CCMDATA;
+static volatile uint8_t waiting CCMDATA;   /** 1 if an event was posted since the last measurement */
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief gives PendSV the lowest priority (enables the interrupt waking the audio task if RTOS_SUPPORT is 1)
+ * @note Can be called several times
+ */
+void Scheduler_Init()
+{
+	Cycles_Init();
+	Cycles_Reset(&latency);
+	waiting = 0;
+
+#if (RTOS_SUPPORT == 1)
+	HAL_NVIC_SetPriority(RTOS_WAKE_IRQn, RTOS_WAKE_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(RTOS_WAKE_IRQn);
+#else
+	HAL_NVIC_SetPriority(PendSV_IRQn, SCHEDULER_PRIORITY, 0);
+#endif
+}
+
+/**
+ * @brief sets event bits and requests PendSV
+ *
+ * Can be called from any interrupt: bits are set with exclusive accesses,
+ * so events posted by interrupts of different priorities are never lost.
+ *
+ * @param events[IN] pointer to the word containing pending events
+ * @param event[IN] bits to set
+ */
+RAMFUNC void Scheduler_Post(volatile uint32_t * events, uint32_t event)
+{
+	do
+	{
+		// Retried if an interrupt accessed the word meanwhile
+	} while (__STREXW(__LDREXW(events) | event, events) != 0);
+
+	if (waiting == 0)
+	{
+		Cycles_Start(&latency);
+		waiting = 1;
+	}
+
+#if (RTOS_SUPPORT == 1)
+	NVIC_SetPendingIRQ(RTOS_WAKE_IRQn);
+#else
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+#endif
+}
+
+/**
+ * @brief gives pending events and clears them
+ *
+ * @param events[IN] pointer to the word containing pending events
+ * @return bits that were set
+ */
+RAMFUNC uint32_t Scheduler_Take(volatile uint32_t * events)
+{
+	uint32_t taken;
+
+	do
+	{
+		taken = __LDREXW(events);
+	} while (__STREXW(0, events) != 0);
+
+	return taken;
+}
+
+/**
+ * @brief measures the time deferred work waited since the first event posted
+ *
+ * Should be the first thing done by the PendSV handler (or the audio task).
+ * Nothing is measured if no event was posted.
+ */
+RAMFUNC void Scheduler_MeasureLatency()
+{
+	if (waiting != 0)
+	{
+		waiting = 0;
+		Cycles_Stop(&latency);
+	}
+}
+
+/**
+ * @brief gives the latency of deferred work
+ *
+ * @return pointer to the measurements (CPU cycles between an event and the beginning of the deferred work)
+ */
+const struct cycles_Info * Scheduler_GetLatency()
+{
+	return &latency;
+}
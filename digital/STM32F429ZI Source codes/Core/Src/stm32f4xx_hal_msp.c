@@ -45,7 +45,7 @@ extern DMA_HandleTypeDef hdma_usart1_tx;
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN PV */
-
+extern DMA_HandleTypeDef hdma_dac1;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -178,7 +178,23 @@ void HAL_DAC_MspInit(DAC_HandleTypeDef* hdac)
     HAL_NVIC_SetPriority(TIM6_DAC_IRQn, 2, 0);
     HAL_NVIC_EnableIRQ(TIM6_DAC_IRQn);
   /* USER CODE BEGIN DAC_MspInit 1 */
+    // DAC DMA (DMA1 stream 5, channel 7), not in the CubeMX project: kept here so that it survives code generation
+    hdma_dac1.Instance = DMA1_Stream5;
+    hdma_dac1.Init.Channel = DMA_CHANNEL_7;
+    hdma_dac1.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_dac1.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_dac1.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_dac1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_dac1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_dac1.Init.Mode = DMA_CIRCULAR;
+    hdma_dac1.Init.Priority = DMA_PRIORITY_HIGH;
+    hdma_dac1.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&hdma_dac1) != HAL_OK)
+    {
+      Error_Handler();
+    }
 
+    __HAL_LINKDMA(hdac,DMA_Handle1,hdma_dac1);
   /* USER CODE END DAC_MspInit 1 */
   }
 
@@ -208,7 +224,8 @@ void HAL_DAC_MspDeInit(DAC_HandleTypeDef* hdac)
     /* DAC interrupt DeInit */
     HAL_NVIC_DisableIRQ(TIM6_DAC_IRQn);
   /* USER CODE BEGIN DAC_MspDeInit 1 */
-
+    // DAC DMA, see HAL_DAC_MspInit
+    HAL_DMA_DeInit(hdac->DMA_Handle1);
   /* USER CODE END DAC_MspDeInit 1 */
   }
 
@@ -24,6 +24,12 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "links.h"
+#include "timer.h"
+#include "scheduler.h"
+#if (RTOS_SUPPORT == 1)
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -64,7 +70,7 @@ extern DMA_HandleTypeDef hdma_usart1_rx;
 extern DMA_HandleTypeDef hdma_usart1_tx;
 extern UART_HandleTypeDef huart1;
 /* USER CODE BEGIN EV */
-
+extern DMA_HandleTypeDef hdma_dac1;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -143,6 +149,8 @@ void UsageFault_Handler(void)
   }
 }
 
+#if (RTOS_SUPPORT == 0)
+/* SVC_Handler and PendSV_Handler are given by FreeRTOS when RTOS_SUPPORT is 1 (see FreeRTOSConfig.h) */
 /**
   * @brief This function handles System service call via SWI instruction.
   */
@@ -155,6 +163,7 @@ void SVC_Handler(void)
 
   /* USER CODE END SVCall_IRQn 1 */
 }
+#endif
 
 /**
   * @brief This function handles Debug monitor.
@@ -169,18 +178,22 @@ void DebugMon_Handler(void)
   /* USER CODE END DebugMonitor_IRQn 1 */
 }
 
+#if (RTOS_SUPPORT == 0)
 /**
   * @brief This function handles Pendable request for system service.
   */
 void PendSV_Handler(void)
 {
   /* USER CODE BEGIN PendSV_IRQn 0 */
-
+  // Run work deferred by other interrupts
+  Scheduler_MeasureLatency();
+  Scheduler_PendingHandle();
   /* USER CODE END PendSV_IRQn 0 */
   /* USER CODE BEGIN PendSV_IRQn 1 */
 
   /* USER CODE END PendSV_IRQn 1 */
 }
+#endif
 
 /**
   * @brief This function handles System tick timer.
@@ -192,7 +205,12 @@ void SysTick_Handler(void)
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
-
+#if (RTOS_SUPPORT == 1)
+  if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+  {
+    xPortSysTickHandler();
+  }
+#endif
   /* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -223,12 +241,12 @@ void ADC_IRQHandler(void)
 void TIM2_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM2_IRQn 0 */
-
+  Timer_MeasureLatency(&htim2);
   /* USER CODE END TIM2_IRQn 0 */
   HAL_TIM_IRQHandler(&htim2);
   /* USER CODE BEGIN TIM2_IRQn 1 */
   // Request the ADC or DAC to update
-  Timer_RisingEdgeHandle();
+  Timer_RisingEdgeHandle(&htim2);
   /* USER CODE END TIM2_IRQn 1 */
 }
 
@@ -289,6 +307,12 @@ void DMA2_Stream7_IRQHandler(void)
 }
 
 /* USER CODE BEGIN 1 */
-
+/**
+  * @brief This function handles DMA1 stream5 global interrupt (DAC DMA, not in the CubeMX project).
+  */
+void DMA1_Stream5_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_dac1);
+}
 /* USER CODE END 1 */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
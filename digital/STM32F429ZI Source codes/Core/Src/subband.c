@@ -0,0 +1,566 @@
+/**
+  ******************************************************************************
+  * @file           : subband.c
+  * @brief          : Two-band ADPCM codec (G.722 algorithm)
+  *
+  * A quadrature mirror filter splits each pair of samples into a low band
+  * (0 to SAMPLING_FREQUENCY / 4) and a high band sample (the rest), each one
+  * coded by its own ADPCM: 6 bits for the low band, where speech carries
+  * most of its energy, and 2 bits for the high band. A pair of samples makes
+  * one byte. At SAMPLING_FREQUENCY = 16000, this is the 64kb/s mode of G.722:
+  * audio up to 7kHz in less than half the bandwidth of 12kHz raw samples.
+  * Integer only, with the quantizers, predictors and filter of G.722.
+  * The predictors only use the 4 MSBs of the low band code: toggling its LSB
+  * (to avoid SYNC_SIGNAL) doesn't change the state.
+  * The step scale factors of both bands are sent after every synchronization
+  * signal. The predictors are too large to be sent as well: both sides reset
+  * them every RESET_PERIOD headers instead, when the header says so. A decoder
+  * synchronizing in the middle of the stream (or after a lost byte) starts
+  * with the steps of the encoder, and has the same predictors at the next
+  * reset at the latest (its own ones converge in the meantime).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "codec.h"
+#include "subband.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SAMPLE_OFFSET (1 << (SAMPLE_SIZE - 1))   // Mid-scale, 0 once centered
+#define SAMPLE_SHIFT (16 - SAMPLE_SIZE)          // Samples are scaled to 16 bits
+#define BAND_MAX 16383                           // Reconstructed band samples are 15 bits
+#define LOW_LEVELS 30                            // Magnitudes of the low band quantizer
+#define LOW_NB_MAX 18432
+#define HIGH_NB_MAX 22528
+#define LOW_SCALE_SHIFT 8
+#define HIGH_SCALE_SHIFT 10
+#define RESET_PERIOD 128                         // Headers between two resets of the predictors (about 1s)
+#define RESET_FLAG 0x40                          // In the first header byte (scale factors take 15 bits)
+
+#if (SAMPLE_SIZE > 16)
+#error "SAMPLE_SIZE should not be above 16"
+#endif
+
+// The encoder and the decoder keep the state and the header of any codec in buffers of the codec.h sizes
+#if (SUBBAND_HEADER_SIZE > CODEC_HEADER_SIZE) || (SUBBAND_SAMPLES > CODEC_MAX_SAMPLES)
+#error "SUBBAND_HEADER_SIZE should not be above CODEC_HEADER_SIZE and SUBBAND_SAMPLES above CODEC_MAX_SAMPLES"
+#endif
+
+_Static_assert(sizeof(struct subband_State) <= CODEC_STATE_SIZE, "struct subband_State should not be larger than CODEC_STATE_SIZE");
+
+/* Private variables ---------------------------------------------------------*/
+
+// Quadrature mirror filter (half of the 24 symmetric taps)
+static const int16_t qmfTable[SUBBAND_QMF_TAPS / 2] =
+{
+	3, -11, 12, 32, -210, 951, 3876, -805, 362, -156, 53, -11
+};
+
+// Low band: decision levels, codes of negative and positive differences
+static const int16_t lowLevels[LOW_LEVELS + 1] =
+{
+	0, 35, 72, 110, 150, 190, 233, 276, 323, 370, 422, 473, 530, 587, 650, 714,
+	786, 858, 940, 1023, 1121, 1219, 1339, 1458, 1612, 1765, 1980, 2195, 2557, 2919, 0
+};
+
+static const uint8_t lowNegativeCodes[LOW_LEVELS + 1] =
+{
+	0, 63, 62, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19,
+	18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4
+};
+
+static const uint8_t lowPositiveCodes[LOW_LEVELS + 1] =
+{
+	0, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47,
+	46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32
+};
+
+// Low band: differences of 6-bit codes (output) and of their 4 MSBs (predictor)
+static const int16_t lowDifferences6[64] =
+{
+	-136, -136, -136, -136, -24808, -21904, -19008, -16704,
+	-14984, -13512, -12280, -11192, -10232, -9360, -8576, -7856,
+	-7192, -6576, -6000, -5456, -4944, -4464, -4008, -3576,
+	-3168, -2776, -2400, -2032, -1688, -1360, -1040, -728,
+	24808, 21904, 19008, 16704, 14984, 13512, 12280, 11192,
+	10232, 9360, 8576, 7856, 7192, 6576, 6000, 5456,
+	4944, 4464, 4008, 3576, 3168, 2776, 2400, 2032,
+	1688, 1360, 1040, 728, 432, 136, -432, -136
+};
+
+static const int16_t lowDifferences4[16] =
+{
+	0, -20456, -12896, -8968, -6288, -4240, -2584, -1200,
+	20456, 12896, 8968, 6288, 4240, 2584, 1200, 0
+};
+
+// Low band: step adaptation of each 4-bit code
+static const uint8_t lowMagnitudes[16] = { 0, 7, 6, 5, 4, 3, 2, 1, 7, 6, 5, 4, 3, 2, 1, 0 };
+static const int16_t lowWeights[8] = { -60, -30, 58, 172, 334, 538, 1198, 3042 };
+
+// High band: codes, differences and step adaptation
+static const uint8_t highNegativeCodes[3] = { 0, 1, 0 };
+static const uint8_t highPositiveCodes[3] = { 0, 3, 2 };
+static const int16_t highDifferences[4] = { -7408, -1616, 7408, 1616 };
+static const uint8_t highMagnitudes[4] = { 2, 1, 2, 1 };
+static const int16_t highWeights[3] = { 0, -214, 798 };
+
+// Mantissas of step scale factors
+static const int16_t scaleTable[32] =
+{
+	2048, 2093, 2139, 2186, 2233, 2282, 2332, 2383, 2435, 2489, 2543, 2599, 2656, 2714, 2774, 2834,
+	2896, 2960, 3025, 3091, 3158, 3228, 3298, 3371, 3444, 3520, 3597, 3676, 3756, 3838, 3922, 4008
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void resetBand(struct subband_Band * band, int8_t scaleShift);
+static void resetPredictor(struct subband_Band * band);
+static uint8_t encodeLow(struct subband_Band * band, int16_t sample);
+static uint8_t encodeHigh(struct subband_Band * band, int16_t sample);
+static int16_t decodeLow(struct subband_Band * band, uint8_t code);
+static int16_t decodeHigh(struct subband_Band * band, uint8_t code);
+static void adaptStep(struct subband_Band * band, int16_t weight, int16_t nbMax, int8_t scaleShift);
+static int16_t scaleFactor(int16_t nb, int8_t scaleShift);
+static void predict(struct subband_Band * band, int16_t difference);
+static int16_t saturate(int32_t value);
+static int16_t limit(int32_t value);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief resets the state: empty filter, no prediction, smallest steps
+ *
+ * @param state[IN] pointer to a subband_State structure
+ */
+void subband_reset(void * state)
+{
+	struct subband_State * subband = state;
+	uint8_t i;
+
+	for (i = 0; i < SUBBAND_QMF_TAPS; i++)
+	{
+		subband->qmf[i] = 0;
+	}
+
+	resetBand(&(subband->low), LOW_SCALE_SHIFT);
+	resetBand(&(subband->high), HIGH_SCALE_SHIFT);
+	subband->headers = 0;
+}
+
+/**
+ * @brief gives the code of two samples
+ *
+ * @param state[IN] pointer to a subband_State structure
+ * @param samples[IN] the two samples, oldest first (SAMPLE_SIZE LSBs)
+ * @return the code: high band code (2 MSBs), then low band code (6 LSBs)
+ */
+RAMFUNC uint32_t subband_encode(void * state, const uint16_t * samples)
+{
+	struct subband_State * subband = state;
+	int32_t even = 0;
+	int32_t odd = 0;
+	uint8_t code;
+	uint8_t i;
+
+	// Analysis filter, decimated by 2
+	for (i = 0; i < SUBBAND_QMF_TAPS - 2; i++)
+	{
+		subband->qmf[i] = subband->qmf[i + 2];
+	}
+	subband->qmf[SUBBAND_QMF_TAPS - 2] = (int16_t)(((int32_t)samples[0] - SAMPLE_OFFSET) << SAMPLE_SHIFT);
+	subband->qmf[SUBBAND_QMF_TAPS - 1] = (int16_t)(((int32_t)samples[1] - SAMPLE_OFFSET) << SAMPLE_SHIFT);
+
+	for (i = 0; i < SUBBAND_QMF_TAPS / 2; i++)
+	{
+		odd += subband->qmf[2 * i] * qmfTable[i];
+		even += subband->qmf[2 * i + 1] * qmfTable[SUBBAND_QMF_TAPS / 2 - 1 - i];
+	}
+
+	code = (uint8_t)((encodeHigh(&(subband->high), saturate((even - odd) >> 14)) << 6)
+	                 | encodeLow(&(subband->low), saturate((even + odd) >> 14)));
+
+	// The LSB of the low band code isn't used by the predictor
+	if (code == SYNC_SIGNAL)
+	{
+		code ^= 0x01;
+	}
+
+	return code;
+}
+
+/**
+ * @brief gives the two samples of a code
+ *
+ * @param state[IN] pointer to a subband_State structure
+ * @param code[IN] the code (8 LSBs)
+ * @param samples[OUT] the two samples, oldest first (SAMPLE_SIZE LSBs)
+ */
+RAMFUNC void subband_decode(void * state, uint32_t code, uint16_t * samples)
+{
+	struct subband_State * subband = state;
+	int16_t low = decodeLow(&(subband->low), (uint8_t)(code & 0x3F));
+	int16_t high = decodeHigh(&(subband->high), (uint8_t)((code >> 6) & 0x03));
+	int32_t even = 0;
+	int32_t odd = 0;
+	uint8_t i;
+
+	// Synthesis filter, interpolated by 2
+	for (i = 0; i < SUBBAND_QMF_TAPS - 2; i++)
+	{
+		subband->qmf[i] = subband->qmf[i + 2];
+	}
+	subband->qmf[SUBBAND_QMF_TAPS - 2] = low + high;
+	subband->qmf[SUBBAND_QMF_TAPS - 1] = low - high;
+
+	for (i = 0; i < SUBBAND_QMF_TAPS / 2; i++)
+	{
+		even += subband->qmf[2 * i] * qmfTable[i];
+		odd += subband->qmf[2 * i + 1] * qmfTable[SUBBAND_QMF_TAPS / 2 - 1 - i];
+	}
+
+	samples[0] = (uint16_t)((saturate(odd >> 11) >> SAMPLE_SHIFT) + SAMPLE_OFFSET);
+	samples[1] = (uint16_t)((saturate(even >> 11) >> SAMPLE_SHIFT) + SAMPLE_OFFSET);
+}
+
+/**
+ * @brief gives the step scale factors of the encoder, and resets its
+ * predictors every RESET_PERIOD headers (RESET_FLAG set in the header)
+ *
+ * Every byte is below 0x80: a header is never taken for a synchronization signal.
+ *
+ * @param state[IN] pointer to a subband_State structure
+ * @param header[OUT] SUBBAND_HEADER_SIZE bytes
+ */
+RAMFUNC void subband_getHeader(void * state, uint8_t * header)
+{
+	struct subband_State * subband = state;
+	uint16_t low = (uint16_t)subband->low.nb;
+	uint16_t high = (uint16_t)subband->high.nb;
+
+	header[0] = (uint8_t)(low >> 14);
+	header[1] = (uint8_t)((low >> 7) & 0x7F);
+	header[2] = (uint8_t)(low & 0x7F);
+	header[3] = (uint8_t)(high >> 14);
+	header[4] = (uint8_t)((high >> 7) & 0x7F);
+	header[5] = (uint8_t)(high & 0x7F);
+
+	subband->headers += 1;
+	if (subband->headers >= RESET_PERIOD)
+	{
+		subband->headers = 0;
+		header[0] |= RESET_FLAG;
+		resetPredictor(&(subband->low));
+		resetPredictor(&(subband->high));
+	}
+}
+
+/**
+ * @brief sets the step scale factors of the decoder. Its predictors are reset
+ * if the encoder reset its own ones, else they are kept: they are already the
+ * ones of the encoder if no byte was lost
+ *
+ * @param state[IN] pointer to a subband_State structure
+ * @param header[IN] SUBBAND_HEADER_SIZE bytes given by subband_getHeader
+ */
+RAMFUNC void subband_setHeader(void * state, const uint8_t * header)
+{
+	struct subband_State * subband = state;
+	int32_t low = ((int32_t)(header[0] & ~RESET_FLAG) << 14) | ((int32_t)header[1] << 7) | header[2];
+	int32_t high = ((int32_t)header[3] << 14) | ((int32_t)header[4] << 7) | header[5];
+
+	subband->low.nb = (int16_t)((low > LOW_NB_MAX) ? LOW_NB_MAX : low);
+	subband->low.det = scaleFactor(subband->low.nb, LOW_SCALE_SHIFT);
+	subband->high.nb = (int16_t)((high > HIGH_NB_MAX) ? HIGH_NB_MAX : high);
+	subband->high.det = scaleFactor(subband->high.nb, HIGH_SCALE_SHIFT);
+
+	if (header[0] & RESET_FLAG)
+	{
+		resetPredictor(&(subband->low));
+		resetPredictor(&(subband->high));
+	}
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief resets the ADPCM state of a band
+ *
+ * @param band[IN] pointer to the subband_Band structure
+ * @param scaleShift[IN] LOW_SCALE_SHIFT or HIGH_SCALE_SHIFT
+ */
+static void resetBand(struct subband_Band * band, int8_t scaleShift)
+{
+	resetPredictor(band);
+	band->nb = 0;
+	band->det = scaleFactor(0, scaleShift);
+}
+
+/**
+ * @brief resets the predictor of a band, but keeps its step
+ *
+ * @param band[IN] pointer to the subband_Band structure
+ */
+static RAMFUNC void resetPredictor(struct subband_Band * band)
+{
+	uint8_t i;
+
+	band->s = 0;
+	band->sp = 0;
+	band->sz = 0;
+	for (i = 0; i < 3; i++)
+	{
+		band->r[i] = 0;
+		band->a[i] = 0;
+		band->p[i] = 0;
+	}
+	for (i = 0; i < 7; i++)
+	{
+		band->d[i] = 0;
+		band->b[i] = 0;
+	}
+}
+
+/**
+ * @brief gives the 6-bit code of a low band sample, and updates the state
+ *
+ * @param band[IN] pointer to the subband_Band structure of the low band
+ * @param sample[IN] the low band sample
+ * @return the code (6 LSBs)
+ */
+static RAMFUNC uint8_t encodeLow(struct subband_Band * band, int16_t sample)
+{
+	int32_t error = saturate(sample - band->s);
+	int32_t magnitude = (error >= 0) ? error : -(error + 1);
+	uint8_t code;
+	uint8_t i;
+
+	for (i = 1; i < LOW_LEVELS; i++)
+	{
+		if (magnitude < ((lowLevels[i] * band->det) >> 12))
+		{
+			break;
+		}
+	}
+	code = (error < 0) ? lowNegativeCodes[i] : lowPositiveCodes[i];
+
+	decodeLow(band, code);
+	return code;
+}
+
+/**
+ * @brief gives the 2-bit code of a high band sample, and updates the state
+ *
+ * @param band[IN] pointer to the subband_Band structure of the high band
+ * @param sample[IN] the high band sample
+ * @return the code (2 LSBs)
+ */
+static RAMFUNC uint8_t encodeHigh(struct subband_Band * band, int16_t sample)
+{
+	int32_t error = saturate(sample - band->s);
+	int32_t magnitude = (error >= 0) ? error : -(error + 1);
+	uint8_t level = (magnitude >= ((564 * band->det) >> 12)) ? 2 : 1;
+	uint8_t code = (error < 0) ? highNegativeCodes[level] : highPositiveCodes[level];
+
+	decodeHigh(band, code);
+	return code;
+}
+
+/**
+ * @brief gives the low band sample of a 6-bit code, and updates the state
+ * like the encoder does (with the 4 MSBs of the code only)
+ *
+ * @param band[IN] pointer to the subband_Band structure of the low band
+ * @param code[IN] the code (6 LSBs)
+ * @return the reconstructed low band sample
+ */
+static RAMFUNC int16_t decodeLow(struct subband_Band * band, uint8_t code)
+{
+	int16_t sample = limit(band->s + ((band->det * lowDifferences6[code]) >> 15));
+	uint8_t code4 = code >> 2;
+
+	predict(band, (int16_t)((band->det * lowDifferences4[code4]) >> 15));
+	adaptStep(band, lowWeights[lowMagnitudes[code4]], LOW_NB_MAX, LOW_SCALE_SHIFT);
+	return sample;
+}
+
+/**
+ * @brief gives the high band sample of a 2-bit code, and updates the state
+ *
+ * @param band[IN] pointer to the subband_Band structure of the high band
+ * @param code[IN] the code (2 LSBs)
+ * @return the reconstructed high band sample
+ */
+static RAMFUNC int16_t decodeHigh(struct subband_Band * band, uint8_t code)
+{
+	int16_t difference = (int16_t)((band->det * highDifferences[code]) >> 15);
+	int16_t sample = limit(band->s + difference);
+
+	predict(band, difference);
+	adaptStep(band, highWeights[highMagnitudes[code]], HIGH_NB_MAX, HIGH_SCALE_SHIFT);
+	return sample;
+}
+
+/**
+ * @brief updates the step scale factor of a band after a code
+ *
+ * @param band[IN] pointer to the subband_Band structure
+ * @param weight[IN] weight of the code (negative for small codes)
+ * @param nbMax[IN] LOW_NB_MAX or HIGH_NB_MAX
+ * @param scaleShift[IN] LOW_SCALE_SHIFT or HIGH_SCALE_SHIFT
+ */
+static RAMFUNC void adaptStep(struct subband_Band * band, int16_t weight, int16_t nbMax, int8_t scaleShift)
+{
+	int32_t nb = ((band->nb * 127) >> 7) + weight;
+
+	if (nb < 0)
+	{
+		nb = 0;
+	}
+	else if (nb > nbMax)
+	{
+		nb = nbMax;
+	}
+
+	band->nb = (int16_t)nb;
+	band->det = scaleFactor(band->nb, scaleShift);
+}
+
+/**
+ * @brief gives the step scale factor of a logarithmic one
+ *
+ * @param nb[IN] the logarithmic scale factor (0 to LOW_NB_MAX or HIGH_NB_MAX)
+ * @param scaleShift[IN] LOW_SCALE_SHIFT or HIGH_SCALE_SHIFT
+ * @return the scale factor
+ */
+static RAMFUNC int16_t scaleFactor(int16_t nb, int8_t scaleShift)
+{
+	int16_t mantissa = scaleTable[(nb >> 6) & 31];
+	int8_t exponent = scaleShift - (nb >> 11);
+
+	return (int16_t)((exponent < 0) ? (mantissa << -exponent) << 2 : (mantissa >> exponent) << 2);
+}
+
+/**
+ * @brief reconstructs a band sample from its quantized difference, adapts the
+ * predictor (2 poles, 6 zeros) and gives the next prediction
+ *
+ * @param band[IN] pointer to the subband_Band structure
+ * @param difference[IN] the quantized difference
+ */
+static RAMFUNC void predict(struct subband_Band * band, int16_t difference)
+{
+	int32_t pole1;
+	int32_t pole2;
+	int32_t sum;
+	int32_t wd;
+	int8_t sign;
+	uint8_t i;
+
+	band->d[0] = difference;
+	band->r[0] = saturate(band->s + difference);
+	band->p[0] = saturate(band->sz + difference);
+
+	// Pole coefficients, from the signs of the last partially reconstructed samples
+	sign = band->p[0] >> 15;
+	wd = saturate(band->a[1] << 2);
+	wd = (sign == (band->p[1] >> 15)) ? -wd : wd;
+	if (wd > INT16_MAX)
+	{
+		wd = INT16_MAX;
+	}
+	pole2 = ((sign == (band->p[2] >> 15)) ? 128 : -128) + (wd >> 7) + ((band->a[2] * 32512) >> 15);
+	if (pole2 > 12288)
+	{
+		pole2 = 12288;
+	}
+	else if (pole2 < -12288)
+	{
+		pole2 = -12288;
+	}
+
+	pole1 = saturate(((sign == (band->p[1] >> 15)) ? 192 : -192) + ((band->a[1] * 32640) >> 15));
+	wd = saturate(15360 - pole2);
+	if (pole1 > wd)
+	{
+		pole1 = wd;
+	}
+	else if (pole1 < -wd)
+	{
+		pole1 = -wd;
+	}
+
+	// Zero coefficients, from the signs of the last differences, then delay lines
+	wd = (difference == 0) ? 0 : 128;
+	sign = difference >> 15;
+	for (i = 6; i > 0; i--)
+	{
+		band->b[i] = saturate(((sign == (band->d[i] >> 15)) ? wd : -wd) + ((band->b[i] * 32640) >> 15));
+		band->d[i] = band->d[i - 1];
+	}
+	for (i = 2; i > 0; i--)
+	{
+		band->r[i] = band->r[i - 1];
+		band->p[i] = band->p[i - 1];
+	}
+	band->a[1] = (int16_t)pole1;
+	band->a[2] = (int16_t)pole2;
+
+	// Next prediction
+	band->sp = saturate(((band->a[1] * saturate(band->r[1] << 1)) >> 15) + ((band->a[2] * saturate(band->r[2] << 1)) >> 15));
+	sum = 0;
+	for (i = 6; i > 0; i--)
+	{
+		sum += (band->b[i] * saturate(band->d[i] << 1)) >> 15;
+	}
+	band->sz = saturate(sum);
+	band->s = saturate(band->sp + band->sz);
+}
+
+/**
+ * @brief saturates a value to 16 bits
+ */
+static RAMFUNC int16_t saturate(int32_t value)
+{
+	if (value > INT16_MAX)
+	{
+		return INT16_MAX;
+	}
+	if (value < INT16_MIN)
+	{
+		return INT16_MIN;
+	}
+	return (int16_t)value;
+}
+
+/**
+ * @brief limits a reconstructed band sample to 15 bits
+ */
+static RAMFUNC int16_t limit(int32_t value)
+{
+	if (value > BAND_MAX)
+	{
+		return BAND_MAX;
+	}
+	if (value < -BAND_MAX - 1)
+	{
+		return -BAND_MAX - 1;
+	}
+	return (int16_t)value;
+}
@@ -20,6 +20,18 @@
 
 #include "stm32f4xx_hal.h"
 #include "config.h"
+#include "timer.h"
+#include "cycles.h"
+#include "sections.h"
+
+/* Private variables ---------------------------------------------------------*/
+
+/*
+ * Interrupt latency of the timer started by Timer_Start: time between the
+ * update event (counter reset to 0) and the beginning of its interrupt handler.
+ */
+static struct cycles_Info latency CCMDATA;
+static uint32_t cyclesPerTick CCMDATA;   /** CPU cycles per timer counter increment */
 
 /* Exported functions --------------------------------------------------------*/
 
@@ -30,9 +42,23 @@
  * @return HAL status (HAL_OK if no errors occured).
  */
 HAL_StatusTypeDef Timer_Start(TIM_HandleTypeDef * htim) {
+	cyclesPerTick = (HAL_RCC_GetHCLKFreq() / Timer_GetClock(htim)) * (htim->Init.Prescaler + 1);
+	Cycles_Reset(&latency);
+
 	return HAL_TIM_Base_Start_IT(htim);
 }
 
+/**
+ * @brief enables the counter of provided timer, without interruptions.
+ * Useful when the timer only triggers peripherals (for example DAC with DMA)
+ * 
+ * @param htim[IN] pointer to a TIM_HandleTypeDef structure that contains the configuration information for TIM module.
+ * @return HAL status (HAL_OK if no errors occured).
+ */
+HAL_StatusTypeDef Timer_StartTrigger(TIM_HandleTypeDef * htim) {
+	return HAL_TIM_Base_Start(htim);
+}
+
 /**
  * @brief disables the counter and interruptions of provided timer
  * 
@@ -42,3 +68,64 @@ HAL_StatusTypeDef Timer_Start(TIM_HandleTypeDef * htim) {
 HAL_StatusTypeDef Timer_Stop(TIM_HandleTypeDef * htim) {
 	return HAL_TIM_Base_Stop_IT(htim);
 }
+
+/**
+ * @brief gives the frequency of the clock counted by provided timer
+ * 
+ * Timers run at twice the frequency of their APB bus when the bus prescaler isn't 1.
+ * 
+ * @param htim[IN] pointer to a TIM_HandleTypeDef structure that contains the configuration information for TIM module.
+ * @return the timer clock frequency (Hz)
+ */
+uint32_t Timer_GetClock(TIM_HandleTypeDef * htim) {
+	uint32_t pclk;
+	uint32_t prescaler;
+
+	if ((htim->Instance == TIM1) || (htim->Instance == TIM8) || (htim->Instance == TIM9)
+			|| (htim->Instance == TIM10) || (htim->Instance == TIM11))
+	{
+		pclk = HAL_RCC_GetPCLK2Freq();
+		prescaler = (RCC->CFGR & RCC_CFGR_PPRE2) >> 3;
+	}
+	else
+	{
+		pclk = HAL_RCC_GetPCLK1Freq();
+		prescaler = RCC->CFGR & RCC_CFGR_PPRE1;
+	}
+
+	if (prescaler == RCC_HCLK_DIV1)
+	{
+		return pclk;
+	}
+	else
+	{
+		return 2 * pclk;
+	}
+}
+
+/**
+ * @brief measures the interrupt latency of provided timer
+ * 
+ * The counter is reset by the update event and keeps counting while the
+ * interrupt waits: its value at the beginning of the handler is the latency.
+ * Should be the first thing done by the interrupt handler.
+ * 
+ * @param htim[IN] pointer to the TIM_HandleTypeDef structure of the timer started by Timer_Start.
+ */
+RAMFUNC void Timer_MeasureLatency(TIM_HandleTypeDef * htim) {
+	latency.last = __HAL_TIM_GET_COUNTER(htim) * cyclesPerTick;
+	if (latency.last > latency.max)
+	{
+		latency.max = latency.last;
+	}
+	latency.count += 1;
+}
+
+/**
+ * @brief gives the interrupt latency of the timer started by Timer_Start
+ * 
+ * @return pointer to the measurements (CPU cycles between the update event and the interrupt handler)
+ */
+const struct cycles_Info * Timer_GetLatency() {
+	return &latency;
+}
@@ -21,17 +21,63 @@
 #include "stm32f4xx_hal.h"
 #include "config.h"
 #include "links.h"
-#include <stdlib.h>
+#include "role.h"
+#include "sections.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private defines -----------------------------------------------------------*/
-/* Private macros ------------------------------------------------------------*/
+
+#if (MODULE_TYPE == MICROW_EMITTER)
+#define BIT_BUFFER_SIZE TX_BUFFER_SIZE
+#elif (MODULE_TYPE == MICROW_RECEIVER)
+#define BIT_BUFFER_SIZE RX_BUFFER_SIZE
+#else
+// Both roles use the same slots: room for the largest buffer
+#define BIT_BUFFER_SIZE ((TX_BUFFER_SIZE > RX_BUFFER_SIZE) ? TX_BUFFER_SIZE : RX_BUFFER_SIZE)
+#endif
+
+#if EMITTER_SUPPORT && ((TX_BUFFER_SIZE < 1 + WORD_LENGTH/8) || !RING_VALID_SIZE(TX_BUFFER_SIZE))
+#error "TX_BUFFER_SIZE should be a power of two between 1 + WORD_LENGTH/8 and 32768"
+#endif
+
+#if RECEIVER_SUPPORT && ((RX_BUFFER_SIZE < 1 + WORD_LENGTH/8) || !RING_VALID_SIZE(RX_BUFFER_SIZE))
+#error "RX_BUFFER_SIZE should be a power of two between 1 + WORD_LENGTH/8 and 32768"
+#endif
+
+#if (SAMPLE_BUFFER_SIZE < 2) || !RING_VALID_SIZE(SAMPLE_BUFFER_SIZE)
+#error "SAMPLE_BUFFER_SIZE should be a power of two between 2 and 32768"
+#endif
+
+// Frames are encoded (emitter) or decoded (receiver) at once, while the previous one may still be waiting
+#if EMITTER_SUPPORT && (TX_BUFFER_SIZE < 2 * FRAME_SIZE * WORD_LENGTH / 8)
+#error "TX_BUFFER_SIZE should hold two encoded frames (2 * FRAME_SIZE * WORD_LENGTH / 8 bytes)"
+#endif
+
+#if RECEIVER_SUPPORT && (SAMPLE_BUFFER_SIZE < 2 * FRAME_SIZE)
+#error "SAMPLE_BUFFER_SIZE should hold two frames (2 * FRAME_SIZE samples)"
+#endif
+
 /* Private variables ---------------------------------------------------------*/
+
+/*
+ * Sample buffers are placed in the .stream_arena section (CCM RAM).
+ * Bit buffers are placed in the .bit_arena section (SRAM): UART DMA transfers
+ * bytes directly from/to them.
+ * The linker script checks that they fit in _Stream_Arena_Size and _Bit_Arena_Size bytes.
+ * One slot per link: up to MAX_LINKS pairs of streams can be initialized at the same time.
+ */
+static uint8_t bitArena[MAX_LINKS][BIT_BUFFER_SIZE] BIT_ARENA;
+static uint16_t sampleArena[MAX_LINKS][SAMPLE_BUFFER_SIZE] STREAM_ARENA;
+static uint8_t slotUsed[MAX_LINKS];   /** 1 if the slot is given to a stream, 0 else */
+
 /* Private function prototypes -----------------------------------------------*/
 /* Exported functions --------------------------------------------------------*/
 
 /**
- * @brief frees the memory space allocated to buffers
+ * @brief releases the buffers used by streams
+ * 
+ * Buffers are statically allocated, so nothing is given back to the heap:
+ * structures are only detached from their buffer.
  * 
  * @param sampleStream[IN] pointer to the sampleStream_Info structure
  * @param bitStream[IN] pointer to the bitStream_Info structure
@@ -40,15 +86,18 @@
  */
 HAL_StatusTypeDef streamFree(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream)
 {
-	if (bitStream->stream != NULL)
-	{
-		free(bitStream->stream);
-	}
-	
-	if (sampleStream->stream != NULL)
+	uint8_t slot;
+
+	for (slot = 0; slot < MAX_LINKS; slot++)
 	{
-		free(sampleStream->stream);
+		if (sampleStream->ring.buffer == (uint8_t *)sampleArena[slot])
+		{
+			slotUsed[slot] = 0;
+		}
 	}
+
+	bitStream->ring.buffer = NULL;
+	sampleStream->ring.buffer = NULL;
 	
 	return HAL_OK;
 }
@@ -58,86 +107,86 @@ HAL_StatusTypeDef streamFree(struct sampleStream_Info * sampleStream, struct bit
  * 
  * Initializes sampleStream_Info and bitStream_Info structures with consistent
  * data allowing to immediately start the receiver or emitter.
+ * Buffers are statically allocated (sized in config.h), the heap is never used:
+ * streamInit takes the first free slot out of MAX_LINKS, streamFree gives it back.
+ * 
+ * The streams are an emitter's if hadc is given, a receiver's if hdac is given
+ * (exactly one of them should be NULL).
  * 
  * @param sampleStream[IN] pointer to the sampleStream_Info structure that will be used by lower level APIs
  * @param bitStream[IN] pointer to the bitStream_Info structure that will be used by lower level APIs
- * @param hadc[IN] (optional) pointer to a ADC_HandleTypeDef structure that contains the configuration information for the specified ADC
- * @param hdac[IN] (optional) pointer to a DAC_HandleTypeDef structure that contains the configuration information for the specified DAC
- * @param DAC_Channel[IN] (optional): The selected DAC channel. This parameter can be one of the following values: DAC_CHANNEL_1 or DAC_CHANNEL_2
+ * @param hadc[IN] (emitter only, NULL else) pointer to a ADC_HandleTypeDef structure that contains the configuration information for the specified ADC
+ * @param hdac[IN] (receiver only, NULL else) pointer to a DAC_HandleTypeDef structure that contains the configuration information for the specified DAC
+ * @param DAC_Channel[IN] (receiver only): The selected DAC channel. This parameter can be one of the following values: DAC_CHANNEL_1 or DAC_CHANNEL_2
  * @param huart[IN] pointer to a USART_HandleTypeDef structure that contains the configuration information for the specified USART module.
- * @return HAL status (HAL_OK if no errors occured).
- * @note The function definition depends on module's type because only ADC or DAC is needed, never both.
+ * @return HAL status (HAL_OK if no errors occured, HAL_ERROR if MAX_LINKS slots are already used
+ * or if the image doesn't support the requested role).
  */
-#if (MODULE_TYPE == MICROW_EMITTER)
-HAL_StatusTypeDef streamInit(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream, ADC_HandleTypeDef * hadc, UART_HandleTypeDef * huart) {
-#else
-HAL_StatusTypeDef streamInit(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream, DAC_HandleTypeDef * hdac, uint32_t Channel, UART_HandleTypeDef * huart) {
-#endif
+HAL_StatusTypeDef streamInit(struct sampleStream_Info * sampleStream, struct bitStream_Info * bitStream, ADC_HandleTypeDef * hadc, DAC_HandleTypeDef * hdac, uint32_t Channel, UART_HandleTypeDef * huart) {
+	HAL_StatusTypeDef status;
+	uint16_t bitBufferSize;
+	uint8_t slot;
 
-	// BitStream Initialization
-	bitStream->huart = huart;
-	bitStream->state = INACTIVE;
-
-	if (MODULE_TYPE == MICROW_EMITTER)
+	if ((hadc != NULL) && (hdac == NULL) && EMITTER_SUPPORT)
+	{
+		bitBufferSize = TX_BUFFER_SIZE;
+	}
+	else if ((hdac != NULL) && (hadc == NULL) && RECEIVER_SUPPORT)
 	{
-		bitStream->length = TX_BUFFER_SIZE;
+		bitBufferSize = RX_BUFFER_SIZE;
 	}
 	else
 	{
-		bitStream->length = RX_BUFFER_SIZE;
+		return HAL_ERROR;
 	}
 
-	bitStream->lastBitOut = 8;
-
-	if (MODULE_TYPE == MICROW_EMITTER)
+	for (slot = 0; slot < MAX_LINKS; slot++)
 	{
-		bitStream->lastByteIn = bitStream->length - 1;
-		bitStream->lastByteOut = bitStream->length - 1;
+		if (slotUsed[slot] == 0)
+		{
+			break;
+		}
 	}
-	else
+
+	if (slot == MAX_LINKS)
 	{
-		bitStream->lastByteIn = bitStream->length - 1;
-		bitStream->lastByteOut = 0;
+		return HAL_ERROR;
 	}
-	bitStream->bytesSinceLastSyncSignal = SYNC_PERIOD + 1;
+	slotUsed[slot] = 1;
 
-    bitStream->stream = NULL;
-	bitStream->byte = 0;
-	bitStream->synchronized = 0;
+	// BitStream Initialization
+	bitStream->huart = huart;
+	bitStream->state = INACTIVE;
+	bitStream->transferLength = 0;
 
-    bitStream->stream = malloc(bitStream->length * sizeof(uint8_t));
-    if (bitStream->stream == NULL)
-    {
-        return HAL_ERROR;
-    }
+	status = ring_Init(&(bitStream->ring), bitArena[slot], bitBufferSize, sizeof(uint8_t));
+	if (status != HAL_OK)
+	{
+		slotUsed[slot] = 0;
+		return status;
+	}
 
     // SampleStream Initialization
-#if (MODULE_TYPE == MICROW_EMITTER)
-	sampleStream->hadc = hadc;
-#else
-	sampleStream->hdac = hdac;
-#endif
+	if (hadc != NULL)
+	{
+		sampleStream->hadc = hadc;
+	}
+	else
+	{
+		sampleStream->hdac = hdac;
+		sampleStream->DAC_Channel = Channel;
+	}
 
-    sampleStream->length = SAMPLE_BUFFER_SIZE;
 	sampleStream->defaultBitStream = bitStream;
-	sampleStream->bitsOut = 0;
-	sampleStream->lastSampleIn = sampleStream->length;
-	sampleStream->lastSampleOut = sampleStream->length;
 	sampleStream->state = INACTIVE;
 
-	sampleStream->stream = NULL;
-    sampleStream->stream = malloc(sampleStream->length * sizeof(uint32_t));
-    if (sampleStream->stream == NULL)
-    {
-        return HAL_ERROR;
-    }
-
-    uint16_t i = 0;
-    for(i=0; i<sampleStream->length; i++)
-    {
-    	(sampleStream->stream)[i] = 0xFFFFFFFF;
-    }
+	status = ring_Init(&(sampleStream->ring), sampleArena[slot], SAMPLE_BUFFER_SIZE, sizeof(uint16_t));
+	if (status != HAL_OK)
+	{
+		slotUsed[slot] = 0;
+		return status;
+	}
 
-    return HAL_OK;
+	return HAL_OK;
 
 }
@@ -20,19 +20,17 @@
 
 #include "stm32f4xx_hal.h"
 #include "links.h"
+#include "uart.h"
 #include "config.h"
+#include "sections.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private defines -----------------------------------------------------------*/
 /* Private macros ------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-
-struct bitStream_Info * UART_stream = NULL;
-
 /* Private function prototypes -----------------------------------------------*/
 
-static uint8_t dataAvailable();
-static void saveByte(uint8_t byte);
+static HAL_StatusTypeDef receiveByte(struct bitStream_Info * UART_stream);
 
 /* Exported functions --------------------------------------------------------*/
 
@@ -43,29 +41,32 @@ static void saveByte(uint8_t byte);
 /**
  * @brief initializes a stream to continuously send data over UART interface
  * 
- * @param bitStream[in] pointer to an initialized bitStream_Info structure
+ * @param UART_stream[in] pointer to an initialized bitStream_Info structure, used as a handle by other UART functions
  * @return HAL status (HAL_OK if no errors occured).
  * @note This function uses HAL, the UART peripheral must be initialized with HAL
  */
-HAL_StatusTypeDef UARTTx_streamStart(struct bitStream_Info * bitStream)
+HAL_StatusTypeDef UARTTx_streamStart(struct bitStream_Info * UART_stream)
 {
-	// Save the pointer to the struct in a global variable:
-	UART_stream = bitStream;
+	if (UART_stream == NULL)
+	{
+		return HAL_ERROR;
+	}
 
 	UART_stream->state = ACTIVE;
-	return UARTTx_streamUpdate();
+	return UARTTx_streamUpdate(UART_stream);
 }
 
 /**
  * @brief starts a stream without overwriting existing parameters.
- * Existing parameters are saved in the UART_stream global variable
+ * Bytes sent by the last transfer are removed from the ring.
  * 
+ * @param UART_stream[in] pointer to the bitStream_Info structure given to the start function
  * @return HAL status (HAL_OK if no errors occured).
  * @note this function should be called after data has been sent
  * @warning UARTTx_streamStart() must be called at least once before
  * calling UARTTx_streamRestart()
  */
-HAL_StatusTypeDef UARTTx_streamRestart()
+RAMFUNC HAL_StatusTypeDef UARTTx_streamRestart(struct bitStream_Info * UART_stream)
 {
 	/* Check that UART parameters already exists 
 	 * (ie UARTTx_streamStart() was called before)
@@ -75,20 +76,26 @@ HAL_StatusTypeDef UARTTx_streamRestart()
 		return HAL_ERROR;
 	}
 	
+	ring_Release(&(UART_stream->ring), UART_stream->transferLength);
+	UART_stream->transferLength = 0;
 	UART_stream->state = ACTIVE;
 
-	return UARTTx_streamUpdate();
+	return UARTTx_streamUpdate(UART_stream);
 }
 
 /**
  * @brief sends data if necessary and updates the stream structure fields
  * 
+ * @param UART_stream[in] pointer to the bitStream_Info structure given to UARTTx_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  * @note This function should be called when the UART buffer has been 
  * successfully updated and data is ready to be sent
  */
-HAL_StatusTypeDef UARTTx_streamUpdate()
+RAMFUNC HAL_StatusTypeDef UARTTx_streamUpdate(struct bitStream_Info * UART_stream)
 {
+	uint8_t * data;
+	uint16_t length;
+
 	/* Check that UART parameters already exists 
 	 * (ie UARTTx_streamStart() was called before)
 	 */
@@ -102,20 +109,14 @@ HAL_StatusTypeDef UARTTx_streamUpdate()
 		return HAL_BUSY;
 	}
 
-	if (dataAvailable())
+	// Send every byte waiting in the ring (up to its end), straight from the buffer :
+	data = ring_ReadSpan(&(UART_stream->ring), &length);
+	if (length > 0)
 	{
 		UART_stream->state = BUSY;
-		
-		// Send one byte :
-		UART_stream->lastByteOut += 1;
-		if (UART_stream->lastByteOut >= UART_stream->length)
-		{
-			UART_stream->lastByteOut = 0;
-		}
-
-		UART_stream->byte = (UART_stream->stream)[UART_stream->lastByteOut];
+		UART_stream->transferLength = length;
 
-		return HAL_UART_Transmit_DMA(UART_stream->huart, &(UART_stream->byte), 1);
+		return HAL_UART_Transmit_DMA(UART_stream->huart, data, length);
 	}
 
 	return HAL_OK;
@@ -124,9 +125,10 @@ HAL_StatusTypeDef UARTTx_streamUpdate()
 /**
  * @brief stops a running stream.
  * 
+ * @param UART_stream[in] pointer to the bitStream_Info structure given to the start function
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef UARTTx_streamStop()
+HAL_StatusTypeDef UARTTx_streamStop(struct bitStream_Info * UART_stream)
 {
 	/* Check that UART parameters already exists 
 	 * (ie UARTTx_streamStart() was called before)
@@ -148,14 +150,18 @@ HAL_StatusTypeDef UARTTx_streamStop()
 /**
  * @brief initializes a stream to continuously receive data with UART interface
  * 
- * @param bitStream[in] pointer to an initialized bitStream_Info structure
+ * @param UART_stream[in] pointer to an initialized bitStream_Info structure, used as a handle by other UART functions
  * @return HAL status (HAL_OK if no errors occured).
  * @note This function uses HAL, the UART peripheral must be initialized with HAL
  */
-HAL_StatusTypeDef UARTRx_streamStart(struct bitStream_Info * bitStream)
+HAL_StatusTypeDef UARTRx_streamStart(struct bitStream_Info * UART_stream)
 {
 	UART_HandleTypeDef * huart;
-	UART_stream = bitStream;
+
+	if (UART_stream == NULL)
+	{
+		return HAL_ERROR;
+	}
 
 	huart = UART_stream->huart;
 	if ((*huart).Init.Mode != UART_MODE_TX_RX && (*huart).Init.Mode != UART_MODE_RX)
@@ -164,18 +170,18 @@ HAL_StatusTypeDef UARTRx_streamStart(struct bitStream_Info * bitStream)
 	}
 
 	UART_stream->state = BUSY;
-	return HAL_UART_Receive_DMA(UART_stream->huart, &(UART_stream->byte), 1);
+	return receiveByte(UART_stream);
 }
 
 /**
  * @brief starts a stream without overwriting existing parameters.
- * Existing parameters are saved in the UART_stream global variable
  * 
+ * @param UART_stream[in] pointer to the bitStream_Info structure given to the start function
  * @return HAL status (HAL_OK if no errors occured).
  * @warning UARTTx_streamStart() must be called at least once before to
  * calling UARTTx_streamRestart()
  */
-HAL_StatusTypeDef UARTRx_streamRestart()
+HAL_StatusTypeDef UARTRx_streamRestart(struct bitStream_Info * UART_stream)
 {
 	/* Check that UART parameters already exists 
 	 * (ie UARTRx_streamStart() was called before)
@@ -186,18 +192,18 @@ HAL_StatusTypeDef UARTRx_streamRestart()
 	}
 	
 	UART_stream->state = BUSY;
-	return HAL_UART_Receive_DMA(UART_stream->huart, &(UART_stream->byte), 1);
+	return receiveByte(UART_stream);
 }
 
 /**
  * @brief updates the stream structure fields and restarts data reception if necessary
  * 
+ * @param UART_stream[in] pointer to the bitStream_Info structure given to UARTRx_streamStart
  * @return HAL status (HAL_OK if no errors occured).
  * @note This function should be called at the end of data reception
  */
-HAL_StatusTypeDef UARTRx_streamUpdate()
+RAMFUNC HAL_StatusTypeDef UARTRx_streamUpdate(struct bitStream_Info * UART_stream)
 {
-	uint8_t value;
 	HAL_StatusTypeDef status;
 	
 	/* Check that UART parameters already exists 
@@ -208,32 +214,29 @@ HAL_StatusTypeDef UARTRx_streamUpdate()
 		return HAL_ERROR;
 	}
 	
-	// Immediately restart the UART so that we don't miss any bit
-	status = HAL_OK;
-	value = UART_stream->byte;
-
-	if (UART_stream->state != INACTIVE)
-	{
-		status = UARTRx_streamRestart();
-	}
-	else
+	if (UART_stream->state == INACTIVE)
 	{
 		return HAL_ERROR;
 	}
 
-	saveByte(value);
+	// DMA wrote the byte in the ring, make it readable
+	ring_Commit(&(UART_stream->ring), 1);
+
+	// Immediately restart the UART so that we don't miss any bit
+	status = UARTRx_streamRestart(UART_stream);
 
 	// Tell the main API that data has beed saved in the buffer
-	UARTRx_FinishedHandle();
+	UARTRx_FinishedHandle(UART_stream);
 	return status;
 }
 
 /**
  * @brief stops a running stream.
  * 
+ * @param UART_stream[in] pointer to the bitStream_Info structure given to the start function
  * @return HAL status (HAL_OK if no errors occured).
  */
-HAL_StatusTypeDef UARTRx_streamStop()
+HAL_StatusTypeDef UARTRx_streamStop(struct bitStream_Info * UART_stream)
 {
 	/* Check that UART parameters already exists 
 	 * (ie UARTRx_streamStart() was called before)
@@ -249,48 +252,27 @@ HAL_StatusTypeDef UARTRx_streamStop()
 }
 
 /**
- * @brief saves a byte into the buffer
+ * @brief starts the reception of one byte, directly into the ring
  * 
- * @param byte[in] byte to save
- * @return None
- */
-static void saveByte(uint8_t byte)
-{
-	/* Check that UART parameters already exists */
-	if (UART_stream != NULL)
-	{
-		UART_stream->lastByteIn += 1;
-		if (UART_stream->lastByteIn >= UART_stream->length)
-		{
-			UART_stream->lastByteIn = 0;
-		}
-		(UART_stream->stream)[UART_stream->lastByteIn] = byte;
-	}
-}
-
-/*=============================================================================
-              ##### Receive and transmit functions #####
-=============================================================================*/
-
-/**
- * @brief checks if unsaved data is in the buffer
+ * If the ring is full, reception stops (the stream stays ACTIVE instead of
+ * BUSY) and the main API is told to resume it once the decoder caught up.
  * 
- * @return 1 if new data is in the buffer
+ * @param UART_stream[in] pointer to the bitStream_Info structure
+ * @return HAL status (HAL_OK if no errors occured).
  */
-static uint8_t dataAvailable()
+static RAMFUNC HAL_StatusTypeDef receiveByte(struct bitStream_Info * UART_stream)
 {
-	/* Check that UART parameters already exists */
-	if (UART_stream == NULL)
-	{
-		return 0;
-	}
-	// Check if there is new data in the buffer
-	if (UART_stream->lastByteIn != UART_stream->lastByteOut)
-	{
-		return 1;
-	}
-	else
+	uint8_t * data;
+	uint16_t length;
+
+	data = ring_WriteSpan(&(UART_stream->ring), &length);
+	if (length == 0)
 	{
-		return 0;
+		// Overrun (decoder too slow): bytes are lost until reception resumes
+		UART_stream->state = ACTIVE;
+		Stream_ErrorHandle(UART_stream, BUFFER_OVERRUN);
+		return HAL_OK;
 	}
+
+	return HAL_UART_Receive_DMA(UART_stream->huart, data, 1);
 }
@@ -0,0 +1,162 @@
+/**
+  ******************************************************************************
+  * @file           : vad.c
+  * @brief          : Voice activity detection
+  *
+  * Every frame gets an energy (mean square) and a zero-crossing count. A
+  * frame is speech when its energy is VAD_THRESHOLD times the noise floor,
+  * or twice the noise floor with many zero crossings (fricatives like "s"
+  * and "f" are weak but noisy). The noise floor follows silent frames once
+  * the hangover is over (pauses between syllables would raise it), drops at
+  * once to quieter ones, and rises slowly during speech so that a louder
+  * background (engine started) isn't taken for endless speech.
+  * VAD_HANGOVER frames are still sent after the last speech frame: word
+  * endings and short pauses between words aren't cut.
+  * The level and the spectral tilt of silent frames give the silence
+  * descriptors (see comfort.c).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include "stm32f4xx_hal.h"
+#include "config.h"
+#include "vad.h"
+#include "comfort.h"
+#include "sections.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SAMPLE_OFFSET (1 << (SAMPLE_SIZE - 1))   // Mid-scale, 0 once centered
+#define NOISE_MIN 1                              // The noise floor never reaches 0
+#define NOISE_FALL_SHIFT 2                       // Quieter frames: 1/4 of the way each frame
+#define NOISE_FOLLOW_SHIFT 4                     // Silent frames: 1/16 of the way each frame
+#define NOISE_RISE_SHIFT 8                       // Speech frames: +0.4% each frame (+1.7dB per second)
+#define CORRELATION_SHIFT 2                      // Correlation of silent frames: 1/4 of the way each frame
+#define CROSSINGS_MIN (FRAME_SIZE / 4)           // Zero crossings of a fricative (above 1/8 of the sampling frequency)
+
+#if (VAD_THRESHOLD < 2)
+#error "VAD_THRESHOLD should be at least 2"
+#endif
+
+// The receiver should get a descriptor between two progress checks (see health.c)
+#if (HEALTH_MONITOR == 1) && ((DTX_KEEPALIVE_PERIOD * FRAME_SIZE * 1000) / SAMPLING_FREQUENCY >= HEALTH_PERIOD)
+#error "DTX_KEEPALIVE_PERIOD frames should last less than HEALTH_PERIOD"
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief resets a detector: its first frame gives the noise floor
+ *
+ * @param vad[IN] pointer to the vad_Info structure, used as a handle by other vad functions
+ */
+void vad_Start(struct vad_Info * vad)
+{
+	vad->noise = NOISE_MIN;
+	vad->correlation = 0;
+	vad->hangover = 0;
+	vad->started = 0;
+	vad->frames = 0;
+	vad->sentFrames = 0;
+}
+
+/**
+ * @brief tells if a frame should be sent
+ *
+ * @param vad[IN] pointer to the vad_Info structure given to vad_Start
+ * @param frame[IN] FRAME_SIZE samples (SAMPLE_SIZE LSBs)
+ * @return 1 if the frame is speech (or in the hangover after speech), 0 if it is silent
+ */
+RAMFUNC uint8_t vad_Process(struct vad_Info * vad, const uint16_t * frame)
+{
+	uint64_t sum = 0;
+	int64_t lagSum = 0;
+	uint32_t energy;
+	uint16_t crossings = 0;
+	int32_t previous = (int32_t)frame[0] - SAMPLE_OFFSET;
+	int32_t sample;
+	uint8_t speech;
+	uint16_t i;
+
+	for (i = 0; i < FRAME_SIZE; i++)
+	{
+		sample = (int32_t)frame[i] - SAMPLE_OFFSET;
+		sum += (uint64_t)(sample * sample);
+		lagSum += (int64_t)(sample * previous);
+		crossings += ((sample ^ previous) < 0);
+		previous = sample;
+	}
+	energy = (uint32_t)(sum / FRAME_SIZE);
+
+	if (vad->started == 0)
+	{
+		vad->noise = (energy > NOISE_MIN) ? energy : NOISE_MIN;
+		vad->started = 1;
+	}
+
+	speech = (energy > (uint64_t)vad->noise * VAD_THRESHOLD)
+	         || ((energy > (uint64_t)vad->noise * 2) && (crossings >= CROSSINGS_MIN));
+
+	if (energy < vad->noise)
+	{
+		vad->noise -= (vad->noise - energy) >> NOISE_FALL_SHIFT;
+	}
+	else if ((speech == 0) && (vad->hangover == 0))
+	{
+		vad->noise += (energy - vad->noise) >> NOISE_FOLLOW_SHIFT;
+	}
+	else if (speech)
+	{
+		vad->noise += (vad->noise >> NOISE_RISE_SHIFT) + 1;
+	}
+	if (vad->noise < NOISE_MIN)
+	{
+		vad->noise = NOISE_MIN;
+	}
+
+	if (speech == 0)
+	{
+		// Spectral tilt of the background noise
+		if (sum != 0)
+		{
+			vad->correlation += (int32_t)(((lagSum << 15) / (int64_t)sum) - vad->correlation) >> CORRELATION_SHIFT;
+		}
+	}
+	else
+	{
+		vad->hangover = VAD_HANGOVER + 1;
+	}
+
+	vad->frames += 1;
+	if (vad->hangover == 0)
+	{
+		return 0;
+	}
+
+	vad->hangover -= 1;
+	vad->sentFrames += 1;
+	return 1;
+}
+
+/**
+ * @brief gives the silence descriptor of the background noise
+ *
+ * @param vad[IN] pointer to the vad_Info structure given to vad_Start
+ * @param descriptor[OUT] COMFORT_DESCRIPTOR_SIZE bytes
+ */
+RAMFUNC void vad_getDescriptor(struct vad_Info * vad, uint8_t * descriptor)
+{
+	comfort_Describe(vad->noise, vad->correlation, descriptor);
+}
@@ -89,6 +89,40 @@ LoopFillZerobss:
   cmp  r2, r3
   bcc  FillZerobss
 
+/* Copy time critical code from flash to SRAM */
+  movs  r1, #0
+  b  LoopCopyRamFuncInit
+
+CopyRamFuncInit:
+  ldr  r3, =_siramfunc
+  ldr  r3, [r3, r1]
+  str  r3, [r0, r1]
+  adds  r1, r1, #4
+
+LoopCopyRamFuncInit:
+  ldr  r0, =_sramfunc
+  ldr  r3, =_eramfunc
+  adds  r2, r0, r1
+  cmp  r2, r3
+  bcc  CopyRamFuncInit
+
+/* Copy the CCM RAM data initializers from flash */
+  movs  r1, #0
+  b  LoopCopyCcmDataInit
+
+CopyCcmDataInit:
+  ldr  r3, =_siccmram
+  ldr  r3, [r3, r1]
+  str  r3, [r0, r1]
+  adds  r1, r1, #4
+
+LoopCopyCcmDataInit:
+  ldr  r0, =_sccmram
+  ldr  r3, =_eccmram
+  adds  r2, r0, r1
+  cmp  r2, r3
+  bcc  CopyCcmDataInit
+
 /* Call the clock system intitialization function.*/
   bl  SystemInit   
 /* Call static constructors */
@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file           : check.h
+  * @brief          : Checks of the host tests: each failed check is printed,
+  *                   the test returns the number of failed checks
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef TESTS_CHECK_H_
+#define TESTS_CHECK_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+
+/* Exported variables --------------------------------------------------------*/
+
+static unsigned int check_failures = 0;
+
+/* Exported macros -----------------------------------------------------------*/
+
+/**
+ * @brief counts and prints a failed condition, with a printf-like message
+ */
+#define CHECK(condition, ...) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			check_failures += 1; \
+			printf("FAILED %s:%d: ", __FILE__, __LINE__); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+		} \
+	} while (0)
+
+/**
+ * @brief prints the result of a test, gives its exit code
+ */
+#define CHECK_RESULT(name) \
+	(printf("%s: %s (%u failed checks)\n", (name), (check_failures == 0) ? "passed" : "FAILED", check_failures), \
+	 (check_failures == 0) ? 0 : 1)
+
+#endif /* TESTS_CHECK_H_ */
@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file           : links_stub.h
+  * @brief          : Host stand-ins for links.c, pipeline.c and priority.c,
+  *                   to run the encoder and the decoder in the host tests.
+  *                   Stage tables are empty: frames go through unchanged.
+  *                   Tests have no interrupts: critical sections are empty.
+  *                   Included once by a test.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef TESTS_LINKS_STUB_H_
+#define TESTS_LINKS_STUB_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "links.h"
+#include "pipeline.h"
+#include "priority.h"
+#include "ring.h"
+
+/* Exported variables --------------------------------------------------------*/
+
+static uint32_t stub_errors[ERROR_KINDS];   /** Errors given to Stream_ErrorHandle, by kind */
+
+const struct stage_Info pipeline_emitterStages[] = { PIPELINE_END };
+const struct stage_Info pipeline_receiverStages[] = { PIPELINE_END };
+
+/* Exported functions --------------------------------------------------------*/
+
+HAL_StatusTypeDef pipeline_Start(struct pipeline_Info * pipeline, const struct stage_Info * stages)
+{
+	pipeline->stages = stages;
+	pipeline->stageCount = 0;
+	pipeline->length = 0;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef pipeline_Process(struct pipeline_Info * pipeline)
+{
+	return HAL_OK;
+}
+
+void encode_FinishedHandle(struct bitStream_Info * bitStream)
+{
+}
+
+void Stream_ErrorHandle(const void * stream, enum errorKind kind)
+{
+	stub_errors[kind] += 1;
+}
+
+uint32_t Priority_EnterCritical()
+{
+	return 0;
+}
+
+void Priority_ExitCritical(uint32_t state)
+{
+}
+
+/**
+ * @brief gives buffers to a pair of streams, like streamInit does with its slots
+ *
+ * @param sampleStream[IN] pointer to the sampleStream_Info structure
+ * @param samples[IN] buffer of the sample ring (sampleCount elements, a power of two)
+ * @param bitStream[IN] pointer to the bitStream_Info structure (NULL if not needed)
+ * @param bytes[IN] buffer of the bit ring (byteCount bytes, a power of two)
+ * @return HAL status (HAL_ERROR if a size isn't a power of two)
+ */
+static inline HAL_StatusTypeDef stub_streamInit(struct sampleStream_Info * sampleStream, uint16_t * samples, uint16_t sampleCount,
+                                                struct bitStream_Info * bitStream, uint8_t * bytes, uint16_t byteCount)
+{
+	HAL_StatusTypeDef status;
+
+	sampleStream->defaultBitStream = bitStream;
+	sampleStream->state = INACTIVE;
+	status = ring_Init(&(sampleStream->ring), samples, sampleCount, sizeof(uint16_t));
+	if ((status != HAL_OK) || (bitStream == NULL))
+	{
+		return status;
+	}
+
+	bitStream->huart = NULL;
+	bitStream->state = INACTIVE;
+	bitStream->transferLength = 0;
+	return ring_Init(&(bitStream->ring), bytes, byteCount, sizeof(uint8_t));
+}
+
+#endif /* TESTS_LINKS_STUB_H_ */
@@ -0,0 +1,129 @@
+/**
+  ******************************************************************************
+  * @file           : stm32f4xx_hal.h
+  * @brief          : Host stand-in for the HAL header, used by the host tests.
+  *                   Gives the types and CMSIS intrinsics used by the
+  *                   hardware-independent modules (ring, codecs, stages,
+  *                   encoder and decoder), and a DWT cycle counter counting
+  *                   nanoseconds of the host (see cycles.c)
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef TESTS_STM32F4XX_HAL_H_
+#define TESTS_STM32F4XX_HAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef enum
+{
+	HAL_OK = 0x00U,
+	HAL_ERROR = 0x01U,
+	HAL_BUSY = 0x02U,
+	HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+// Peripheral handles are only passed around by the modules under test
+typedef struct __UART_HandleTypeDef UART_HandleTypeDef;
+typedef struct __ADC_HandleTypeDef ADC_HandleTypeDef;
+typedef struct __DAC_HandleTypeDef DAC_HandleTypeDef;
+typedef struct __TIM_HandleTypeDef TIM_HandleTypeDef;
+
+typedef struct
+{
+	uint32_t CTRL;
+	uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+	uint32_t DEMCR;
+} CoreDebug_Type;
+
+/* Exported macros -----------------------------------------------------------*/
+
+#define __RAM_FUNC
+
+// Full barrier: orders the data and the counters of a ring between host threads, like DMB between interrupts
+#define __DMB() __sync_synchronize()
+
+#define DWT (host_DWT())
+#define DWT_CTRL_CYCCNTENA_Msk 0x01U
+#define CoreDebug (host_CoreDebug())
+#define CoreDebug_DEMCR_TRCENA_Msk 0x01000000U
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief gives the cycle counter, loaded with the monotonic clock of the host (ns)
+ */
+static inline DWT_Type * host_DWT(void)
+{
+	static DWT_Type dwt;
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	dwt.CYCCNT = (uint32_t)(now.tv_sec * 1000000000ULL + now.tv_nsec);
+	return &dwt;
+}
+
+/**
+ * @brief gives the debug registers (only the trace enable bit is used)
+ */
+static inline CoreDebug_Type * host_CoreDebug(void)
+{
+	static CoreDebug_Type coreDebug;
+
+	return &coreDebug;
+}
+
+/**
+ * @brief count leading zeros, 32 for 0 like the CLZ instruction
+ */
+static inline uint8_t __CLZ(uint32_t value)
+{
+	return (value == 0) ? 32 : (uint8_t)__builtin_clz(value);
+}
+
+/**
+ * @brief signed saturation to bits bits, like the SSAT instruction
+ */
+static inline int32_t __SSAT(int32_t value, uint32_t bits)
+{
+	int32_t max = (int32_t)((1U << (bits - 1)) - 1);
+
+	if (value > max)
+	{
+		return max;
+	}
+	if (value < -max - 1)
+	{
+		return -max - 1;
+	}
+	return value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTS_STM32F4XX_HAL_H_ */
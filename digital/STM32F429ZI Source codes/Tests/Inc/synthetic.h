@@ -0,0 +1,134 @@
+/**
+  ******************************************************************************
+  * @file           : synthetic.h
+  * @brief          : Synthetic signals of the host tests: talk spurts and
+  *                   random numbers. No recording comes with the repository:
+  *                   the stages are measured on these signals
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+#ifndef TESTS_SYNTHETIC_H_
+#define TESTS_SYNTHETIC_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief shape of talk spurts: each one follows a pause, with a random
+ * pitch and level drawn in the given ranges
+ */
+struct synthetic_Talk
+{
+	uint32_t frequency;   /** Sampling frequency (Hz) */
+	double pauseMin;      /** Pause before a spurt (s) */
+	double pauseRange;
+	double talkMin;       /** Length of a spurt (s) */
+	double talkRange;
+	double pitchMin;      /** Pitch of a spurt (Hz) */
+	double pitchRange;
+	double levelMin;      /** Peak level of a spurt (full scale is 1) */
+	double levelRange;
+	double vibrato;       /** Pitch variation (1.5Hz vibrato, 0.05 is 5%) */
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief gives a uniform random number between 0 and 1 (rand, seeded by the test)
+ */
+static inline double synthetic_Uniform(void)
+{
+	return rand() / (double)RAND_MAX;
+}
+
+/**
+ * @brief gives a normal random number (Box-Muller)
+ */
+static inline double synthetic_Gauss(void)
+{
+	double u = synthetic_Uniform() + 1e-12;
+	double v = synthetic_Uniform();
+
+	return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/**
+ * @brief fills samples with talk spurts: harmonics of the pitch (weaker
+ * above the 8th), 4 syllables per second, silent pauses in between
+ *
+ * @param samples[OUT] length samples
+ * @param length[IN] number of samples
+ * @param talk[IN] shape of the spurts
+ */
+static inline void synthetic_Talk(double * samples, uint32_t length, const struct synthetic_Talk * talk)
+{
+	uint32_t i = 0, k, pause, spurt;
+	double phase = 0, pitch, level, envelope, t, value;
+	uint32_t h;
+
+	while (i < length)
+	{
+		pause = (uint32_t)((talk->pauseMin + talk->pauseRange * synthetic_Uniform()) * talk->frequency);
+		spurt = (uint32_t)((talk->talkMin + talk->talkRange * synthetic_Uniform()) * talk->frequency);
+		pitch = talk->pitchMin + talk->pitchRange * synthetic_Uniform();
+		level = talk->levelMin + talk->levelRange * synthetic_Uniform();
+
+		for (k = 0; (k < pause + spurt) && (i < length); k++, i++)
+		{
+			value = 0;
+			if (k >= pause)
+			{
+				t = (k - pause) / (double)talk->frequency;
+				envelope = pow(fabs(sin(M_PI * 4 * t)), 0.7);
+				phase += 2 * M_PI * pitch * (1 + talk->vibrato * sin(2 * M_PI * 1.5 * t)) / talk->frequency;
+				for (h = 1; h * pitch < talk->frequency / 2 - 200; h++)
+				{
+					value += sin(h * phase) / (h * (1 + (h > 8)));
+				}
+				value *= level * envelope;
+			}
+			samples[i] = value;
+		}
+	}
+}
+
+/**
+ * @brief quantizes a value (full scale is 1) to bits bits, clipped like an ADC
+ *
+ * @param value[IN] the value
+ * @param bits[IN] width of the samples
+ * @param clipped[OUT] incremented if the value was clipped (NULL if not needed)
+ * @return the sample, signed, centered on 0
+ */
+static inline int16_t synthetic_Quantize(double value, uint8_t bits, uint32_t * clipped)
+{
+	long sample = lround(value * (1 << (bits - 1)));
+	long max = (1 << (bits - 1)) - 1;
+
+	if ((sample > max) || (sample < -max - 1))
+	{
+		sample = (sample > max) ? max : -max - 1;
+		if (clipped != NULL)
+		{
+			*clipped += 1;
+		}
+	}
+	return (int16_t)sample;
+}
+
+#endif /* TESTS_SYNTHETIC_H_ */
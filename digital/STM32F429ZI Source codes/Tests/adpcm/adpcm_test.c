@@ -0,0 +1,291 @@
+/**
+  ******************************************************************************
+  * @file           : adpcm_test.c
+  * @brief          : Host test of the IMA-ADPCM codec (adpcm.c), against
+  *                   raw PCM, through codec_Find
+  *
+  * Both codecs are run like encoder.c and decoder.c do: a header after
+  * every synchronization signal, then SYNC_PERIOD codes, two ADPCM codes
+  * per byte.
+  * - every header byte is below 0x80 and no byte of codes is SYNC_SIGNAL,
+  *   for tones, noise and full-scale square waves;
+  * - round trip: SNR of ADPCM next to the one of PCM, against the signal
+  *   before quantization;
+  * - a decoder starting in the middle of the stream decodes the same
+  *   samples as the other one from the next header.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "codec.h"
+#include "adpcm.h"
+#include "check.h"
+#include "synthetic.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SECONDS 20
+#define LENGTH (SAMPLING_FREQUENCY * SECONDS)
+#define FULL_SCALE (1 << (SAMPLE_SIZE - 1))
+#define LATE_START (LENGTH / 4 + 1)      // First sample seen by the late decoder
+
+/* Private types -------------------------------------------------------------*/
+
+enum signal
+{
+	SIGNAL_TONE,     /** 440Hz at -2dBFS */
+	SIGNAL_TONES,    /** 220Hz, 1300Hz and 3100Hz with a 3Hz envelope, and some noise */
+	SIGNAL_NOISE,    /** Uniform noise at full scale */
+	SIGNAL_SQUARE,   /** Square wave at full scale, 500Hz */
+	SIGNAL_SILENCE,
+	SIGNALS
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void testInfo(const struct codec_Info * codec);
+static void testSignal(const struct codec_Info * adpcm, const struct codec_Info * pcm, enum signal kind);
+static uint32_t runCodec(const struct codec_Info * codec, uint16_t * decoded, uint32_t lateFrom, uint16_t * lateDecoded);
+static double getSnr(const uint16_t * decoded);
+
+/* Private variables ---------------------------------------------------------*/
+
+static double reference[LENGTH];
+static uint16_t input[LENGTH];
+static uint16_t output[LENGTH];
+static uint16_t lateOutput[LENGTH];
+static uint16_t pcmOutput[LENGTH];
+static uint32_t badHeaders;
+static uint32_t syncBytes;
+static uint32_t wideCodes;
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	const struct codec_Info * adpcm = codec_Find(CODEC_ADPCM);
+	const struct codec_Info * pcm = codec_Find(CODEC_PCM);
+	uint8_t kind;
+
+	CHECK((adpcm != NULL) && (pcm != NULL), "codec_Find gave no codec");
+	if ((adpcm == NULL) || (pcm == NULL))
+	{
+		return CHECK_RESULT("adpcm");
+	}
+
+	testInfo(adpcm);
+	for (kind = 0; kind < SIGNALS; kind++)
+	{
+		testSignal(adpcm, pcm, kind);
+	}
+
+	return CHECK_RESULT("adpcm");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief description of the codec, against the limits of the encoder and decoder
+ */
+static void testInfo(const struct codec_Info * codec)
+{
+	CHECK(codec->id == CODEC_ADPCM, "id %u", codec->id);
+	CHECK(codec->id < 0x80, "id %u not below 0x80", codec->id);
+	CHECK((codec->codeBits == 4) && (codec->samplesPerCode == 1), "%u-bit codes of %u samples", codec->codeBits, codec->samplesPerCode);
+	CHECK((codec->headerSize == ADPCM_HEADER_SIZE) && (codec->headerSize <= CODEC_HEADER_SIZE), "header of %u bytes", codec->headerSize);
+	CHECK(codec->stateSize <= CODEC_STATE_SIZE, "state of %u bytes", codec->stateSize);
+	CHECK((codec->reset != NULL) && (codec->getHeader != NULL) && (codec->setHeader != NULL), "functions missing");
+}
+
+/**
+ * @brief encodes and decodes a signal with ADPCM and PCM
+ *
+ * @param adpcm[IN] the ADPCM codec
+ * @param pcm[IN] the PCM codec
+ * @param kind[IN] the signal
+ */
+static void testSignal(const struct codec_Info * adpcm, const struct codec_Info * pcm, enum signal kind)
+{
+	static const char * names[SIGNALS] = { "440Hz tone", "3 tones with noise", "noise", "square wave", "silence" };
+	uint32_t i, headers, lateFrom;
+	double t, value, snr, pcmSnr;
+
+	srand(4);
+	for (i = 0; i < LENGTH; i++)
+	{
+		t = i / (double)SAMPLING_FREQUENCY;
+		if (kind == SIGNAL_TONE)
+		{
+			value = 0.8 * sin(2 * M_PI * 440 * t);
+		}
+		else if (kind == SIGNAL_TONES)
+		{
+			value = (0.5 + 0.5 * sin(2 * M_PI * 3 * t)) * (0.4 * sin(2 * M_PI * 220 * t) + 0.25 * sin(2 * M_PI * 1300 * t + 1)
+			        + 0.1 * sin(2 * M_PI * 3100 * t)) + 0.02 * (synthetic_Uniform() - 0.5);
+		}
+		else if (kind == SIGNAL_NOISE)
+		{
+			value = synthetic_Uniform() * 2 - 1;
+		}
+		else if (kind == SIGNAL_SQUARE)
+		{
+			value = ((i * 1000 / SAMPLING_FREQUENCY) & 1) ? 1 : -1;
+		}
+		else
+		{
+			value = 0;
+		}
+		reference[i] = value * FULL_SCALE;
+		input[i] = (uint16_t)(synthetic_Quantize(value, SAMPLE_SIZE, NULL) + FULL_SCALE);
+	}
+
+	badHeaders = 0;
+	syncBytes = 0;
+	wideCodes = 0;
+	headers = runCodec(adpcm, output, LATE_START, lateOutput);
+	runCodec(pcm, pcmOutput, LENGTH, NULL);
+
+	CHECK(badHeaders == 0, "%s: %u header bytes not below 0x80", names[kind], badHeaders);
+	CHECK(syncBytes == 0, "%s: %u bytes of codes equal to SYNC_SIGNAL", names[kind], syncBytes);
+	CHECK(wideCodes == 0, "%s: %u codes wider than 4 bits", names[kind], wideCodes);
+
+	// The late decoder has the state of the encoder from the next header
+	lateFrom = (LATE_START + SYNC_PERIOD - 1) / SYNC_PERIOD * SYNC_PERIOD;
+	for (i = lateFrom; (i < LENGTH) && (lateOutput[i] == output[i]); i++)
+	{
+	}
+	CHECK(i >= LENGTH, "%s: late decoder still different at sample %u", names[kind], i);
+
+	if (kind == SIGNAL_SILENCE)
+	{
+		for (i = 0; (i < LENGTH) && (abs((int)output[i] - FULL_SCALE) <= 1); i++)
+		{
+		}
+		CHECK(i >= LENGTH, "silence decoded as %u at sample %u", output[i], i);
+		printf("%-18s %u headers, no byte equal to SYNC_SIGNAL, silence decoded as silence\n", names[kind], headers);
+		return;
+	}
+
+	snr = getSnr(output);
+	pcmSnr = getSnr(pcmOutput);
+	printf("%-18s %u headers, no byte equal to SYNC_SIGNAL, SNR %.1fdB (PCM %.1fdB)\n", names[kind], headers, snr, pcmSnr);
+	CHECK(pcmSnr > 60, "%s: PCM SNR of %.1fdB", names[kind], pcmSnr);
+	if (kind == SIGNAL_TONE)
+	{
+		CHECK(snr > 30, "%s: SNR of %.1fdB", names[kind], snr);
+	}
+	else if (kind == SIGNAL_TONES)
+	{
+		CHECK(snr > 20, "%s: SNR of %.1fdB", names[kind], snr);
+	}
+}
+
+/**
+ * @brief encodes input and decodes it, a header every SYNC_PERIOD codes
+ *
+ * Codes are gathered in bytes like encoder.c does, MSB first: bytes made of
+ * codes are counted in syncBytes if they are SYNC_SIGNAL (codecs without
+ * a state leave them to the encoder).
+ *
+ * @param codec[IN] the codec (codes of 4 or WORD_LENGTH bits)
+ * @param decoded[OUT] LENGTH samples decoded
+ * @param lateFrom[IN] first sample seen by a second decoder (LENGTH if none)
+ * @param lateDecoded[OUT] LENGTH samples decoded by the second decoder, 0 before its first header
+ * @return number of headers
+ */
+static uint32_t runCodec(const struct codec_Info * codec, uint16_t * decoded, uint32_t lateFrom, uint16_t * lateDecoded)
+{
+	static uint32_t encoder[CODEC_STATE_WORDS], decoder[CODEC_STATE_WORDS], late[CODEC_STATE_WORDS];
+	uint8_t header[CODEC_HEADER_SIZE];
+	uint32_t i, j, code, accumulator = 0, headers = 0;
+	uint8_t bits = 0, lateSynchronized = 0;
+
+	if (codec->reset != NULL)
+	{
+		codec->reset(encoder);
+		codec->reset(decoder);
+		codec->reset(late);
+	}
+	if (lateDecoded != NULL)
+	{
+		memset(lateDecoded, 0, LENGTH * sizeof(uint16_t));
+	}
+
+	for (i = 0; i < LENGTH; i++)
+	{
+		// Synchronization signal, id and header every SYNC_PERIOD codes
+		if (i % SYNC_PERIOD == 0)
+		{
+			accumulator = 0;
+			bits = 0;
+			if (codec->headerSize != 0)
+			{
+				codec->getHeader(encoder, header);
+				for (j = 0; j < codec->headerSize; j++)
+				{
+					badHeaders += (header[j] >= 0x80);
+				}
+				codec->setHeader(decoder, header);
+				if (i >= lateFrom)
+				{
+					codec->setHeader(late, header);
+					lateSynchronized = 1;
+				}
+			}
+			headers++;
+		}
+
+		code = codec->encode(encoder, &(input[i]));
+		wideCodes += (code >> codec->codeBits) != 0;
+		codec->decode(decoder, code, &(decoded[i]));
+		if (lateSynchronized)
+		{
+			codec->decode(late, code, &(lateDecoded[i]));
+		}
+
+		accumulator = (accumulator << codec->codeBits) | code;
+		bits += codec->codeBits;
+		while (bits >= 8)
+		{
+			bits -= 8;
+			syncBytes += (((accumulator >> bits) & 0xFF) == SYNC_SIGNAL) && (codec->stateSize != 0);
+		}
+	}
+
+	return headers;
+}
+
+/**
+ * @brief gives the SNR of decoded samples against the signal before
+ * quantization, from the second second
+ *
+ * @param decoded[IN] LENGTH samples
+ * @return the SNR (dB)
+ */
+static double getSnr(const uint16_t * decoded)
+{
+	double value, signal = 0, error = 0;
+	uint32_t i;
+
+	for (i = SAMPLING_FREQUENCY; i < LENGTH; i++)
+	{
+		value = (double)decoded[i] - FULL_SCALE - reference[i];
+		signal += reference[i] * reference[i];
+		error += value * value;
+	}
+
+	return (error == 0) ? 999 : 10 * log10(signal / error);
+}
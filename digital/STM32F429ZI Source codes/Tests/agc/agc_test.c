@@ -0,0 +1,291 @@
+/**
+  ******************************************************************************
+  * @file           : agc_test.c
+  * @brief          : Host test of the automatic gain control and its
+  *                   look-ahead limiter (agc.c)
+  *
+  * - limiter: bursts at full scale after the gain reached AGC_MAX_GAIN,
+  *   random full-scale frames, single peaks: no output sample above
+  *   AGC_LIMIT, none outside full scale;
+  * - synthetic sessions: talk spurts at normal, whisper, shout and normal
+  *   levels (30s each), the level of speech frames before and after the
+  *   stage and the time the gain takes to settle. The README figures are
+  *   the lines printed for the -60dBFS noise;
+  * - in a -40dBFS noise, the whisper with and without the noise
+  *   suppressor in front of the stage.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "agc.h"
+#include "denoise.h"
+#include "check.h"
+#include "synthetic.h"
+
+#if (AGC != 1) || (NOISE_SUPPRESSION != 1)
+#error "The AGC test needs AGC = 1 and NOISE_SUPPRESSION = 1"
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SEGMENT_SECONDS 30
+#define SEGMENTS 4
+#define SEGMENT_LENGTH (SAMPLING_FREQUENCY * SEGMENT_SECONDS)
+#define LENGTH (SEGMENT_LENGTH * SEGMENTS)
+#define FRAMES (LENGTH / FRAME_SIZE)
+#define SCALE_SHIFT (16 - SAMPLE_SIZE)
+#define FULL_SCALE (1 << (SAMPLE_SIZE - 1))
+#define QUIET_FRAMES 500                                                   // Quiet speech, gain close to AGC_MAX_GAIN
+#define LOUD_FRAMES 100
+#define CEILING ((AGC_LIMIT + ((1 << SCALE_SHIFT) >> 1)) >> SCALE_SHIFT)   // AGC_LIMIT at SAMPLE_SIZE bits
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void testLimiter(void);
+static void testSession(double noiseLevel, uint8_t denoised, uint8_t print);
+static uint32_t checkCeiling(const int16_t * samples, uint32_t length, const char * name);
+
+/* Private variables ---------------------------------------------------------*/
+
+static double clean[LENGTH];
+static int16_t input[LENGTH];
+static int16_t output[LENGTH];
+static double gains[FRAMES];
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	static struct agc_State agc;
+	int16_t frame[FRAME_SIZE] = { 0 };
+
+	CHECK(agc_Process(&agc, frame, FRAME_SIZE - 1) == HAL_ERROR, "frame of FRAME_SIZE - 1 samples accepted");
+
+	testLimiter();
+	testSession(-60, 0, 1);
+	testSession(-40, 0, 0);
+	testSession(-40, 1, 0);
+
+	return CHECK_RESULT("agc");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief the loudest inputs at the largest gain: the limiter alone keeps them under AGC_LIMIT
+ */
+static void testLimiter(void)
+{
+	static struct agc_State agc;
+	static int16_t samples[(QUIET_FRAMES + LOUD_FRAMES) * FRAME_SIZE];
+	uint32_t i, f, worst = 0;
+	uint8_t run;
+
+	srand(3);
+	for (run = 0; run < 3; run++)
+	{
+		agc_Start(&agc);
+		for (f = 0; f < QUIET_FRAMES + LOUD_FRAMES; f++)
+		{
+			for (i = 0; i < FRAME_SIZE; i++)
+			{
+				if (f < QUIET_FRAMES)
+				{
+					// Quiet speech at -60dBFS over a silent background: the gain goes up to AGC_MAX_GAIN
+					samples[f * FRAME_SIZE + i] = (f == 0) ? 0 : synthetic_Quantize(0.001 * sin(2 * M_PI * 200 * i / SAMPLING_FREQUENCY), SAMPLE_SIZE, NULL);
+				}
+				else if (run == 0)
+				{
+					// Full-scale square wave, both signs
+					samples[f * FRAME_SIZE + i] = (i % 24 < 12) ? FULL_SCALE - 1 : -FULL_SCALE;
+				}
+				else if (run == 1)
+				{
+					// Random samples at full scale
+					samples[f * FRAME_SIZE + i] = synthetic_Quantize(synthetic_Uniform() * 2 - 1, SAMPLE_SIZE, NULL);
+				}
+				else
+				{
+					// Single full-scale peaks in the quiet speech, at every position in a block
+					samples[f * FRAME_SIZE + i] = (i == f % FRAME_SIZE) ? -FULL_SCALE : 0;
+				}
+			}
+			if (f == QUIET_FRAMES)
+			{
+				CHECK(agc.gain > (AGC_MAX_GAIN - 1) * AGC_GAIN_ONE, "gain of %.2f before the loud inputs", agc.gain / (double)AGC_GAIN_ONE);
+			}
+			agc_Process(&agc, &(samples[f * FRAME_SIZE]), FRAME_SIZE);
+		}
+		CHECK(agc.limitedBlocks > 0, "loud inputs never limited");
+		i = checkCeiling(samples, (QUIET_FRAMES + LOUD_FRAMES) * FRAME_SIZE, "limiter");
+		worst = (i > worst) ? i : worst;
+	}
+
+	printf("Limiter: largest output %u (AGC_LIMIT is %u, full scale %u), from full-scale inputs at a gain of %u\n",
+	       worst, CEILING, FULL_SCALE, AGC_MAX_GAIN);
+}
+
+/**
+ * @brief talk spurts at four levels in a row, level of the speech frames and gain
+ *
+ * @param noiseLevel[IN] level of the background noise (dBFS)
+ * @param denoised[IN] 1 to run the noise suppressor in front of the stage
+ * @param print[IN] 1 to print every segment, 0 for the whisper only
+ */
+static void testSession(double noiseLevel, uint8_t denoised, uint8_t print)
+{
+	static const double levels[SEGMENTS] = { -20, -34, -8, -20 };
+	static const char * names[SEGMENTS] = { "Normal", "Whisper", "Shout", "Normal" };
+	static const struct synthetic_Talk talk = { SAMPLING_FREQUENCY, 0.3, 1.0, 0.5, 2.0, 100, 120, 0.6, 0.4, 0.05 };
+	static struct agc_State agc;
+	static struct denoise_State denoise;
+	double energy, scale, mean, deviation, speechIn, speechOut, in2, out2, lowest = 0, highest = -100;
+	uint32_t i, f, n, first, last, settled, frames, clipped = 0;
+	uint8_t s;
+
+	srand(1);
+	synthetic_Talk(clean, LENGTH, &talk);
+
+	// Talk spurts of each segment brought to its level (RMS), then the noise and the ADC
+	for (s = 0; s < SEGMENTS; s++)
+	{
+		energy = 0;
+		n = 0;
+		for (i = s * SEGMENT_LENGTH; i < (s + 1) * SEGMENT_LENGTH; i++)
+		{
+			if (clean[i] != 0)
+			{
+				energy += clean[i] * clean[i];
+				n++;
+			}
+		}
+		scale = pow(10, levels[s] / 20) / sqrt(energy / n);
+		for (i = s * SEGMENT_LENGTH; i < (s + 1) * SEGMENT_LENGTH; i++)
+		{
+			input[i] = synthetic_Quantize(clean[i] * scale + synthetic_Gauss() * pow(10, noiseLevel / 20), SAMPLE_SIZE, &clipped);
+		}
+	}
+
+	memcpy(output, input, sizeof(input));
+	agc_Start(&agc);
+	denoise_Start(&denoise);
+	for (f = 0; f < FRAMES; f++)
+	{
+		if (denoised)
+		{
+			denoise_Process(&denoise, &(output[f * FRAME_SIZE]), FRAME_SIZE);
+		}
+		agc_Process(&agc, &(output[f * FRAME_SIZE]), FRAME_SIZE);
+		gains[f] = 20 * log10(agc.gain / (double)AGC_GAIN_ONE);
+	}
+	checkCeiling(output, LENGTH, "session");
+
+	for (s = 0; s < SEGMENTS; s++)
+	{
+		first = s * SEGMENT_LENGTH / FRAME_SIZE;
+		last = (s + 1) * SEGMENT_LENGTH / FRAME_SIZE;
+
+		// Gain over the second half of the segment (mean and standard deviation), first frame within 3dB of it
+		mean = 0;
+		for (f = (first + last) / 2; f < last; f++)
+		{
+			mean += gains[f];
+		}
+		mean /= last - (first + last) / 2;
+		deviation = 0;
+		for (f = (first + last) / 2; f < last; f++)
+		{
+			deviation += (gains[f] - mean) * (gains[f] - mean);
+		}
+		deviation = sqrt(deviation / (last - (first + last) / 2));
+		for (settled = first; (settled < last) && (fabs(gains[settled] - mean) > 3); settled++)
+		{
+		}
+
+		// Speech frames over the second half (RMS averaged in dB), the output being AGC_LOOKAHEAD samples late
+		speechIn = 0;
+		speechOut = 0;
+		frames = 0;
+		for (f = (first + last) / 2; f < last; f++)
+		{
+			energy = 0;
+			in2 = 0;
+			out2 = 0;
+			for (i = f * FRAME_SIZE; i < (f + 1) * FRAME_SIZE; i++)
+			{
+				energy += clean[i] * clean[i];
+				in2 += (double)input[i] * input[i];
+				n = (i + AGC_LOOKAHEAD < LENGTH) ? i + AGC_LOOKAHEAD : i;
+				out2 += (double)output[n] * output[n];
+			}
+			if ((energy > 0) && (in2 > 0) && (out2 > 0))
+			{
+				speechIn += 10 * log10(in2 / FRAME_SIZE / FULL_SCALE / FULL_SCALE);
+				speechOut += 10 * log10(out2 / FRAME_SIZE / FULL_SCALE / FULL_SCALE);
+				frames++;
+			}
+		}
+		speechIn /= frames;
+		speechOut /= frames;
+		lowest = (speechOut < lowest) ? speechOut : lowest;
+		highest = (speechOut > highest) ? speechOut : highest;
+
+		if (print)
+		{
+			printf("%-7s %3.0fdBFS, noise %.0fdBFS: speech frames %.1f / %.1fdBFS, gain %+.1fdB (±%.1fdB), within 3dB after %.2fs\n",
+			       names[s], levels[s], noiseLevel, speechIn, speechOut, mean, deviation,
+			       (settled - first) * FRAME_SIZE / (double)SAMPLING_FREQUENCY);
+			// AGC_TARGET is the RMS of the speech level: syllables averaged in dB come out a few dB under it
+			CHECK(fabs(speechOut - 20 * log10(AGC_TARGET / 32768.0)) < 4, "%s speech at %.1fdBFS", names[s], speechOut);
+			CHECK((settled - first) * FRAME_SIZE < 2 * SAMPLING_FREQUENCY, "%s: gain settled after %.2fs", names[s],
+			      (settled - first) * FRAME_SIZE / (double)SAMPLING_FREQUENCY);
+		}
+		else if (s == 1)
+		{
+			printf("Whisper in a %.0fdBFS noise%s: gain %+.1fdB\n", noiseLevel, denoised ? ", noise suppressor in front" : "", mean);
+		}
+	}
+
+	if (print)
+	{
+		CHECK(highest - lowest < 1, "speech frames between %.1f and %.1fdBFS", lowest, highest);
+		printf("Samples clipped by the ADC: %u, blocks limited: %u\n", clipped, agc.limitedBlocks);
+	}
+}
+
+/**
+ * @brief checks that samples stay under AGC_LIMIT and within full scale
+ *
+ * @param samples[IN] the output of the stage
+ * @param length[IN] number of samples
+ * @param name[IN] name of the check, printed if it fails
+ * @return the largest magnitude
+ */
+static uint32_t checkCeiling(const int16_t * samples, uint32_t length, const char * name)
+{
+	uint32_t i, magnitude, worst = 0, over = 0, outside = 0;
+
+	for (i = 0; i < length; i++)
+	{
+		magnitude = abs(samples[i]);
+		worst = (magnitude > worst) ? magnitude : worst;
+		over += (magnitude > CEILING);
+		outside += (samples[i] > FULL_SCALE - 1) || (samples[i] < -FULL_SCALE);
+	}
+	CHECK(over == 0, "%s: %u samples above AGC_LIMIT (largest %u, limit %u)", name, over, worst, CEILING);
+	CHECK(outside == 0, "%s: %u samples outside full scale", name, outside);
+	return worst;
+}
@@ -0,0 +1,215 @@
+/**
+  ******************************************************************************
+  * @file           : congestion_test.c
+  * @brief          : Host test of the congestion adaptation of the encoder
+  *                   (adaptDepth in encoder.c), through the decoder
+  *
+  * encoder.c is included, not linked, to reach its state. The stages are
+  * replaced by empty tables (see links_stub.h). Synthetic talk (120s, short
+  * pauses) is given to encoder_streamUpdate frame by frame. A link carries
+  * 2 bytes per sample, except during 3s out of every 10s where it slows
+  * down: the bytes it carries go to decoder_streamUpdate.
+  * - link slowed down to 1.4, 1.2 and 1.05 bytes per sample: no frame
+  *   dropped, the step follows the rate (CODEC_PCM10 at least once, then
+  *   CODEC_PCM8 below 1.25 bytes per sample), and every sent frame comes out
+  *   of the decoder within half the dropped LSBs range;
+  * - back to 2 bytes per sample: CODEC_PCM again after at most two
+  *   CONGESTION_RECOVERY periods;
+  * - below 8 bits per sample (0.9 bytes per sample), frames are dropped
+  *   from CODEC_PCM8: only printed.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "config.h"
+#include "encoder.c"
+#include "decoder.h"
+#include "links_stub.h"
+#include "check.h"
+#include "synthetic.h"
+
+#if (CODEC != CODEC_PCM) || (CONGESTION_ADAPTATION != 1)
+#error "The congestion test needs CODEC = CODEC_PCM and CONGESTION_ADAPTATION = 1"
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SECONDS 120
+#define LENGTH (SAMPLING_FREQUENCY * SECONDS)
+#define FRAMES (LENGTH / FRAME_SIZE)
+#define FULL_SCALE (1 << (SAMPLE_SIZE - 1))
+#define FRAMES_PER_SECOND (SAMPLING_FREQUENCY / FRAME_SIZE)
+#define FULL_RATE 2.0                    // Bytes per sample carried by the link, out of congestion
+#define SLOW_FROM 5                      // The link slows down from SLOW_FROM to SLOW_TO s, every 10s
+#define SLOW_TO 8
+#define STEPS 3                          // CODEC_PCM, CODEC_PCM10, CODEC_PCM8
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void testRate(double rate);
+static uint8_t getStep(uint8_t id);
+
+/* Private variables ---------------------------------------------------------*/
+
+static double speech[LENGTH];
+static uint16_t input[LENGTH];
+static uint32_t sentFrames[FRAMES];      // Index of each frame sent by the encoder, in order
+static uint8_t sentSteps[FRAMES];        // Step of each sent frame
+static uint16_t ADC_samples[SAMPLE_BUFFER_SIZE];
+static uint16_t DAC_samples[SAMPLE_BUFFER_SIZE];
+static uint8_t txBytes[TX_BUFFER_SIZE];
+static uint8_t rxBytes[TX_BUFFER_SIZE];
+static struct encoder_Info encoder;
+static struct decoder_Info decoder;
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	const struct synthetic_Talk talk = { SAMPLING_FREQUENCY, 0.1, 0.2, 1.0, 2.0, 90, 160, 0.05, 0.35, 0.05 };
+	uint32_t clipped = 0;
+	uint32_t i;
+
+	srand(5);
+	synthetic_Talk(speech, LENGTH, &talk);
+	for (i = 0; i < LENGTH; i++)
+	{
+		input[i] = (uint16_t)(synthetic_Quantize(speech[i] + 0.003 * synthetic_Gauss(), SAMPLE_SIZE, &clipped) + FULL_SCALE);
+	}
+	CHECK(clipped == 0, "%u samples clipped", clipped);
+
+	testRate(1.4);
+	testRate(1.2);
+	testRate(1.05);
+	testRate(0.9);
+
+	return CHECK_RESULT("congestion");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief encodes the talk over a link slowed down to rate during 3s out of
+ * every 10s, decodes what the link carried and checks it
+ *
+ * @param rate[IN] bytes per sample carried by the slowed down link
+ */
+static void testRate(double rate)
+{
+	struct sampleStream_Info ADC_stream, DAC_stream;
+	struct bitStream_Info txStream, rxStream;
+	struct vad_Info vad;
+	uint16_t output[FRAME_SIZE];
+	uint32_t frame, queued = 0, samples = 0, altered = 0, slowFrames = 0, recovery = 0, longestRecovery = 0, i;
+	uint32_t stepFrames[STEPS] = { 0 };
+	uint8_t byte, step, slow, reached = 0;
+	int32_t error;
+	double credit = 0;
+	uint16_t count;
+
+	memset(&encoder, 0, sizeof(encoder));
+	memset(&decoder, 0, sizeof(decoder));
+	memset(stub_errors, 0, sizeof(stub_errors));
+	stub_streamInit(&ADC_stream, ADC_samples, SAMPLE_BUFFER_SIZE, &txStream, txBytes, TX_BUFFER_SIZE);
+	stub_streamInit(&DAC_stream, DAC_samples, SAMPLE_BUFFER_SIZE, &rxStream, rxBytes, TX_BUFFER_SIZE);
+
+	CHECK(encoder_streamStart(&encoder, &ADC_stream, &txStream) == HAL_OK, "%.2f: encoder_streamStart failed", rate);
+	CHECK(decoder_streamStart(&decoder, &rxStream, &DAC_stream) == HAL_OK, "%.2f: decoder_streamStart failed", rate);
+	vad_Start(&vad);
+
+	for (frame = 0; frame < FRAMES; frame++)
+	{
+		slow = ((frame / FRAMES_PER_SECOND) % 10 >= SLOW_FROM) && ((frame / FRAMES_PER_SECOND) % 10 < SLOW_TO);
+
+		ring_Write(&(ADC_stream.ring), &(input[frame * FRAME_SIZE]), FRAME_SIZE);
+		CHECK(encoder_streamUpdate(&encoder) == HAL_OK, "%.2f: encoder_streamUpdate failed at frame %u", rate, frame);
+		step = getStep(encoder.codec->id);
+
+		// The detector of the encoder sees the same frames
+		if (vad_Process(&vad, &(input[frame * FRAME_SIZE])))
+		{
+			sentSteps[queued] = step;
+			sentFrames[queued++] = frame;
+		}
+
+		if (slow)
+		{
+			slowFrames++;
+			stepFrames[step]++;
+			reached |= 1 << step;
+			recovery = 0;
+		}
+		else if (step != 0)
+		{
+			recovery++;
+			longestRecovery = (recovery > longestRecovery) ? recovery : longestRecovery;
+		}
+
+		// The link carries what it can from the Tx ring to the Rx ring
+		credit += (slow ? rate : FULL_RATE) * FRAME_SIZE;
+		while ((credit >= 1) && (ring_Read(&(txStream.ring), &byte, 1) == 1))
+		{
+			ring_Write(&(rxStream.ring), &byte, 1);
+			credit -= 1;
+		}
+		credit = (credit > 1) ? 1 : credit;
+
+		CHECK(decoder_streamUpdate(&decoder) == HAL_OK, "%.2f: decoder_streamUpdate failed at frame %u", rate, frame);
+		while ((count = ring_Read(&(DAC_stream.ring), output, FRAME_SIZE)) != 0)
+		{
+			for (i = 0; i < count; i++, samples++)
+			{
+				if ((stub_errors[BUFFER_OVERRUN] != 0) || (samples / FRAME_SIZE >= queued))
+				{
+					continue;
+				}
+
+				// Half the dropped LSBs range (2 bits per step), beyond that a bit was toggled against SYNC_SIGNAL
+				error = abs((int32_t)output[i] - input[sentFrames[samples / FRAME_SIZE] * FRAME_SIZE + samples % FRAME_SIZE]);
+				altered += (error > ((1 << (2 * sentSteps[samples / FRAME_SIZE])) >> 1));
+			}
+		}
+	}
+
+	printf("%.2f bytes per sample  %u frames dropped, %u of %u samples decoded (%u altered against SYNC_SIGNAL),"
+	       " slowed down %.0f%% / %.0f%% / %.0f%% of the time at 12 / 10 / 8 bits, back to 12 bits after %.2fs at most\n",
+	       rate, stub_errors[BUFFER_OVERRUN], samples, queued * FRAME_SIZE, altered, stepFrames[0] * 100.0 / slowFrames,
+	       stepFrames[1] * 100.0 / slowFrames, stepFrames[2] * 100.0 / slowFrames, longestRecovery / (double)FRAMES_PER_SECOND);
+
+	if (rate < 1)
+	{
+		CHECK(reached & (1 << 2), "%.2f: CODEC_PCM8 never used", rate);
+		return;
+	}
+
+	CHECK(stub_errors[BUFFER_OVERRUN] == 0, "%.2f: %u frames dropped", rate, stub_errors[BUFFER_OVERRUN]);
+	CHECK(queued * FRAME_SIZE - samples < 2 * FRAME_SIZE, "%.2f: %u samples decoded for %u frames", rate, samples, queued);
+	CHECK(altered * 100 < samples, "%.2f: %u samples altered", rate, altered);
+	CHECK(reached & (1 << 1), "%.2f: CODEC_PCM10 never used", rate);
+	CHECK((rate > 1.25) || (reached & (1 << 2)), "%.2f: CODEC_PCM8 never used", rate);
+	CHECK(longestRecovery <= 2 * CONGESTION_RECOVERY, "%.2f: %u frames to get back to CODEC_PCM", rate, longestRecovery);
+}
+
+/**
+ * @brief gives the congestion step of a codec
+ *
+ * @param id[IN] the codec id
+ * @return 0 for CODEC_PCM, 1 for CODEC_PCM10, 2 for CODEC_PCM8
+ */
+static uint8_t getStep(uint8_t id)
+{
+	return (id == CODEC_PCM10) ? 1 : ((id == CODEC_PCM8) ? 2 : 0);
+}
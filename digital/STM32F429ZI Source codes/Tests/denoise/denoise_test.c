@@ -0,0 +1,397 @@
+/**
+  ******************************************************************************
+  * @file           : denoise_test.c
+  * @brief          : Host test of the noise suppressor (denoise.c)
+  *
+  * denoise.c is included, not linked, to reach its FFT and its splits:
+  * - FFT round trip: the forward FFT and split of random frames are
+  *   compared with a DFT in double precision, then the inverse split and
+  *   FFT give the samples back;
+  * - the squares of the overlapping halves of the window sum to 1;
+  * - gain rule, bin by bin: Wiener gain with DENOISE_OVERSUBTRACTION,
+  *   never below DENOISE_GAIN_FLOOR;
+  * - whole stage: steady noise brought down to the gain floor, a tone well
+  *   above the noise let through, the output one frame late;
+  * - synthetic sessions: talk spurts under wind, water and steady noises
+  *   (60s each, SNR 0, 5 and 10dB), SNR before and after the stage. The
+  *   README figures are the lines printed for 5dB.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "denoise.c"
+#include "check.h"
+#include "synthetic.h"
+
+#if (NOISE_SUPPRESSION != 1)
+#error "The noise suppressor test needs NOISE_SUPPRESSION = 1"
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SECONDS 60
+#define LENGTH (SAMPLING_FREQUENCY * SECONDS)
+#define FULL_SCALE (1 << (SAMPLE_SIZE - 1))
+
+/* Private types -------------------------------------------------------------*/
+
+enum noise
+{
+	NOISE_WIND,     /** Low-pass, gusts at 0.2Hz */
+	NOISE_WATER,    /** Broadband, splashes at 1.4Hz */
+	NOISE_STEADY,   /** White plus low-pass */
+	NOISES
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void testRoundTrip(void);
+static void testWindow(void);
+static void testGain(void);
+static void testStage(void);
+static void testSession(enum noise kind, double snr);
+static double level(const int16_t * frame, uint32_t length);
+
+/* Private variables ---------------------------------------------------------*/
+
+static double clean[LENGTH];
+static double noise[LENGTH];
+static int16_t input[LENGTH];
+static int16_t output[LENGTH];
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	static const double snrs[] = { 5, 0, 10 };
+	uint8_t i, kind;
+
+	testRoundTrip();
+	testWindow();
+	testGain();
+	testStage();
+
+	for (i = 0; i < sizeof(snrs) / sizeof(snrs[0]); i++)
+	{
+		for (kind = 0; kind < NOISES; kind++)
+		{
+			testSession(kind, snrs[i]);
+		}
+	}
+
+	return CHECK_RESULT("denoise");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief FFT and splits of random frames against a DFT, then back to the samples
+ */
+static void testRoundTrip(void)
+{
+	int32_t original[DENOISE_FFT_SIZE];
+	double real, imaginary, error, worstSample = 0;
+	double binPower = 0, binError = 0, samplePower = 0, sampleError = 0;
+	uint16_t n, k, run;
+
+	srand(1);
+	for (run = 0; run < 20; run++)
+	{
+		// Two windowed frames at full scale (16 bits), zero-padded like in denoise_Process
+		for (n = 0; n < DENOISE_FFT_SIZE; n++)
+		{
+			original[n] = (n < 2 * FRAME_SIZE) ? (int32_t)lround((synthetic_Uniform() * 2 - 1) * 32767) : 0;
+			samples[n] = original[n];
+		}
+
+		fft(samples);
+		forwardSplit();
+
+		// Bins are left twice as large
+		for (k = 0; k < DENOISE_BINS; k++)
+		{
+			real = 0;
+			imaginary = 0;
+			for (n = 0; n < DENOISE_FFT_SIZE; n++)
+			{
+				real += original[n] * cos(2 * M_PI * k * n / DENOISE_FFT_SIZE);
+				imaginary -= original[n] * sin(2 * M_PI * k * n / DENOISE_FFT_SIZE);
+			}
+			binPower += 4 * (real * real + imaginary * imaginary);
+			binError += pow(spectrum[2 * k] - 2 * real, 2) + pow(spectrum[2 * k + 1] - 2 * imaginary, 2);
+		}
+
+		inverseSplit();
+		fft(samples);
+		for (n = 0; n < DENOISE_FFT_SIZE; n++)
+		{
+			// Imaginary parts are conjugated back, real parts are the samples
+			error = fabs((double)((samples[n] * ((n & 1) ? -1 : 1) + (1 << (INVERSE_SHIFT - 1))) >> INVERSE_SHIFT) - original[n]);
+			worstSample = (error > worstSample) ? error : worstSample;
+			samplePower += (double)original[n] * original[n];
+			sampleError += error * error;
+		}
+	}
+
+	// Full-scale random frames: the worst case for the rounding of the butterflies
+	binError = 10 * log10(binPower / binError);
+	sampleError = 10 * log10(samplePower / sampleError);
+	printf("FFT: %.1fdB SNR against the DFT, round trip %.1fdB SNR, largest error %.0f LSBs (16 bits)\n",
+	       binError, sampleError, worstSample);
+	CHECK(binError > 75, "FFT SNR of %.1fdB against the DFT", binError);
+	CHECK(sampleError > 70, "round trip SNR of %.1fdB", sampleError);
+	// Below 1 LSB of a 12-bit sample
+	CHECK(worstSample < 16, "round trip error of %.0f LSBs (16 bits)", worstSample);
+}
+
+/**
+ * @brief the squares of the overlapping halves of the window sum to 1
+ */
+static void testWindow(void)
+{
+	int32_t sum;
+	uint16_t i;
+
+	for (i = 0; i < FRAME_SIZE; i++)
+	{
+		sum = window[i] * window[i] + window[FRAME_SIZE - 1 - i] * window[FRAME_SIZE - 1 - i];
+		CHECK(abs(sum - (1 << 30)) < (1 << 18), "window %u: squares sum to %.5f", i, sum / (double)(1 << 30));
+	}
+}
+
+/**
+ * @brief gain of bins at a steady power, against 1 - DENOISE_OVERSUBTRACTION * noise / power
+ */
+static void testGain(void)
+{
+	static const double ratios[] = { 1.5, 2.5, 4, 10, 30, 1000 };
+	static struct denoise_State denoise;
+	double expected, noiseFloor, target;
+	uint32_t power = 1 << 20;
+	uint16_t i, k;
+
+	for (i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++)
+	{
+		denoise.started = 1;
+		for (k = 0; k < DENOISE_BINS; k++)
+		{
+			// Instantaneous power equal to the smoothed one: power >> POWER_SHIFT
+			spectrum[2 * k] = 1 << 16;
+			spectrum[2 * k + 1] = 0;
+			denoise.power[k] = power;
+			denoise.noise[k] = (uint32_t)(power / ratios[i]);
+			denoise.gain[k] = GAIN_ONE;
+		}
+
+		suppress(&denoise);
+
+		// Noise floor after its update (rising above twice the floor, following below), then the gain
+		noiseFloor = power / ratios[i];
+		noiseFloor += (ratios[i] >= NOISE_LIKE) ? noiseFloor / (1 << NOISE_RISE_SHIFT) + 1 : (power - noiseFloor) / (1 << NOISE_FOLLOW_SHIFT) + 1;
+		target = 1 - DENOISE_OVERSUBTRACTION * noiseFloor / power;
+		target = (target * GAIN_ONE < DENOISE_GAIN_FLOOR) ? DENOISE_GAIN_FLOOR : target * GAIN_ONE;
+		expected = GAIN_ONE + (target - GAIN_ONE) / (1 << GAIN_SMOOTH_SHIFT);
+
+		for (k = 0; k < DENOISE_BINS; k++)
+		{
+			CHECK(fabs(denoise.gain[k] - expected) <= 2, "power %.1f times the noise: gain %u, %.0f expected",
+			      ratios[i], denoise.gain[k], expected);
+			CHECK(labs(spectrum[2 * k] - (((int64_t)(1 << 16) * denoise.gain[k] + (1 << 14)) >> 15)) <= 1,
+			      "bin not scaled by its gain");
+		}
+		printf("Gain rule: power %6.1f times the noise floor, gain %.3f (floor %.3f)\n",
+		       ratios[i], denoise.gain[0] / (double)GAIN_ONE, DENOISE_GAIN_FLOOR / (double)GAIN_ONE);
+	}
+}
+
+/**
+ * @brief steady noise, then a tone over it, through the whole stage
+ */
+static void testStage(void)
+{
+	static struct denoise_State denoise;
+	int16_t frame[FRAME_SIZE];
+	double noiseIn = 0, noiseOut = 0, toneIn = 0, toneOut = 0;
+	uint16_t f, i, k;
+
+	CHECK(denoise_Process(&denoise, frame, FRAME_SIZE - 1) == HAL_ERROR, "frame of FRAME_SIZE - 1 samples accepted");
+
+	srand(2);
+	denoise_Start(&denoise);
+	for (f = 0; f < 1000; f++)
+	{
+		for (i = 0; i < FRAME_SIZE; i++)
+		{
+			frame[i] = synthetic_Quantize(0.01 * synthetic_Gauss(), SAMPLE_SIZE, NULL);
+			// A 1kHz tone at -20dBFS from the 5th second
+			if (f >= 500)
+			{
+				frame[i] += synthetic_Quantize(0.1 * sin(2 * M_PI * 1000 * (f * FRAME_SIZE + i) / SAMPLING_FREQUENCY), SAMPLE_SIZE, NULL);
+			}
+		}
+		if ((f >= 300) && (f < 500))
+		{
+			noiseIn += level(frame, FRAME_SIZE);
+		}
+		else if (f >= 700)
+		{
+			toneIn += level(frame, FRAME_SIZE);
+		}
+
+		denoise_Process(&denoise, frame, FRAME_SIZE);
+
+		// Output of the previous frame
+		if ((f >= 301) && (f < 501))
+		{
+			noiseOut += level(frame, FRAME_SIZE);
+		}
+		else if (f >= 701)
+		{
+			toneOut += level(frame, FRAME_SIZE);
+		}
+
+		for (k = 0; k < DENOISE_BINS; k++)
+		{
+			if (denoise.gain[k] < DENOISE_GAIN_FLOOR)
+			{
+				CHECK(0, "gain %u of bin %u below DENOISE_GAIN_FLOOR", denoise.gain[k], k);
+				break;
+			}
+		}
+	}
+
+	// Same frame counts on both sides: ratios of the summed levels
+	noiseOut = 10 * log10(noiseOut / noiseIn);
+	toneOut = 10 * log10(toneOut / toneIn);
+	printf("Steady noise at -43dBFS: %.1fdB (gain floor %.1fdB), 1kHz tone over it: %.1fdB\n",
+	       noiseOut, 20 * log10(DENOISE_GAIN_FLOOR / (double)GAIN_ONE), toneOut);
+	CHECK(fabs(noiseOut - 20 * log10(DENOISE_GAIN_FLOOR / (double)GAIN_ONE)) < 1.5, "steady noise changed by %.1fdB", noiseOut);
+	CHECK(fabs(toneOut) < 0.5, "tone changed by %.1fdB", toneOut);
+}
+
+/**
+ * @brief talk spurts under a noise, SNR before and after the stage
+ *
+ * @param kind[IN] the noise
+ * @param snr[IN] level of the speech over the noise (dB)
+ */
+static void testSession(enum noise kind, double snr)
+{
+	static const char * names[NOISES] = { "wind", "water", "steady" };
+	static const struct synthetic_Talk talk = { SAMPLING_FREQUENCY, 0.5, 2.0, 0.5, 2.0, 100, 80, 0.09, 0.12, 0.05 };
+	static struct denoise_State denoise;
+	double low1 = 0, low2 = 0, high = 0, previous = 0, white, value, scale;
+	double speech = 0, power = 0, errorIn, errorOut, clean2, in2, out2, pausesIn = 0, pausesOut = 0;
+	double segmentsIn = 0, segmentsOut = 0;
+	uint32_t i, f, segments = 0;
+
+	srand(1);
+	synthetic_Talk(clean, LENGTH, &talk);
+
+	for (i = 0; i < LENGTH; i++)
+	{
+		white = synthetic_Gauss();
+		if (kind == NOISE_WIND)
+		{
+			low1 += 0.02 * (white - low1);
+			low2 += 0.02 * (low1 - low2);
+			value = low2 * 8 * (1 + 0.5 * sin(2 * M_PI * 0.2 * i / SAMPLING_FREQUENCY) + 0.3 * sin(2 * M_PI * 0.53 * i / SAMPLING_FREQUENCY));
+		}
+		else if (kind == NOISE_WATER)
+		{
+			high = white - previous;
+			previous = white;
+			value = (0.6 * white + 0.4 * high) * (1 + 3 * pow(fabs(sin(2 * M_PI * 0.7 * i / SAMPLING_FREQUENCY)), 8));
+		}
+		else
+		{
+			low1 = 0.95 * low1 + 0.05 * white;
+			value = 0.5 * white + 2 * low1;
+		}
+		noise[i] = value;
+		speech += clean[i] * clean[i];
+		power += value * value;
+	}
+
+	scale = sqrt(speech / power / pow(10, snr / 10));
+	for (i = 0; i < LENGTH; i++)
+	{
+		noise[i] *= scale;
+		input[i] = synthetic_Quantize(clean[i] + noise[i], SAMPLE_SIZE, NULL);
+	}
+
+	memcpy(output, input, sizeof(input));
+	denoise_Start(&denoise);
+	for (i = 0; i + FRAME_SIZE <= LENGTH; i += FRAME_SIZE)
+	{
+		denoise_Process(&denoise, &(output[i]), FRAME_SIZE);
+	}
+
+	// Against the clean talk, the output being one frame late, after the first second
+	speech = 0;
+	errorIn = 0;
+	errorOut = 0;
+	for (f = SAMPLING_FREQUENCY / FRAME_SIZE; f + 1 < LENGTH / FRAME_SIZE; f++)
+	{
+		clean2 = 0;
+		in2 = 0;
+		out2 = 0;
+		for (i = f * FRAME_SIZE; i < (f + 1) * FRAME_SIZE; i++)
+		{
+			value = clean[i] * FULL_SCALE;
+			clean2 += value * value;
+			in2 += (input[i] - value) * (input[i] - value);
+			out2 += (output[i + FRAME_SIZE] - value) * (output[i + FRAME_SIZE] - value);
+		}
+		speech += clean2;
+		errorIn += in2;
+		errorOut += out2;
+
+		if (clean2 / FRAME_SIZE < 1)
+		{
+			pausesIn += in2;
+			pausesOut += out2;
+		}
+		else if (clean2 > in2 * 0.01)
+		{
+			segmentsIn += 10 * log10(clean2 / in2);
+			segmentsOut += 10 * log10(clean2 / out2);
+			segments++;
+		}
+	}
+
+	printf("%-6s SNR %4.1fdB: SNR %.1fdB / %.1fdB, segmental SNR %.1fdB / %.1fdB, noise in pauses %.1fdB\n",
+	       names[kind], snr, 10 * log10(speech / errorIn), 10 * log10(speech / errorOut),
+	       segmentsIn / segments, segmentsOut / segments, 10 * log10(pausesOut / pausesIn));
+	CHECK(10 * log10(errorIn / errorOut) > 3, "%s noise at %.0fdB: SNR improved by %.1fdB only", names[kind], snr, 10 * log10(errorIn / errorOut));
+	CHECK(segmentsOut > segmentsIn, "%s noise at %.0fdB: segmental SNR not improved", names[kind], snr);
+	CHECK(pausesOut < pausesIn / 2, "%s noise at %.0fdB: noise in pauses not attenuated", names[kind], snr);
+}
+
+/**
+ * @brief gives the energy of a frame
+ */
+static double level(const int16_t * frame, uint32_t length)
+{
+	double energy = 0;
+	uint32_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		energy += (double)frame[i] * frame[i];
+	}
+	return energy;
+}
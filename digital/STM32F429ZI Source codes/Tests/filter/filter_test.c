@@ -0,0 +1,269 @@
+/**
+  ******************************************************************************
+  * @file           : filter_test.c
+  * @brief          : Host test of the biquad cascades (biquad.c) and of the
+  *                   speech filters (filter.c)
+  *
+  * filter.c is included, not linked, to reach its sections. The response of
+  * a cascade at a frequency is measured with a tone, once its transient is
+  * over, against the figures given next to the sections:
+  * - DC_BLOCK: -31dB at 10Hz, -3dB at 60Hz, -0.5dB at 100Hz, flat above,
+  *   and a DC offset removed;
+  * - PRE_EMPHASIS: +3dB at 2kHz, +5.9dB at 4kHz, flat at low frequencies;
+  * - emitter then receiver stages: flat from 200Hz to 5kHz, DE_EMPHASIS
+  *   undoing PRE_EMPHASIS;
+  * - a tone above full scale after PRE_EMPHASIS is saturated, not wrapped;
+  * - biquad_Init refuses more than BIQUAD_MAX_SECTIONS sections.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "filter.c"
+#include "check.h"
+#include "synthetic.h"
+
+#if (SPEECH_FILTER != 1) || (SPEECH_EMPHASIS != 1) || (SAMPLING_FREQUENCY != 12000)
+#error "The filter test needs SPEECH_FILTER = 1, SPEECH_EMPHASIS = 1 and SAMPLING_FREQUENCY = 12000"
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SETTLE_SECONDS 2                 // Transient of the tone, not measured
+#define MEASURE_SECONDS 1                // Whole periods of tones at integer frequencies
+#define AMPLITUDE 500                    // Amplitude of the tones (LSBs), PRE_EMPHASIS doubles it
+#define FULL_SCALE (1 << (SAMPLE_SIZE - 1))
+
+/* Private types -------------------------------------------------------------*/
+
+struct point
+{
+	double frequency;   /** Frequency of the tone (Hz) */
+	double gain;        /** Expected gain (dB) */
+	double tolerance;   /** Largest difference (dB) */
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static double getGain(struct biquad_Info * first, struct biquad_Info * second, double frequency);
+static void testResponse(const char * name, const int32_t * sections, uint8_t count, const struct point * points, uint8_t pointCount);
+static void testStages(void);
+static void testOffset(void);
+static void testSaturation(void);
+
+/* Private variables ---------------------------------------------------------*/
+
+static const int32_t dcBlock[] = { DC_BLOCK };
+static const int32_t preEmphasis[] = { PRE_EMPHASIS };
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	static const struct point dcPoints[] =
+	{
+		{ 10, -31, 1 }, { 60, -3, 0.2 }, { 100, -0.5, 0.2 }, { 300, 0, 0.1 }, { 1000, 0, 0.05 }, { 5000, 0, 0.05 }
+	};
+	static const struct point emphasisPoints[] =
+	{
+		{ 100, 0, 0.2 }, { 300, 0.1, 0.3 }, { 2000, 3, 0.5 }, { 4000, 5.9, 0.2 }, { 5500, 6, 0.2 }
+	};
+	struct biquad_Info biquad;
+	int32_t sections[BIQUAD_COEFFICIENTS * (BIQUAD_MAX_SECTIONS + 1)] = { 0 };
+
+	testResponse("DC_BLOCK", dcBlock, 1, dcPoints, sizeof(dcPoints) / sizeof(dcPoints[0]));
+	testResponse("PRE_EMPHASIS", preEmphasis, 1, emphasisPoints, sizeof(emphasisPoints) / sizeof(emphasisPoints[0]));
+	testStages();
+	testOffset();
+	testSaturation();
+
+	CHECK(biquad_Init(&biquad, sections, BIQUAD_MAX_SECTIONS) == HAL_OK, "%u sections refused", BIQUAD_MAX_SECTIONS);
+	CHECK(biquad_Init(&biquad, sections, BIQUAD_MAX_SECTIONS + 1) == HAL_ERROR, "%u sections accepted", BIQUAD_MAX_SECTIONS + 1);
+
+	return CHECK_RESULT("filter");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief gives the gain of one or two cascades in a row at a frequency
+ *
+ * @param first[IN] pointer to the first cascade, cleared by biquad_Init
+ * @param second[IN] pointer to the second cascade (NULL if none)
+ * @param frequency[IN] frequency of the tone (Hz)
+ * @return the gain (dB)
+ */
+static double getGain(struct biquad_Info * first, struct biquad_Info * second, double frequency)
+{
+	int16_t frame[FRAME_SIZE];
+	double in = 0, inQuadrature = 0, out = 0, outQuadrature = 0, phase;
+	uint32_t i, k;
+
+	for (i = 0; i < (SETTLE_SECONDS + MEASURE_SECONDS) * SAMPLING_FREQUENCY; i += FRAME_SIZE)
+	{
+		for (k = 0; k < FRAME_SIZE; k++)
+		{
+			frame[k] = (int16_t)lround(AMPLITUDE * sin(2 * M_PI * frequency * (i + k) / SAMPLING_FREQUENCY));
+		}
+		biquad_Process(first, frame, FRAME_SIZE);
+		if (second != NULL)
+		{
+			biquad_Process(second, frame, FRAME_SIZE);
+		}
+		if (i < SETTLE_SECONDS * SAMPLING_FREQUENCY)
+		{
+			continue;
+		}
+
+		// Amplitude of the tone in the output, against the one of the input, whatever the phase
+		for (k = 0; k < FRAME_SIZE; k++)
+		{
+			phase = 2 * M_PI * frequency * (i + k) / SAMPLING_FREQUENCY;
+			in += lround(AMPLITUDE * sin(phase)) * sin(phase);
+			inQuadrature += lround(AMPLITUDE * sin(phase)) * cos(phase);
+			out += frame[k] * sin(phase);
+			outQuadrature += frame[k] * cos(phase);
+		}
+	}
+
+	return 10 * log10((out * out + outQuadrature * outQuadrature) / (in * in + inQuadrature * inQuadrature));
+}
+
+/**
+ * @brief measures the response of a cascade against expected points
+ *
+ * @param name[IN] name of the cascade
+ * @param sections[IN] its coefficients
+ * @param count[IN] its number of sections
+ * @param points[IN] expected gains
+ * @param pointCount[IN] number of points
+ */
+static void testResponse(const char * name, const int32_t * sections, uint8_t count, const struct point * points, uint8_t pointCount)
+{
+	struct biquad_Info biquad;
+	double gain;
+	uint8_t i;
+
+	printf("%-14s", name);
+	for (i = 0; i < pointCount; i++)
+	{
+		biquad_Init(&biquad, sections, count);
+		gain = getGain(&biquad, NULL, points[i].frequency);
+		printf(" %+.2fdB at %.0fHz%s", gain, points[i].frequency, (i + 1 < pointCount) ? "," : "\n");
+		CHECK(fabs(gain - points[i].gain) <= points[i].tolerance, "%s: %+.2fdB at %.0fHz, %+.1fdB expected",
+		      name, gain, points[i].frequency, points[i].gain);
+	}
+}
+
+/**
+ * @brief emitter stage then receiver stage: flat over the speech band
+ */
+static void testStages(void)
+{
+	struct biquad_Info emitter, receiver;
+	double gain, worst = 0, worstFrequency = 0, frequency;
+
+	for (frequency = 200; frequency <= 5000; frequency += 100)
+	{
+		CHECK((filter_StartEmitter(&emitter) == HAL_OK) && (filter_StartReceiver(&receiver) == HAL_OK), "stages not started");
+		gain = getGain(&emitter, &receiver, frequency);
+		if (fabs(gain) > fabs(worst))
+		{
+			worst = gain;
+			worstFrequency = frequency;
+		}
+	}
+
+	printf("both stages    at most %+.2fdB (at %.0fHz) from 200Hz to 5kHz\n", worst, worstFrequency);
+	CHECK(fabs(worst) < 0.2, "both stages: %+.2fdB at %.0fHz", worst, worstFrequency);
+}
+
+/**
+ * @brief a DC offset with a tone: the emitter stage removes the offset
+ */
+static void testOffset(void)
+{
+	struct biquad_Info emitter;
+	int16_t frame[FRAME_SIZE];
+	double mean = 0;
+	uint32_t i, k;
+
+	filter_StartEmitter(&emitter);
+	for (i = 0; i < (SETTLE_SECONDS + MEASURE_SECONDS) * SAMPLING_FREQUENCY; i += FRAME_SIZE)
+	{
+		for (k = 0; k < FRAME_SIZE; k++)
+		{
+			frame[k] = (int16_t)lround(300 + 200 * sin(2 * M_PI * 1000 * (i + k) / SAMPLING_FREQUENCY));
+		}
+		filter_Process(&emitter, frame, FRAME_SIZE);
+		for (k = 0; (k < FRAME_SIZE) && (i >= SETTLE_SECONDS * SAMPLING_FREQUENCY); k++)
+		{
+			mean += frame[k] / (double)(MEASURE_SECONDS * SAMPLING_FREQUENCY);
+		}
+	}
+
+	printf("DC offset      300 LSBs brought down to %.2f\n", mean);
+	CHECK(fabs(mean) < 0.5, "DC offset of %.2f left", mean);
+}
+
+/**
+ * @brief a full-scale 3kHz tone, above full scale after PRE_EMPHASIS: saturated, never wrapped
+ *
+ * The emitter sections are also run in double precision: each output sample
+ * should be this one, clipped to SAMPLE_SIZE bits.
+ */
+static void testSaturation(void)
+{
+	struct biquad_Info emitter;
+	int16_t frame[FRAME_SIZE];
+	double state[4 * BIQUAD_MAX_SECTIONS] = { 0 };
+	double value, filtered, clipped, worst = 0;
+	const int32_t * coefficients;
+	uint32_t i, k, s, saturated = 0;
+
+	filter_StartEmitter(&emitter);
+	for (i = 0; i < SETTLE_SECONDS * SAMPLING_FREQUENCY; i += FRAME_SIZE)
+	{
+		for (k = 0; k < FRAME_SIZE; k++)
+		{
+			frame[k] = (int16_t)lround((FULL_SCALE - 1) * sin(2 * M_PI * 3000 * (i + k) / SAMPLING_FREQUENCY + 0.3));
+		}
+		for (k = 0; k < FRAME_SIZE; k++)
+		{
+			value = frame[k];
+			coefficients = emitterSections;
+			for (s = 0; s < sizeof(emitterSections) / (BIQUAD_COEFFICIENTS * sizeof(int32_t)); s++, coefficients += BIQUAD_COEFFICIENTS)
+			{
+				filtered = (coefficients[0] * value + coefficients[1] * state[4 * s] + coefficients[2] * state[4 * s + 1]
+				            + coefficients[3] * state[4 * s + 2] + coefficients[4] * state[4 * s + 3]) / BIQUAD_ONE;
+				state[4 * s + 1] = state[4 * s];
+				state[4 * s] = value;
+				state[4 * s + 3] = state[4 * s + 2];
+				state[4 * s + 2] = filtered;
+				value = filtered;
+			}
+			clipped = (value > FULL_SCALE - 1) ? (FULL_SCALE - 1) : ((value < -FULL_SCALE) ? -FULL_SCALE : value);
+			saturated += (clipped != value);
+
+			filter_Process(&emitter, &(frame[k]), 1);
+			worst = (fabs(frame[k] - clipped) > worst) ? fabs(frame[k] - clipped) : worst;
+		}
+	}
+
+	printf("saturation     %u of %u samples above full scale, clipped (at most %.2f LSBs from the clipped filter)\n",
+	       saturated, SETTLE_SECONDS * SAMPLING_FREQUENCY, worst);
+	CHECK(saturated > SETTLE_SECONDS * SAMPLING_FREQUENCY / 4, "only %u samples above full scale", saturated);
+	CHECK(worst < 1.5, "%.2f LSBs from the clipped filter", worst);
+}
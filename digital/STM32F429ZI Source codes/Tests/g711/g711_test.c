@@ -0,0 +1,245 @@
+/**
+  ******************************************************************************
+  * @file           : g711_test.c
+  * @brief          : Host test of the G.711 codecs (g711.c), through
+  *                   codec_Find(CODEC_MULAW) and codec_Find(CODEC_ALAW)
+  *
+  * - every code: the sample it gives is encoded back into a code giving the
+  *   same sample, and samples grow with the magnitude bits of the code;
+  * - round trip: SNR against the signal before quantization, for a tone at
+  *   two levels (companding keeps the SNR of quiet signals) and tones with
+  *   noise;
+  * - time taken by the encoder and the decoder per sample, next to PCM and
+  *   IMA-ADPCM, in nanoseconds of the host (DWT stand-in of Inc/): only
+  *   printed, times of the PC don't give the cycles of the STM32F429ZI.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "codec.h"
+#include "g711.h"
+#include "check.h"
+#include "synthetic.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SECONDS 20
+#define LENGTH (SAMPLING_FREQUENCY * SECONDS)
+#define FULL_SCALE (1 << (SAMPLE_SIZE - 1))
+#define TIMED_RUNS 10                    // Runs over the signal whose fastest one is printed
+
+/* Private types -------------------------------------------------------------*/
+
+enum signal
+{
+	SIGNAL_TONE,     /** 440Hz at -2dBFS */
+	SIGNAL_QUIET,    /** 440Hz at -30dBFS */
+	SIGNAL_TONES,    /** 220Hz, 1300Hz and 3100Hz with a 3Hz envelope, and some noise */
+	SIGNALS
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void testCodes(const struct codec_Info * codec);
+static void makeSignal(enum signal kind);
+static double getSnr(const struct codec_Info * codec);
+static void timeCodec(const struct codec_Info * codec);
+
+/* Private variables ---------------------------------------------------------*/
+
+static double reference[LENGTH];
+static uint16_t input[LENGTH];
+static uint16_t output[LENGTH];
+static uint32_t codes[LENGTH];
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	static const char * names[SIGNALS] = { "440Hz tone", "quiet 440Hz tone", "3 tones with noise" };
+	static const double limits[SIGNALS] = { 35, 30, 30 };   // Lowest SNR of G.711 (dB)
+	const struct codec_Info * muLaw = codec_Find(CODEC_MULAW);
+	const struct codec_Info * aLaw = codec_Find(CODEC_ALAW);
+	const struct codec_Info * pcm = codec_Find(CODEC_PCM);
+	const struct codec_Info * adpcm = codec_Find(CODEC_ADPCM);
+	double muSnr, aSnr;
+	uint8_t kind;
+
+	CHECK((muLaw != NULL) && (aLaw != NULL) && (pcm != NULL) && (adpcm != NULL), "codec_Find gave no codec");
+	if ((muLaw == NULL) || (aLaw == NULL) || (pcm == NULL) || (adpcm == NULL))
+	{
+		return CHECK_RESULT("g711");
+	}
+
+	testCodes(muLaw);
+	testCodes(aLaw);
+
+	for (kind = 0; kind < SIGNALS; kind++)
+	{
+		makeSignal(kind);
+		muSnr = getSnr(muLaw);
+		aSnr = getSnr(aLaw);
+		printf("%-18s SNR mu-law %.1fdB, A-law %.1fdB, PCM %.1fdB\n", names[kind], muSnr, aSnr, getSnr(pcm));
+		CHECK(muSnr > limits[kind], "%s: mu-law SNR of %.1fdB", names[kind], muSnr);
+		CHECK(aSnr > limits[kind], "%s: A-law SNR of %.1fdB", names[kind], aSnr);
+	}
+
+	// Times over the tones with noise
+	timeCodec(pcm);
+	timeCodec(adpcm);
+	timeCodec(muLaw);
+	timeCodec(aLaw);
+
+	return CHECK_RESULT("g711");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief checks the description of a G.711 codec and each of its codes
+ *
+ * @param codec[IN] the codec
+ */
+static void testCodes(const struct codec_Info * codec)
+{
+	uint16_t sample, again, previous = 0;
+	uint32_t code, magnitude, back, badCodes = 0, unordered = 0;
+
+	CHECK(codec->id < 0x80, "%s: id %u not below 0x80", codec->name, codec->id);
+	CHECK((codec->codeBits == G711_CODE_BITS) && (codec->samplesPerCode == 1), "%s: %u-bit codes of %u samples",
+	      codec->name, codec->codeBits, codec->samplesPerCode);
+	CHECK((codec->headerSize == 0) && (codec->stateSize == 0), "%s: header of %u bytes, state of %u bytes",
+	      codec->name, codec->headerSize, codec->stateSize);
+
+	for (code = 0; code < 256; code++)
+	{
+		codec->decode(NULL, code, &sample);
+		back = codec->encode(NULL, &sample);
+		codec->decode(NULL, back, &again);
+		badCodes += (again != sample) || ((back >> G711_CODE_BITS) != 0);
+	}
+	CHECK(badCodes == 0, "%s: %u codes not given back", codec->name, badCodes);
+
+	// Positive samples, from the smallest magnitude (mu-law codes are inverted, A-law ones have even bits inverted)
+	for (magnitude = 0; magnitude < 128; magnitude++)
+	{
+		code = (codec->id == CODEC_MULAW) ? (0xFF - magnitude) : ((0x80 | magnitude) ^ 0x55);
+		codec->decode(NULL, code, &sample);
+		unordered += (magnitude != 0) && (sample < previous);
+		previous = sample;
+	}
+	CHECK(unordered == 0, "%s: %u positive codes below the previous one", codec->name, unordered);
+}
+
+/**
+ * @brief fills input with a signal, and reference with the signal before quantization
+ *
+ * @param kind[IN] the signal
+ */
+static void makeSignal(enum signal kind)
+{
+	uint32_t i;
+	double t, value;
+
+	srand(4);
+	for (i = 0; i < LENGTH; i++)
+	{
+		t = i / (double)SAMPLING_FREQUENCY;
+		if (kind == SIGNAL_TONE)
+		{
+			value = 0.8 * sin(2 * M_PI * 440 * t);
+		}
+		else if (kind == SIGNAL_QUIET)
+		{
+			value = 0.032 * sin(2 * M_PI * 440 * t);
+		}
+		else
+		{
+			value = (0.5 + 0.5 * sin(2 * M_PI * 3 * t)) * (0.4 * sin(2 * M_PI * 220 * t) + 0.25 * sin(2 * M_PI * 1300 * t + 1)
+			        + 0.1 * sin(2 * M_PI * 3100 * t)) + 0.02 * (synthetic_Uniform() - 0.5);
+		}
+		reference[i] = value * FULL_SCALE;
+		input[i] = (uint16_t)(synthetic_Quantize(value, SAMPLE_SIZE, NULL) + FULL_SCALE);
+	}
+}
+
+/**
+ * @brief encodes and decodes input, gives the SNR against the signal before quantization
+ *
+ * @param codec[IN] a codec of one sample per code
+ * @return the SNR (dB)
+ */
+static double getSnr(const struct codec_Info * codec)
+{
+	static uint32_t encoder[CODEC_STATE_WORDS], decoder[CODEC_STATE_WORDS];
+	double value, signal = 0, error = 0;
+	uint32_t i;
+
+	if (codec->reset != NULL)
+	{
+		codec->reset(encoder);
+		codec->reset(decoder);
+	}
+	for (i = 0; i < LENGTH; i++)
+	{
+		codec->decode(decoder, codec->encode(encoder, &(input[i])), &(output[i]));
+		value = (double)output[i] - FULL_SCALE - reference[i];
+		signal += reference[i] * reference[i];
+		error += value * value;
+	}
+
+	return (error == 0) ? 999 : 10 * log10(signal / error);
+}
+
+/**
+ * @brief prints the time taken by the encoder and the decoder per sample,
+ * the fastest of TIMED_RUNS runs over input
+ *
+ * @param codec[IN] a codec of one sample per code
+ */
+static void timeCodec(const struct codec_Info * codec)
+{
+	static uint32_t encoder[CODEC_STATE_WORDS], decoder[CODEC_STATE_WORDS];
+	uint32_t i, run, start, elapsed, encodeTime = UINT32_MAX, decodeTime = UINT32_MAX;
+
+	for (run = 0; run < TIMED_RUNS; run++)
+	{
+		if (codec->reset != NULL)
+		{
+			codec->reset(encoder);
+			codec->reset(decoder);
+		}
+
+		start = DWT->CYCCNT;
+		for (i = 0; i < LENGTH; i++)
+		{
+			codes[i] = codec->encode(encoder, &(input[i]));
+		}
+		elapsed = DWT->CYCCNT - start;
+		encodeTime = (elapsed < encodeTime) ? elapsed : encodeTime;
+
+		start = DWT->CYCCNT;
+		for (i = 0; i < LENGTH; i++)
+		{
+			codec->decode(decoder, codes[i], &(output[i]));
+		}
+		elapsed = DWT->CYCCNT - start;
+		decodeTime = (elapsed < decodeTime) ? elapsed : decodeTime;
+	}
+
+	printf("%-18s encode %.1fns, decode %.1fns per sample (host)\n", codec->name, encodeTime / (double)LENGTH,
+	       decodeTime / (double)LENGTH);
+}
@@ -0,0 +1,251 @@
+/**
+  ******************************************************************************
+  * @file           : howl_test.c
+  * @brief          : Host test of the howling suppressor (howl.c)
+  *
+  * howl.c is included, not linked, to reach the positions of its notches.
+  * Tones stand for howling, over a -50dBFS white noise:
+  * - placement: a -20dBFS tone at frequencies between bins and on a bin
+  *   gets one notch, within NOTCH_SPAN of its frequency, in about
+  *   HOWL_PERSISTENCE checks, and the tone is attenuated in the output;
+  * - tones howling one after another, each one stopping once notched as its
+  *   loop is closed, get one notch each: the notch of the first one is moved
+  *   to the last one when HOWL_NOTCHES are used. The mean of the spectrum
+  *   includes the tones, tones of the same level at once aren't all peaks;
+  * - release: once the tone stops, its notch is removed after HOWL_RELEASE
+  *   checks;
+  * - synthetic talk alone (60s, vibrato on its pitch) deploys no notch.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "howl.c"
+#include "check.h"
+#include "synthetic.h"
+
+#if (HOWL_SUPPRESSION != 1) || (FRAME_SIZE != 120) || (HOWL_NOTCHES != 4)
+#error "The howl test needs HOWL_SUPPRESSION = 1, FRAME_SIZE = 120 and HOWL_NOTCHES = 4"
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+
+#define BIN_WIDTH ((double)SAMPLING_FREQUENCY / FRAME_SIZE)   // Hz
+#define NOISE 0.003                      // Standard deviation of the background noise (-50dBFS)
+#define TONE 0.1                         // Amplitude of the tones (-20dBFS)
+#define TONE_SECONDS 2                   // Length of the tones
+#define TALK_SECONDS 60
+#define SEQUENCE (HOWL_NOTCHES + 1)   // Tones howling one after another
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void testPlacement(double frequency);
+static void testSequence(void);
+static void testTalk(void);
+static void run(const double * frequencies, uint8_t count, uint32_t frames, uint32_t * firstDeployed);
+static double getPosition(uint8_t notch);
+
+/* Private variables ---------------------------------------------------------*/
+
+static struct howl_State howl;
+static int16_t frame[FRAME_SIZE];
+static uint32_t sampleCount;             // Samples given to the stage since howl_Start
+static double toneIn;                    // Power of the first tone in the input, then in the output, over the last second
+static double toneOut;
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	static const double frequencies[] = { 437, 1000, 1234.5, 1650, 2710, 3333, 4850 };
+	uint8_t i;
+
+	srand(3);
+	for (i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++)
+	{
+		testPlacement(frequencies[i]);
+	}
+	testSequence();
+	testTalk();
+
+	return CHECK_RESULT("howl");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief one tone: position of its notch, time to deploy it, attenuation, release
+ *
+ * @param frequency[IN] frequency of the tone (Hz)
+ */
+static void testPlacement(double frequency)
+{
+	uint32_t firstDeployed = 0, released;
+	double error, attenuation;
+
+	howl_Start(&howl);
+	sampleCount = 0;
+	run(&frequency, 1, TONE_SECONDS * SAMPLING_FREQUENCY / FRAME_SIZE, &firstDeployed);
+
+	CHECK(howl.notches.sections == 1, "%.1fHz: %u notches", frequency, howl.notches.sections);
+	if (howl.notches.sections != 1)
+	{
+		return;
+	}
+	error = getPosition(0) - frequency;
+	attenuation = 10 * log10(toneOut / toneIn);
+
+	// The tone stops: its bin is checked every HOWL_GROUPS frames
+	for (released = 0; (howl.notches.sections != 0) && (released < 2 * HOWL_RELEASE * HOWL_GROUPS); released++)
+	{
+		run(NULL, 0, 1, NULL);
+	}
+
+	printf("%7.1fHz  notch at %7.1fHz (%+.1fHz) after %.2fs, tone %+.1fdB, released after %u checks\n", frequency,
+	       frequency + error, error, firstDeployed * FRAME_SIZE / (double)SAMPLING_FREQUENCY, attenuation, released / HOWL_GROUPS);
+	CHECK(fabs(error) < NOTCH_SPAN * BIN_WIDTH / (1 << POSITION_SHIFT), "%.1fHz: notch %+.1fHz away", frequency, error);
+	CHECK(firstDeployed <= (HOWL_PERSISTENCE + 2) * HOWL_GROUPS, "%.1fHz: notch after %u frames", frequency, firstDeployed);
+	CHECK(attenuation < -20, "%.1fHz: tone %+.1fdB", frequency, attenuation);
+	CHECK(howl.notches.sections == 0, "%.1fHz: notch not released", frequency);
+	CHECK(released / HOWL_GROUPS >= HOWL_RELEASE - 1, "%.1fHz: released after %u checks", frequency, released / HOWL_GROUPS);
+}
+
+/**
+ * @brief tones howling one after another, each one stopping once notched (its
+ * loop is closed): one notch each, the oldest one moved after HOWL_NOTCHES
+ */
+static void testSequence(void)
+{
+	static const double frequencies[SEQUENCE] = { 780, 1650, 2420, 3910, 5120 };
+	uint32_t frames, deployed;
+	uint8_t i, k, placed = 0, first = 0;
+
+	howl_Start(&howl);
+	sampleCount = 0;
+	for (i = 0; i < SEQUENCE; i++)
+	{
+		for (frames = 0, deployed = howl.deployed; (howl.deployed == deployed) && (frames < TONE_SECONDS * SAMPLING_FREQUENCY / FRAME_SIZE); frames++)
+		{
+			run(&(frequencies[i]), 1, 1, NULL);
+		}
+		run(NULL, 0, SAMPLING_FREQUENCY / FRAME_SIZE, NULL);
+	}
+
+	for (i = 0; i < howl.notches.sections; i++)
+	{
+		for (k = 0; k < SEQUENCE; k++)
+		{
+			if (fabs(getPosition(i) - frequencies[k]) < NOTCH_SPAN * BIN_WIDTH / (1 << POSITION_SHIFT))
+			{
+				placed++;
+				first += (k == 0);
+			}
+		}
+	}
+
+	printf("%u tones    %u notches deployed, %u kept, %u on a tone, %u on the first one\n", SEQUENCE, howl.deployed,
+	       howl.notches.sections, placed, first);
+	CHECK(howl.deployed == SEQUENCE, "%u notches deployed for %u tones", howl.deployed, SEQUENCE);
+	CHECK(howl.notches.sections == HOWL_NOTCHES, "%u notches kept", howl.notches.sections);
+	CHECK((placed == howl.notches.sections) && (first == 0), "%u notches on a tone, %u on the first one", placed, first);
+}
+
+/**
+ * @brief synthetic talk over the noise: no notch
+ */
+static void testTalk(void)
+{
+	const struct synthetic_Talk talk = { SAMPLING_FREQUENCY, 0.5, 2.5, 0.5, 2.0, 90, 160, 0.1, 0.3, 0.05 };
+	static double speech[TALK_SECONDS * SAMPLING_FREQUENCY];
+	uint32_t i, k;
+
+	synthetic_Talk(speech, TALK_SECONDS * SAMPLING_FREQUENCY, &talk);
+	howl_Start(&howl);
+	for (i = 0; i < TALK_SECONDS * SAMPLING_FREQUENCY; i += FRAME_SIZE)
+	{
+		for (k = 0; k < FRAME_SIZE; k++)
+		{
+			frame[k] = synthetic_Quantize(speech[i + k] + NOISE * synthetic_Gauss(), SAMPLE_SIZE, NULL);
+		}
+		howl_Process(&howl, frame, FRAME_SIZE);
+	}
+
+	printf("talk       %u notches deployed in %us\n", howl.deployed, TALK_SECONDS);
+	CHECK(howl.deployed == 0, "talk: %u notches deployed", howl.deployed);
+}
+
+/**
+ * @brief gives frames of tones over the noise to the stage
+ *
+ * @param frequencies[IN] frequencies of the tones (Hz)
+ * @param count[IN] number of tones
+ * @param frames[IN] number of frames
+ * @param firstDeployed[OUT] frames before the first notch (NULL if not needed)
+ */
+static void run(const double * frequencies, uint8_t count, uint32_t frames, uint32_t * firstDeployed)
+{
+	double value, phase, inPhase[2] = { 0 }, outPhase[2] = { 0 };
+	uint32_t i, k;
+	uint8_t t;
+
+	for (i = 0; i < frames; i++)
+	{
+		for (k = 0; k < FRAME_SIZE; k++)
+		{
+			value = NOISE * synthetic_Gauss();
+			for (t = 0; t < count; t++)
+			{
+				value += TONE * sin(2 * M_PI * frequencies[t] * (sampleCount + k) / SAMPLING_FREQUENCY);
+			}
+			frame[k] = synthetic_Quantize(value, SAMPLE_SIZE, NULL);
+
+			// First tone in the input, over the last second
+			if ((count != 0) && (i >= frames - SAMPLING_FREQUENCY / FRAME_SIZE))
+			{
+				phase = 2 * M_PI * frequencies[0] * (sampleCount + k) / SAMPLING_FREQUENCY;
+				inPhase[0] += frame[k] * sin(phase);
+				inPhase[1] += frame[k] * cos(phase);
+			}
+		}
+
+		howl_Process(&howl, frame, FRAME_SIZE);
+		if ((firstDeployed != NULL) && (howl.deployed == 0))
+		{
+			*firstDeployed = i + 1;
+		}
+
+		for (k = 0; (count != 0) && (i >= frames - SAMPLING_FREQUENCY / FRAME_SIZE) && (k < FRAME_SIZE); k++)
+		{
+			phase = 2 * M_PI * frequencies[0] * (sampleCount + k) / SAMPLING_FREQUENCY;
+			outPhase[0] += frame[k] * sin(phase);
+			outPhase[1] += frame[k] * cos(phase);
+		}
+		sampleCount += FRAME_SIZE;
+	}
+
+	toneIn = inPhase[0] * inPhase[0] + inPhase[1] * inPhase[1];
+	toneOut = outPhase[0] * outPhase[0] + outPhase[1] * outPhase[1];
+}
+
+/**
+ * @brief gives the frequency of a notch
+ *
+ * @param notch[IN] position of the notch in the cascade
+ * @return its frequency (Hz)
+ */
+static double getPosition(uint8_t notch)
+{
+	return howl.position[notch] * BIN_WIDTH / (1 << POSITION_SHIFT);
+}
@@ -0,0 +1,237 @@
+/**
+  ******************************************************************************
+  * @file           : lossless_test.c
+  * @brief          : Host test of the lossless codec (lossless.c) through
+  *                   the encoder and the decoder (encoder.c, decoder.c)
+  *
+  * encoder.c is included, not linked, with CODEC set to CODEC_LOSSLESS, to
+  * change codec between two frames like adaptDepth does. The stages are
+  * replaced by empty tables (see links_stub.h): frames reach the encoder
+  * and leave the decoder unchanged.
+  * Synthetic speech (talk spurts, pauses in a -66dBFS noise, 120s) is given
+  * to encoder_streamUpdate frame by frame, the bytes to decoder_streamUpdate.
+  * With DTX, a second detector fed with the same frames tells which frames
+  * are sent: each of them should come out of the decoder identical, in
+  * order, and no other sample.
+  * - lossless only: the frame before each silence descriptor usually ends
+  *   in the middle of a byte. Bits per sent sample, headers included;
+  * - codec changes: CODEC_LOSSLESS and CODEC_PCM one after the other, every
+  *   CHANGE_PERIOD sent frames. CODEC_PCM toggles the LSB of a sample when a
+  *   byte would be SYNC_SIGNAL: its frames may differ by 1 there only.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "config.h"
+
+// The encoder starts with the codec under test
+#undef CODEC
+#define CODEC CODEC_LOSSLESS
+
+#include "encoder.c"
+#include "decoder.h"
+#include "links_stub.h"
+#include "check.h"
+#include "synthetic.h"
+
+#if (DTX != 1)
+#error "The lossless test needs DTX = 1"
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SECONDS 120
+#define LENGTH (SAMPLING_FREQUENCY * SECONDS)
+#define FRAMES (LENGTH / FRAME_SIZE)
+#define FULL_SCALE (1 << (SAMPLE_SIZE - 1))
+#define CHANGE_PERIOD 7                  // Sent frames between two changes of codec
+
+/* Private types -------------------------------------------------------------*/
+
+enum session
+{
+	SESSION_LOSSLESS,   /** CODEC_LOSSLESS only */
+	SESSION_CHANGES,    /** CODEC_LOSSLESS and CODEC_PCM */
+	SESSIONS
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void testSession(enum session kind);
+static void changeCodec(void);
+
+/* Private variables ---------------------------------------------------------*/
+
+static double speech[LENGTH];
+static uint16_t input[LENGTH];
+static uint32_t sentFrames[FRAMES];      // Index of each frame sent by the encoder, in order
+static uint8_t sentCodecs[FRAMES];       // Codec of each sent frame
+static uint8_t wrongFrames[FRAMES];      // 1 if a sample of the sent frame came out different
+static uint16_t ADC_samples[SAMPLE_BUFFER_SIZE];
+static uint16_t DAC_samples[SAMPLE_BUFFER_SIZE];
+static uint8_t bytes[TX_BUFFER_SIZE];
+static struct encoder_Info encoder;
+static struct decoder_Info decoder;
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	const struct synthetic_Talk talk = { SAMPLING_FREQUENCY, 0.5, 2.5, 0.5, 2.0, 90, 160, 0.05, 0.35, 0.05 };
+	uint32_t clipped = 0;
+	uint8_t kind;
+	uint32_t i;
+
+	srand(7);
+	synthetic_Talk(speech, LENGTH, &talk);
+	for (i = 0; i < LENGTH; i++)
+	{
+		input[i] = (uint16_t)(synthetic_Quantize(speech[i] + 0.0005 * synthetic_Gauss(), SAMPLE_SIZE, &clipped) + FULL_SCALE);
+	}
+
+	// Samples at full scale give bytes without any code LSB to toggle with CODEC_PCM
+	CHECK(clipped == 0, "%u samples clipped", clipped);
+
+	for (kind = 0; kind < SESSIONS; kind++)
+	{
+		testSession(kind);
+	}
+
+	return CHECK_RESULT("lossless");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief encodes and decodes the synthetic speech, and checks every sent frame
+ *
+ * @param kind[IN] the session
+ */
+static void testSession(enum session kind)
+{
+	static const char * names[SESSIONS] = { "lossless only", "codec changes" };
+	struct sampleStream_Info ADC_stream, DAC_stream;
+	struct bitStream_Info UART_stream;
+	struct vad_Info vad;
+	uint16_t output[FRAME_SIZE];
+	uint32_t frame, queued = 0, samples = 0, wrong = 0, pending = 0, changes = 0, toggled = 0, bytesSent = 0, i;
+	int32_t expected;
+	uint16_t count;
+	uint8_t bits;
+
+	memset(&encoder, 0, sizeof(encoder));
+	memset(&decoder, 0, sizeof(decoder));
+	memset(wrongFrames, 0, sizeof(wrongFrames));
+	memset(stub_errors, 0, sizeof(stub_errors));
+	stub_streamInit(&ADC_stream, ADC_samples, SAMPLE_BUFFER_SIZE, &UART_stream, bytes, TX_BUFFER_SIZE);
+	stub_streamInit(&DAC_stream, DAC_samples, SAMPLE_BUFFER_SIZE, NULL, NULL, 0);
+
+	CHECK(encoder_streamStart(&encoder, &ADC_stream, &UART_stream) == HAL_OK, "%s: encoder_streamStart failed", names[kind]);
+	CHECK(decoder_streamStart(&decoder, &UART_stream, &DAC_stream) == HAL_OK, "%s: decoder_streamStart failed", names[kind]);
+	vad_Start(&vad);
+
+	for (frame = 0; frame <= FRAMES; frame++)
+	{
+		if (frame < FRAMES)
+		{
+			if (vad_Process(&vad, &(input[frame * FRAME_SIZE])))
+			{
+				sentCodecs[queued] = encoder.codec->id;
+				sentFrames[queued++] = frame;
+			}
+
+			bits = encoder.bits;
+			ring_Write(&(ADC_stream.ring), &(input[frame * FRAME_SIZE]), FRAME_SIZE);
+			CHECK(encoder_streamUpdate(&encoder) == HAL_OK, "%s: encoder_streamUpdate failed at frame %u", names[kind], frame);
+
+			// A silence descriptor was just sent after the last bits of a frame
+			pending += (encoder.silentFrames == 1) && (bits != 0);
+
+			if ((kind == SESSION_CHANGES) && (encoder.silentFrames == 0) && (queued % CHANGE_PERIOD == 0))
+			{
+				pending += (encoder.bits != 0);
+				changeCodec();
+				changes++;
+			}
+		}
+		else
+		{
+			// The end of the last frame
+			sendSyncSignal(&encoder);
+		}
+
+		bytesSent += ring_Count(&(UART_stream.ring));
+		CHECK(decoder_streamUpdate(&decoder) == HAL_OK, "%s: decoder_streamUpdate failed at frame %u", names[kind], frame);
+
+		while ((count = ring_Read(&(DAC_stream.ring), output, FRAME_SIZE)) != 0)
+		{
+			for (i = 0; i < count; i++, samples++)
+			{
+				if (samples / FRAME_SIZE >= queued)
+				{
+					wrong++;
+					continue;
+				}
+
+				expected = input[sentFrames[samples / FRAME_SIZE] * FRAME_SIZE + samples % FRAME_SIZE];
+				if ((sentCodecs[samples / FRAME_SIZE] == CODEC_PCM) && (abs(output[i] - expected) == 1))
+				{
+					toggled++;
+				}
+				else if (output[i] != expected)
+				{
+					wrongFrames[samples / FRAME_SIZE] = 1;
+				}
+			}
+		}
+	}
+
+	for (i = 0; i < queued; i++)
+	{
+		wrong += wrongFrames[i];
+	}
+
+	CHECK((queued > FRAMES / 4) && (queued < FRAMES * 3 / 4), "%s: %u of %u frames sent", names[kind], queued, FRAMES);
+	CHECK(samples == queued * FRAME_SIZE, "%s: %u samples decoded for %u frames", names[kind], samples, queued);
+	CHECK(wrong == 0, "%s: %u frames different", names[kind], wrong);
+	CHECK(pending > 10, "%s: only %u frames ended in the middle of a byte before a synchronization signal", names[kind], pending);
+	CHECK(stub_errors[BUFFER_OVERRUN] == 0, "%s: %u overruns", names[kind], stub_errors[BUFFER_OVERRUN]);
+
+	printf("%-14s %u of %u frames sent and decoded identical, %u ended in the middle of a byte before a synchronization signal",
+	       names[kind], queued, FRAMES, pending);
+	if (kind == SESSION_CHANGES)
+	{
+		CHECK(changes > queued / CHANGE_PERIOD / 2, "%s: %u changes of codec", names[kind], changes);
+		printf(", %u changes of codec, %u LSBs toggled by CODEC_PCM\n", changes, toggled);
+	}
+	else
+	{
+		printf(", %.2f bits per sent sample (%u with CODEC_PCM)\n", bytesSent * 8.0 / (queued * FRAME_SIZE), WORD_LENGTH);
+	}
+}
+
+/**
+ * @brief changes codec before the next frame, like adaptDepth does
+ */
+static void changeCodec(void)
+{
+	encoder.codec = codec_Find((encoder.codec->id == CODEC_LOSSLESS) ? CODEC_PCM : CODEC_LOSSLESS);
+	if (encoder.codec->reset != NULL)
+	{
+		encoder.codec->reset(encoder.codecState);
+	}
+	sendSyncSignal(&encoder);
+}
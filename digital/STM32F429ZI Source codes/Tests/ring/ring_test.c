@@ -0,0 +1,321 @@
+/**
+  ******************************************************************************
+  * @file           : ring_test.c
+  * @brief          : Host test of the ring buffer (ring.c)
+  *
+  * Checks the argument checks and the counters of a ring on one thread,
+  * then runs a producer thread and a consumer thread on the same ring, like
+  * the two interrupts sharing a stream. The producer writes a sequence of
+  * numbers, the consumer checks that it reads every number once, in order.
+  * Each run goes through several wraparounds of the 16-bit head and tail
+  * (the counters start just below 2^16), with the copy functions
+  * (ring_Write / ring_Read), the span functions with partial commits and
+  * releases (ring_WriteSpan / ring_Commit, ring_ReadSpan / ring_Release),
+  * and both mixed, on rings of 1 element to RING_SIZE_MAX elements.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <pthread.h>
+#include <sched.h>
+#include "stm32f4xx_hal.h"
+#include "ring.h"
+#include "check.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define ELEMENTS 1000000        // Elements going through the ring on each run: about 15 wraparounds
+#define START_COUNTER 0xFF00    // head and tail start 256 elements before wrapping
+#define CHUNK_MAX 100           // Largest number of elements written or read at once
+
+/* Private types -------------------------------------------------------------*/
+
+/**
+ * @brief functions used by each side of a run
+ */
+enum path
+{
+	PATH_COPY,   /** ring_Write / ring_Read */
+	PATH_SPAN,   /** ring_WriteSpan and ring_Commit / ring_ReadSpan and ring_Release, partial */
+	PATH_MIXED   /** Spans on the producer side, copies on the consumer side */
+};
+
+/**
+ * @brief one side of a run
+ */
+struct side_Info
+{
+	struct ring_Info * ring;
+	uint16_t size;            /** Number of elements of the ring */
+	enum path path;
+	uint32_t random;          /** State of the random generator of the thread */
+	uint32_t errors;          /** Failed checks on this side */
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void * producer(void * parameters);
+static void * consumer(void * parameters);
+static uint16_t chunk(struct side_Info * side);
+static void testSingleThread(void);
+static void testRun(uint16_t size, enum path path);
+
+/* Private variables ---------------------------------------------------------*/
+
+static uint32_t storage[RING_SIZE_MAX];
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	static const uint16_t sizes[] = { 1, 2, 64, 1024, RING_SIZE_MAX };
+	static const enum path paths[] = { PATH_COPY, PATH_SPAN, PATH_MIXED };
+	uint8_t i, j;
+
+	testSingleThread();
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	{
+		for (j = 0; j < sizeof(paths) / sizeof(paths[0]); j++)
+		{
+			testRun(sizes[i], paths[j]);
+		}
+	}
+
+	return CHECK_RESULT("ring");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief checks the arguments of ring_Init, and the counters across a wraparound
+ */
+static void testSingleThread(void)
+{
+	struct ring_Info ring;
+	uint32_t data[8] = { 0 };
+	uint16_t length;
+	uint16_t i;
+
+	CHECK(ring_Init(&ring, storage, 0, 4) == HAL_ERROR, "size 0 accepted");
+	CHECK(ring_Init(&ring, storage, 3, 4) == HAL_ERROR, "size 3 accepted");
+	CHECK(ring_Init(&ring, storage, RING_SIZE_MAX + 1, 4) == HAL_ERROR, "size RING_SIZE_MAX + 1 accepted");
+	CHECK(ring_Init(&ring, storage, 8, 0) == HAL_ERROR, "element size 0 accepted");
+	CHECK(ring_Init(&ring, NULL, 8, 4) == HAL_ERROR, "NULL buffer accepted");
+	CHECK(ring_Init(&ring, storage, 8, 4) == HAL_OK, "size 8 refused");
+	CHECK((ring_Count(&ring) == 0) && (ring_Space(&ring) == 8), "ring not empty after ring_Init");
+
+	// Counters 3 elements before wrapping: positions 5, 6, 7, then 0...
+	ring.head = 0xFFFD;
+	ring.tail = 0xFFFD;
+	for (i = 0; i < 8; i++)
+	{
+		data[i] = i;
+	}
+	CHECK(ring_Write(&ring, data, 8) == 8, "full write refused");
+	CHECK(ring.head == 5, "head %u after wrapping, 5 expected", ring.head);
+	CHECK((ring_Count(&ring) == 8) && (ring_Space(&ring) == 0), "count %u space %u, 8 and 0 expected",
+	      ring_Count(&ring), ring_Space(&ring));
+	CHECK(ring_Write(&ring, data, 1) == 0, "write into a full ring");
+	ring_WriteSpan(&ring, &length);
+	CHECK(length == 0, "write span of %u elements in a full ring", length);
+
+	ring_ReadSpan(&ring, &length);
+	CHECK(length == 3, "read span of %u elements before the end of the buffer, 3 expected", length);
+	for (i = 0; i < 8; i++)
+	{
+		data[i] = 0xFFFFFFFF;
+	}
+	CHECK(ring_Read(&ring, data, 8) == 8, "full read refused");
+	for (i = 0; i < 8; i++)
+	{
+		CHECK(data[i] == i, "element %u read as %u", i, data[i]);
+	}
+	CHECK((ring_Count(&ring) == 0) && (ring_Space(&ring) == 8), "ring not empty after reading everything");
+	ring_ReadSpan(&ring, &length);
+	CHECK(length == 0, "read span of %u elements in an empty ring", length);
+
+	ring_Reset(&ring);
+	CHECK((ring.head == 0) && (ring.tail == 0), "counters not cleared by ring_Reset");
+}
+
+/**
+ * @brief runs a producer and a consumer thread through ELEMENTS elements
+ *
+ * @param size[IN] number of elements of the ring
+ * @param path[IN] functions used by both sides
+ */
+static void testRun(uint16_t size, enum path path)
+{
+	static const char * names[] = { "copy", "span", "mixed" };
+	struct ring_Info ring;
+	struct side_Info write = { &ring, size, path, 0x12345678, 0 };
+	struct side_Info read = { &ring, size, path, 0x9ABCDEF1, 0 };
+	pthread_t threads[2];
+
+	CHECK(ring_Init(&ring, storage, size, sizeof(uint32_t)) == HAL_OK, "size %u refused", size);
+	ring.head = START_COUNTER;
+	ring.tail = START_COUNTER;
+
+	pthread_create(&(threads[0]), NULL, producer, &write);
+	pthread_create(&(threads[1]), NULL, consumer, &read);
+	pthread_join(threads[0], NULL);
+	pthread_join(threads[1], NULL);
+
+	CHECK((write.errors == 0) && (read.errors == 0), "ring of %u elements, %s path: %u producer and %u consumer errors",
+	      size, names[path], write.errors, read.errors);
+	CHECK(ring_Count(&ring) == 0, "ring of %u elements, %s path: %u elements left", size, names[path], ring_Count(&ring));
+	CHECK(ring.head == (uint16_t)(START_COUNTER + ELEMENTS), "ring of %u elements, %s path: head %u", size, names[path], ring.head);
+}
+
+/**
+ * @brief writes the numbers 0 to ELEMENTS - 1, in chunks of random length
+ */
+static void * producer(void * parameters)
+{
+	struct side_Info * side = parameters;
+	uint32_t values[CHUNK_MAX];
+	uint32_t * span;
+	uint32_t next = 0;
+	uint16_t count, length, space, i;
+
+	while (next < ELEMENTS)
+	{
+		count = chunk(side);
+		if (count > ELEMENTS - next)
+		{
+			count = ELEMENTS - next;
+		}
+
+		space = ring_Space(side->ring);
+		if (space > side->size)
+		{
+			side->errors += 1;
+		}
+
+		if (side->path == PATH_COPY)
+		{
+			for (i = 0; i < count; i++)
+			{
+				values[i] = next + i;
+			}
+			count = ring_Write(side->ring, values, count);
+		}
+		else
+		{
+			// Partial commits: only count elements of the span are committed
+			span = ring_WriteSpan(side->ring, &length);
+			// The consumer can only free elements meanwhile
+			if (length > ring_Space(side->ring))
+			{
+				side->errors += 1;
+			}
+			if (count > length)
+			{
+				count = length;
+			}
+			for (i = 0; i < count; i++)
+			{
+				span[i] = next + i;
+			}
+			ring_Commit(side->ring, count);
+		}
+
+		next += count;
+		if (count == 0)
+		{
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief reads ELEMENTS elements in chunks of random length, checks that they follow each other
+ */
+static void * consumer(void * parameters)
+{
+	struct side_Info * side = parameters;
+	uint32_t values[CHUNK_MAX];
+	uint32_t * span;
+	uint32_t expected = 0;
+	uint16_t count, length, available, i;
+
+	while (expected < ELEMENTS)
+	{
+		count = chunk(side);
+
+		available = ring_Count(side->ring);
+		if (available > side->size)
+		{
+			side->errors += 1;
+		}
+
+		if (side->path == PATH_SPAN)
+		{
+			span = ring_ReadSpan(side->ring, &length);
+			// The producer can only add elements meanwhile
+			if (length > ring_Count(side->ring))
+			{
+				side->errors += 1;
+			}
+			if (count > length)
+			{
+				count = length;
+			}
+			for (i = 0; i < count; i++)
+			{
+				if (span[i] != expected + i)
+				{
+					side->errors += 1;
+				}
+			}
+			ring_Release(side->ring, count);
+		}
+		else
+		{
+			count = ring_Read(side->ring, values, count);
+			for (i = 0; i < count; i++)
+			{
+				if (values[i] != expected + i)
+				{
+					side->errors += 1;
+				}
+			}
+		}
+
+		expected += count;
+		if (count == 0)
+		{
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief gives a random chunk length, between 1 and CHUNK_MAX (xorshift generator of the side)
+ */
+static uint16_t chunk(struct side_Info * side)
+{
+	side->random ^= side->random << 13;
+	side->random ^= side->random >> 17;
+	side->random ^= side->random << 5;
+
+	// Mostly small chunks, like samples and bytes, sometimes large ones, like DMA blocks
+	return (side->random & 0x100) ? (uint16_t)(1 + (side->random % CHUNK_MAX)) : (uint16_t)(1 + (side->random % 4));
+}
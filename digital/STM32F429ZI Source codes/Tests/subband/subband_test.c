@@ -0,0 +1,227 @@
+/**
+  ******************************************************************************
+  * @file           : subband_test.c
+  * @brief          : Host test of the sub-band ADPCM codec (subband.c),
+  *                   through codec_Find(CODEC_SUBBAND)
+  *
+  * The encoder and decoder are run like encoder.c and decoder.c do: a
+  * header after every synchronization signal, then SYNC_PERIOD codes.
+  * - every header byte is below 0x80 and no code is SYNC_SIGNAL, for tones,
+  *   noise and full-scale square waves;
+  * - round trip: SNR of the decoded samples, after compensating the delay
+  *   of the filters;
+  * - a decoder starting in the middle of the stream decodes the same
+  *   samples as the other one after the next reset of the predictors.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "codec.h"
+#include "subband.h"
+#include "check.h"
+#include "synthetic.h"
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SECONDS 10
+#define LENGTH (SAMPLING_FREQUENCY * SECONDS)
+#define FULL_SCALE (1 << (SAMPLE_SIZE - 1))
+#define MAX_DELAY 48                     // Delay of the filters searched for (samples)
+#define LATE_START (LENGTH / 4)          // First sample seen by the late decoder
+
+/* Private types -------------------------------------------------------------*/
+
+enum signal
+{
+	SIGNAL_TONE,     /** 440Hz at -2dBFS */
+	SIGNAL_TONES,    /** 220Hz, 1300Hz and 3100Hz with a 3Hz envelope, and some noise */
+	SIGNAL_NOISE,    /** Uniform noise at full scale */
+	SIGNAL_SQUARE,   /** Square wave at full scale, 500Hz */
+	SIGNAL_SILENCE,
+	SIGNALS
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void testInfo(const struct codec_Info * codec);
+static void testSignal(const struct codec_Info * codec, enum signal kind);
+
+/* Private variables ---------------------------------------------------------*/
+
+static uint16_t input[LENGTH];
+static uint16_t output[LENGTH];
+static uint16_t lateOutput[LENGTH];
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	const struct codec_Info * codec = codec_Find(CODEC_SUBBAND);
+	uint8_t kind;
+
+	CHECK(codec != NULL, "codec_Find(CODEC_SUBBAND) gave no codec");
+	if (codec == NULL)
+	{
+		return CHECK_RESULT("subband");
+	}
+
+	testInfo(codec);
+	for (kind = 0; kind < SIGNALS; kind++)
+	{
+		testSignal(codec, kind);
+	}
+
+	return CHECK_RESULT("subband");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief description of the codec, against the limits of the encoder and decoder
+ */
+static void testInfo(const struct codec_Info * codec)
+{
+	CHECK(codec->id == CODEC_SUBBAND, "id %u", codec->id);
+	CHECK(codec->id < 0x80, "id %u not below 0x80", codec->id);
+	CHECK((codec->codeBits == 8) && (codec->samplesPerCode == 2), "%u-bit codes of %u samples", codec->codeBits, codec->samplesPerCode);
+	CHECK((codec->headerSize == SUBBAND_HEADER_SIZE) && (codec->headerSize <= CODEC_HEADER_SIZE), "header of %u bytes", codec->headerSize);
+	CHECK(codec->stateSize <= CODEC_STATE_SIZE, "state of %u bytes", codec->stateSize);
+	CHECK((codec->reset != NULL) && (codec->getHeader != NULL) && (codec->setHeader != NULL), "functions missing");
+}
+
+/**
+ * @brief encodes and decodes a signal, a header every SYNC_PERIOD codes
+ *
+ * @param codec[IN] the sub-band codec
+ * @param kind[IN] the signal
+ */
+static void testSignal(const struct codec_Info * codec, enum signal kind)
+{
+	static const char * names[SIGNALS] = { "440Hz tone", "3 tones with noise", "noise", "square wave", "silence" };
+	static uint32_t encoder[CODEC_STATE_WORDS], decoder[CODEC_STATE_WORDS], late[CODEC_STATE_WORDS];
+	uint8_t header[CODEC_HEADER_SIZE];
+	uint32_t i, j, code, headers = 0, badHeaders = 0, syncCodes = 0, wideCodes = 0, lateFrom = LENGTH;
+	double t, value, signal, error, best = 0, bestSignal = 0, bestError = 0;
+	uint16_t delay, bestDelay = 0;
+
+	srand(4);
+	for (i = 0; i < LENGTH; i++)
+	{
+		t = i / (double)SAMPLING_FREQUENCY;
+		if (kind == SIGNAL_TONE)
+		{
+			value = 0.8 * sin(2 * M_PI * 440 * t);
+		}
+		else if (kind == SIGNAL_TONES)
+		{
+			value = (0.5 + 0.5 * sin(2 * M_PI * 3 * t)) * (0.4 * sin(2 * M_PI * 220 * t) + 0.25 * sin(2 * M_PI * 1300 * t + 1)
+			        + 0.1 * sin(2 * M_PI * 3100 * t)) + 0.02 * (synthetic_Uniform() - 0.5);
+		}
+		else if (kind == SIGNAL_NOISE)
+		{
+			value = synthetic_Uniform() * 2 - 1;
+		}
+		else if (kind == SIGNAL_SQUARE)
+		{
+			value = ((i * 1000 / SAMPLING_FREQUENCY) & 1) ? 1 : -1;
+		}
+		else
+		{
+			value = 0;
+		}
+		input[i] = (uint16_t)(synthetic_Quantize(value, SAMPLE_SIZE, NULL) + FULL_SCALE);
+	}
+
+	codec->reset(encoder);
+	codec->reset(decoder);
+	codec->reset(late);
+	memset(lateOutput, 0, sizeof(lateOutput));
+	for (i = 0; i + 1 < LENGTH; i += 2)
+	{
+		// Synchronization signal, id and header every SYNC_PERIOD codes
+		if ((i / 2) % SYNC_PERIOD == 0)
+		{
+			codec->getHeader(encoder, header);
+			for (j = 0; j < codec->headerSize; j++)
+			{
+				badHeaders += (header[j] >= 0x80);
+			}
+			codec->setHeader(decoder, header);
+			if (i >= LATE_START)
+			{
+				codec->setHeader(late, header);
+				lateFrom = (i < lateFrom) ? i : lateFrom;
+			}
+			headers++;
+		}
+
+		code = codec->encode(encoder, &(input[i]));
+		syncCodes += (code == SYNC_SIGNAL);
+		wideCodes += (code >> codec->codeBits) != 0;
+		codec->decode(decoder, code, &(output[i]));
+		if (i >= lateFrom)
+		{
+			codec->decode(late, code, &(lateOutput[i]));
+		}
+	}
+
+	CHECK(badHeaders == 0, "%s: %u header bytes not below 0x80", names[kind], badHeaders);
+	CHECK(syncCodes == 0, "%s: %u codes equal to SYNC_SIGNAL", names[kind], syncCodes);
+	CHECK(wideCodes == 0, "%s: %u codes wider than %u bits", names[kind], wideCodes, codec->codeBits);
+
+	// SNR after the delay of the filters, from the second second
+	for (delay = 0; delay < MAX_DELAY; delay++)
+	{
+		signal = 0;
+		error = 0;
+		for (i = SAMPLING_FREQUENCY; i + delay < LENGTH; i++)
+		{
+			value = (double)input[i] - FULL_SCALE;
+			signal += value * value;
+			error += ((double)output[i + delay] - input[i]) * ((double)output[i + delay] - input[i]);
+		}
+		if ((delay == 0) || (signal * bestError > bestSignal * error))
+		{
+			bestSignal = signal;
+			bestError = error;
+			bestDelay = delay;
+		}
+	}
+
+	// The late decoder has the predictors of the encoder from their next reset (every 128 headers)
+	for (i = lateFrom + 128 * SYNC_PERIOD * 2; (i < LENGTH) && (lateOutput[i] == output[i]); i++)
+	{
+	}
+	CHECK(i >= LENGTH, "%s: late decoder still different at sample %u", names[kind], i);
+
+	if (kind == SIGNAL_SILENCE)
+	{
+		for (i = 0; (i < LENGTH) && (abs((int)output[i] - FULL_SCALE) <= 1); i++)
+		{
+		}
+		CHECK(i >= LENGTH, "silence decoded as %u at sample %u", output[i], i);
+		printf("%-18s %u headers, no code equal to SYNC_SIGNAL, silence decoded as silence\n", names[kind], headers);
+		return;
+	}
+
+	best = (bestError == 0) ? 999 : 10 * log10(bestSignal / bestError);
+	printf("%-18s %u headers, no code equal to SYNC_SIGNAL, SNR %.1fdB (delay of %u samples)\n", names[kind], headers, best, bestDelay);
+	if ((kind == SIGNAL_TONE) || (kind == SIGNAL_TONES))
+	{
+		CHECK(best > 25, "%s: SNR of %.1fdB", names[kind], best);
+		CHECK(bestDelay == 22, "%s: delay of %u samples", names[kind], bestDelay);
+	}
+}
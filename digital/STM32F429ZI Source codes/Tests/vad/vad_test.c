@@ -0,0 +1,237 @@
+/**
+  ******************************************************************************
+  * @file           : vad_test.c
+  * @brief          : Host test of the voice activity detector (vad.c) and
+  *                   of discontinuous transmission in the encoder (encoder.c)
+  *
+  * encoder.c is included, not linked, to reach its state. The stages are
+  * replaced by empty tables (see links_stub.h): frames reach the encoder
+  * unchanged.
+  * - decisions: synthetic talk over a -50dBFS noise (120s). A frame is
+  *   speech when its speech alone is VAD_THRESHOLD times the noise: speech
+  *   frames should be sent, and the VAD_HANGOVER frames after speech, but
+  *   not the frames after them;
+  * - keepalive: the same talk through encoder_streamUpdate. Every silent
+  *   frame sends nothing but a silence descriptor, on the first silent frame
+  *   then every DTX_KEEPALIVE_PERIOD frames, and the comfort noise of the
+  *   descriptors has the level of the noise;
+  * - noise step: the noise rises by 10dB in a pause, the detector stops
+  *   sending frames once its noise floor followed.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; Copyright (c) 2020, Alban Benmouffek, Matthieu Planas
+  * All rights reserved.</center></h2>
+  *
+  * This software component is licensed under BSD 3-Clause license,
+  * the "License"; You may not use this file except in compliance with the
+  * License. You may obtain a copy of the License at:
+  *                        opensource.org/licenses/BSD-3-Clause
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+
+#include <string.h>
+#include "encoder.c"
+#include "comfort.h"
+#include "links_stub.h"
+#include "check.h"
+#include "synthetic.h"
+
+#if (DTX != 1)
+#error "The vad test needs DTX = 1"
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+
+#define SECONDS 120
+#define LENGTH (SAMPLING_FREQUENCY * SECONDS)
+#define FRAMES (LENGTH / FRAME_SIZE)
+#define FULL_SCALE (1 << (SAMPLE_SIZE - 1))
+#define NOISE 0.003                      // Standard deviation of the background noise (-50dBFS)
+#define STEP_SECONDS 20                  // Length of the noise step session
+#define STEP_FRAME (3 * SAMPLING_FREQUENCY / FRAME_SIZE)   // First frame of the louder noise
+#define RECOVERY_SECONDS 5               // Longest time to stop sending the louder noise
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void testDecisions(void);
+static void testKeepalive(void);
+static void testNoiseStep(void);
+
+/* Private variables ---------------------------------------------------------*/
+
+static double speech[LENGTH];
+static uint16_t input[LENGTH];
+static uint8_t isSpeech[FRAMES];         // 1 if the speech of the frame alone is VAD_THRESHOLD times the noise
+static uint8_t sent[FRAMES];             // 1 if the detector sent the frame
+static uint16_t ADC_samples[SAMPLE_BUFFER_SIZE];
+static uint8_t bytes[TX_BUFFER_SIZE];
+static struct encoder_Info encoder;
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+	const struct synthetic_Talk talk = { SAMPLING_FREQUENCY, 0.5, 2.5, 0.5, 2.0, 90, 160, 0.05, 0.35, 0.05 };
+	double energy;
+	uint32_t i, frame;
+
+	srand(7);
+	synthetic_Talk(speech, LENGTH, &talk);
+	for (frame = 0; frame < FRAMES; frame++)
+	{
+		energy = 0;
+		for (i = frame * FRAME_SIZE; i < (frame + 1) * FRAME_SIZE; i++)
+		{
+			input[i] = (uint16_t)(synthetic_Quantize(speech[i] + NOISE * synthetic_Gauss(), SAMPLE_SIZE, NULL) + FULL_SCALE);
+			energy += speech[i] * speech[i] / FRAME_SIZE;
+		}
+		isSpeech[frame] = (energy > NOISE * NOISE * VAD_THRESHOLD);
+	}
+
+	testDecisions();
+	testKeepalive();
+	testNoiseStep();
+
+	return CHECK_RESULT("vad");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief runs the detector over the talk, checks its decisions against the speech alone
+ */
+static void testDecisions(void)
+{
+	struct vad_Info vad;
+	uint32_t frame, speechFrames = 0, missed = 0, late = 0, hangover = 0, hangoverSent = 0, since = FRAMES;
+
+	vad_Start(&vad);
+	for (frame = 0; frame < FRAMES; frame++)
+	{
+		sent[frame] = vad_Process(&vad, &(input[frame * FRAME_SIZE]));
+
+		since = isSpeech[frame] ? 0 : since + 1;
+		speechFrames += isSpeech[frame];
+		missed += isSpeech[frame] && !sent[frame];
+		late += sent[frame] && (since > VAD_HANGOVER);
+
+		// Frames up to VAD_HANGOVER frames after speech
+		hangover += (since != 0) && (since <= VAD_HANGOVER);
+		hangoverSent += sent[frame] && (since != 0) && (since <= VAD_HANGOVER);
+	}
+
+	printf("decisions      %u of %u frames sent, %u speech frames: %u missed, %u of %u sent in the hangover, %u sent after it\n",
+	       vad.sentFrames, FRAMES, speechFrames, missed, hangoverSent, hangover, late);
+	CHECK(vad.frames == FRAMES, "%u frames processed", vad.frames);
+	CHECK(speechFrames > FRAMES / 4, "only %u speech frames", speechFrames);
+	CHECK(missed * 100 < speechFrames, "%u of %u speech frames missed", missed, speechFrames);
+	CHECK(late * 100 < FRAMES, "%u frames sent more than VAD_HANGOVER frames after speech", late);
+	// The hangover of the detector starts from its own last speech frame, at most a few frames before
+	CHECK(hangoverSent * 100 >= hangover * 99, "%u of %u frames sent after speech in the hangover", hangoverSent, hangover);
+}
+
+/**
+ * @brief runs the talk through the encoder, checks what silent frames send
+ */
+static void testKeepalive(void)
+{
+	struct sampleStream_Info ADC_stream;
+	struct bitStream_Info UART_stream;
+	struct comfort_Info comfort;
+	uint8_t received[TX_BUFFER_SIZE];
+	uint16_t noise[FRAME_SIZE];
+	uint32_t frame, run = 0, expected = 0, descriptors = 0, wrong = 0, silentBytes = 0, silentFrames = 0, generated = 0, i;
+	double level = 0, value;
+	uint16_t count;
+
+	memset(&encoder, 0, sizeof(encoder));
+	memset(stub_errors, 0, sizeof(stub_errors));
+	stub_streamInit(&ADC_stream, ADC_samples, SAMPLE_BUFFER_SIZE, &UART_stream, bytes, TX_BUFFER_SIZE);
+	CHECK(encoder_streamStart(&encoder, &ADC_stream, &UART_stream) == HAL_OK, "encoder_streamStart failed");
+	comfort_Start(&comfort);
+
+	for (frame = 0; frame < FRAMES; frame++)
+	{
+		ring_Write(&(ADC_stream.ring), &(input[frame * FRAME_SIZE]), FRAME_SIZE);
+		CHECK(encoder_streamUpdate(&encoder) == HAL_OK, "encoder_streamUpdate failed at frame %u", frame);
+		count = ring_Read(&(UART_stream.ring), received, TX_BUFFER_SIZE);
+
+		// The detector of the encoder sees the same frames as the one of testDecisions
+		run = sent[frame] ? 0 : run + 1;
+		if (sent[frame])
+		{
+			continue;
+		}
+
+		// A descriptor on the first silent frame, then every DTX_KEEPALIVE_PERIOD frames, and nothing else
+		expected += ((run - 1) % DTX_KEEPALIVE_PERIOD == 0);
+		if ((count >= 2 + COMFORT_DESCRIPTOR_SIZE) && (received[count - 2 - COMFORT_DESCRIPTOR_SIZE] == SYNC_SIGNAL)
+		    && (received[count - 1 - COMFORT_DESCRIPTOR_SIZE] == CODEC_SILENCE))
+		{
+			descriptors++;
+			wrong += ((run - 1) % DTX_KEEPALIVE_PERIOD != 0);
+			comfort_Set(&comfort, &(received[count - COMFORT_DESCRIPTOR_SIZE]));
+			silentBytes += count - 2 - COMFORT_DESCRIPTOR_SIZE;
+		}
+		else
+		{
+			wrong += ((run - 1) % DTX_KEEPALIVE_PERIOD == 0);
+			silentBytes += count;
+		}
+
+		// Level of the comfort noise, once the noise floor settled
+		if (frame * FRAME_SIZE >= 10 * SAMPLING_FREQUENCY)
+		{
+			silentFrames++;
+			count = comfort_Generate(&comfort, noise, FRAME_SIZE);
+			generated += count;
+			for (i = 0; i < count; i++)
+			{
+				value = (double)noise[i] - FULL_SCALE;
+				level += value * value;
+			}
+		}
+	}
+
+	level = 10 * log10(level / generated / ((NOISE * FULL_SCALE) * (NOISE * FULL_SCALE)));
+	printf("keepalive      %u silence descriptors, every %u silent frames, comfort noise %+.1fdB from the noise\n",
+	       descriptors, DTX_KEEPALIVE_PERIOD, level);
+	CHECK((descriptors == expected) && (wrong == 0), "%u descriptors for %u expected, %u frames wrong", descriptors, expected, wrong);
+	CHECK(silentBytes <= descriptors, "%u bytes sent by silent frames besides descriptors", silentBytes);
+	CHECK(generated == silentFrames * FRAME_SIZE, "comfort noise stopped for %u of %u samples", silentFrames * FRAME_SIZE - generated,
+	      silentFrames * FRAME_SIZE);
+	CHECK(fabs(level) < 3, "comfort noise %+.1fdB from the noise", level);
+	CHECK(stub_errors[BUFFER_OVERRUN] == 0, "%u overruns", stub_errors[BUFFER_OVERRUN]);
+}
+
+/**
+ * @brief a noise rising by 10dB: checks the time the detector sends it
+ */
+static void testNoiseStep(void)
+{
+	struct vad_Info vad;
+	uint32_t frame, last = 0, i;
+
+	srand(9);
+	vad_Start(&vad);
+	for (frame = 0; frame < STEP_SECONDS * SAMPLING_FREQUENCY / FRAME_SIZE; frame++)
+	{
+		for (i = 0; i < FRAME_SIZE; i++)
+		{
+			input[i] = (uint16_t)(synthetic_Quantize(NOISE * ((frame < STEP_FRAME) ? 1 : sqrt(10)) * synthetic_Gauss(), SAMPLE_SIZE, NULL)
+			                      + FULL_SCALE);
+		}
+		if (vad_Process(&vad, input))
+		{
+			last = frame;
+		}
+	}
+
+	printf("noise step     +10dB of noise sent for %.2fs\n", (last + 1 - STEP_FRAME) * FRAME_SIZE / (double)SAMPLING_FREQUENCY);
+	CHECK(last >= STEP_FRAME, "the louder noise wasn't taken for speech first");
+	CHECK((last + 1 - STEP_FRAME) * FRAME_SIZE < RECOVERY_SECONDS * SAMPLING_FREQUENCY, "the louder noise was sent until frame %u", last);
+}